@@ -0,0 +1,432 @@
+// Author: Pokemon Battle contributors
+// Date: 10-17-2026
+//
+// This file contains the implementation of the Expectimax_policy and Mcts_policy classes.
+
+#include "ai.h"
+#include <cmath>
+
+//states visited per second of search.
+double Search_stats::nodes_per_second() const
+{
+	return seconds > 0 ? nodes / seconds : 0;
+}
+
+//share of table lookups that found a usable value.
+double Search_stats::hit_rate() const
+{
+	return probes > 0 ? double(hits) / double(probes) : 0;
+}
+
+
+/****** EXPECTIMAX_POLICY IMPLEMENTATION ******/
+
+//allocates the table (2^table_bits slots).
+Expectimax_policy::Expectimax_policy(int depth, int table_bits)
+	: depth(depth > 0 ? depth : 1), stats{0, 0, 0, 0, 0}
+{
+	if (table_bits < 4) table_bits = 4;
+	if (table_bits > 28) table_bits = 28;
+	table.assign(size_t(1) << table_bits, Entry{0, 0, 0});
+	mask = table.size() - 1;
+}
+
+//searches for the Pokemon it plays.
+int Expectimax_policy::choose(const Pokemon & self, const Pokemon & opponent, int turn)
+{
+	return choose(to_combatant(self), to_combatant(opponent));
+}
+
+//picks the action with the best expected score (Attack on a tie).
+int Expectimax_policy::choose(const Combatant & self, const Combatant & opponent)
+{
+	auto start = chrono::steady_clock::now();
+	++stats.decisions;
+	int best = ATTACK;
+	if (self.type >= FIRE && self.type <= GRASS && opponent.type >= FIRE && opponent.type <= GRASS)
+	{
+		Combatant hit = opponent;
+		combatant_strike(self, hit, ATTACK);
+		float attack = hit.health <= 0 ? 1.0f : search(self, hit, false, depth - 1);
+		hit = opponent;
+		combatant_strike(self, hit, SPECIAL);
+		float special = hit.health <= 0 ? 1.0f : search(self, hit, false, depth - 1);
+		best = special > attack ? SPECIAL : ATTACK;
+	}
+	stats.seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	return best;
+}
+
+//expected score (-1 lost .. 1 won) of taking the action now.
+double Expectimax_policy::evaluate(const Combatant & self, const Combatant & opponent, int action)
+{
+	Combatant hit = opponent;
+	combatant_strike(self, hit, action);
+	return hit.health <= 0 ? 1.0 : search(self, hit, false, depth - 1);
+}
+
+//running totals.
+const Search_stats & Expectimax_policy::get_stats() const
+{
+	return stats;
+}
+
+//zeroes the running totals (the table is kept).
+void Expectimax_policy::reset_stats()
+{
+	stats = Search_stats{0, 0, 0, 0, 0};
+}
+
+//forgets every stored state.
+void Expectimax_policy::clear_table()
+{
+	fill(table.begin(), table.end(), Entry{0, 0, 0});
+}
+
+//slots in the table.
+size_t Expectimax_policy::table_size() const
+{
+	return table.size();
+}
+
+//packs a state into 64 bits; the top bit is set so no state packs to 0 (empty).
+uint64_t Expectimax_policy::key(const Combatant & self, const Combatant & opponent, bool self_to_move)
+{
+	return (uint64_t(1) << 63) | (uint64_t(self.type) << 40) | (uint64_t(opponent.type) << 36)
+		| (uint64_t(uint16_t(self.health)) << 17) | (uint64_t(uint16_t(opponent.health)) << 1)
+		| uint64_t(self_to_move);
+}
+
+//expected score for the AI of the state, searched depth actions ahead.
+float Expectimax_policy::search(Combatant self, Combatant opponent, bool self_to_move, int depth)
+{
+	++stats.nodes;
+	if (depth <= 0)
+	{
+		return float(self.health - opponent.health) / float(FULL_HEALTH);
+	}
+
+	uint64_t packed = key(self, opponent, self_to_move);
+	Entry & slot = table[RNG::mix(packed) & mask];
+	++stats.probes;
+	if (slot.key == packed && slot.depth >= depth)
+	{
+		++stats.hits;
+		return slot.value;
+	}
+
+	float value;
+	if (self_to_move)
+	{
+		//max node: the AI's best action.
+		value = -1.0f;
+		for (int action = ATTACK; action <= SPECIAL; ++action)
+		{
+			Combatant hit = opponent;
+			combatant_strike(self, hit, action);
+			float score = hit.health <= 0 ? 1.0f : search(self, hit, false, depth - 1);
+			if (score > value)
+				value = score;
+		}
+	}
+	else
+	{
+		//chance node: the opponent picks either action.
+		value = 0.0f;
+		for (int action = ATTACK; action <= SPECIAL; ++action)
+		{
+			Combatant hit = self;
+			combatant_strike(opponent, hit, action);
+			value += 0.5f * (hit.health <= 0 ? -1.0f : search(hit, opponent, true, depth - 1));
+		}
+	}
+
+	if (slot.key != packed || slot.depth <= depth)
+		slot = Entry{packed, value, depth};
+	return value;
+}
+
+
+/****** MCTS_POLICY IMPLEMENTATION ******/
+
+const int MCTS_MAX_PATH = 256;		//deepest tree path followed in one playout.
+const int MCTS_ROLLOUT_TURNS = 400;	//actions before a playout is called a draw.
+const double MCTS_EXPLORATION = 1.4;	//UCT exploration constant.
+
+//playouts per second of wall time.
+double Mcts_stats::rollouts_per_second() const
+{
+	return seconds > 0 ? rollouts / seconds : 0;
+}
+
+//playouts per second for each searching thread.
+double Mcts_stats::rollouts_per_second_per_core() const
+{
+	return threads > 0 ? rollouts_per_second() / threads : 0;
+}
+
+//allocates the node pool and parks threads - 1 helpers.
+Mcts_policy::Mcts_policy(int threads, int budget_us, int max_nodes)
+	: threads(threads > 0 ? threads : 1), budget_us(budget_us > 0 ? budget_us : 1),
+	  capacity(max_nodes > 16 ? max_nodes : 16), pool(new Node[size_t(capacity)]),
+	  used(0), rollouts(0), stats{0, 0, 0, 0, 0}, generation(0), busy(0), quitting(false)
+{
+	stats.threads = this->threads;
+	for (int id = 1; id < this->threads; ++id)
+		workers.emplace_back(&Mcts_policy::work, this, id);
+}
+
+//wakes the helpers so they can quit.
+Mcts_policy::~Mcts_policy()
+{
+	{
+		lock_guard<mutex> hold(lock);
+		quitting = true;
+	}
+	wake.notify_all();
+	for (thread & worker : workers)
+		worker.join();
+}
+
+//searches for the Pokemon it plays.
+int Mcts_policy::choose(const Pokemon & self, const Pokemon & opponent, int turn)
+{
+	return choose(to_combatant(self), to_combatant(opponent));
+}
+
+//runs every thread until the budget is spent, returns the most visited action.
+int Mcts_policy::choose(const Combatant & self, const Combatant & opponent)
+{
+	if (self.type < FIRE || self.type > GRASS || opponent.type < FIRE || opponent.type > GRASS)
+		return ATTACK;
+	auto start = chrono::steady_clock::now();
+
+	//O(1) reset: the root is node 0, everything after it is free again.
+	Node & root = pool[0];
+	root.self = self;
+	root.opponent = opponent;
+	root.ai_to_move = 1;
+	root.mover = -1;
+	root.result = 0;
+	root.visits.store(0, memory_order_relaxed);
+	root.total.store(0, memory_order_relaxed);
+	root.child[0].store(-1, memory_order_relaxed);
+	root.child[1].store(-1, memory_order_relaxed);
+	used.store(1, memory_order_relaxed);
+	rollouts.store(0, memory_order_relaxed);
+	deadline = start + chrono::microseconds(budget_us);
+
+	uint64_t seed = RNG::mix(uint64_t(stats.decisions) + 1);
+	{
+		lock_guard<mutex> hold(lock);
+		++generation;
+		busy = threads - 1;
+	}
+	wake.notify_all();
+	search(seed);
+	{
+		unique_lock<mutex> hold(lock);
+		done.wait(hold, [this] { return busy == 0; });
+	}
+
+	int attack = root.child[0].load(memory_order_acquire);
+	int special = root.child[1].load(memory_order_acquire);
+	int best = ATTACK;
+	if (special >= 0 && (attack < 0 || pool[special].visits.load() > pool[attack].visits.load()))
+		best = SPECIAL;
+
+	++stats.decisions;
+	stats.rollouts += rollouts.load();
+	stats.nodes += min(used.load(), capacity);
+	stats.seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	return best;
+}
+
+//microseconds per move.
+void Mcts_policy::set_budget(int budget_us)
+{
+	this->budget_us = budget_us > 0 ? budget_us : 1;
+}
+
+//running totals.
+const Mcts_stats & Mcts_policy::get_stats() const
+{
+	return stats;
+}
+
+//zeroes the running totals.
+void Mcts_policy::reset_stats()
+{
+	stats = Mcts_stats{0, 0, 0, 0, threads};
+}
+
+//helper thread: waits for a decision, searches, reports back.
+void Mcts_policy::work(int id)
+{
+	long long seen = 0;
+	while (true)
+	{
+		{
+			unique_lock<mutex> hold(lock);
+			wake.wait(hold, [&] { return quitting || generation != seen; });
+			if (quitting)
+				return;
+			seen = generation;
+		}
+		search(RNG::mix(uint64_t(seen) * 0x9E3779B97F4A7C15ULL + uint64_t(id)));
+		{
+			lock_guard<mutex> hold(lock);
+			--busy;
+		}
+		done.notify_one();
+	}
+}
+
+//the child reached by the action, created (and published) on first use; -1 if the pool is full.
+int Mcts_policy::expand(int parent, int action)
+{
+	Node & from = pool[parent];
+	int existing = from.child[action].load(memory_order_acquire);
+	if (existing >= 0)
+		return existing;
+	int index = used.fetch_add(1, memory_order_relaxed);
+	if (index >= capacity)
+		return -1;
+
+	Node & made = pool[index];
+	made.self = from.self;
+	made.opponent = from.opponent;
+	if (from.ai_to_move)
+		combatant_strike(made.self, made.opponent, action + 1);
+	else
+		combatant_strike(made.opponent, made.self, action + 1);
+	made.ai_to_move = !from.ai_to_move;
+	made.mover = from.ai_to_move ? 1 : -1;
+	made.result = made.opponent.health <= 0 ? 1 : made.self.health <= 0 ? -1 : 0;
+	made.visits.store(0, memory_order_relaxed);
+	made.total.store(0, memory_order_relaxed);
+	made.child[0].store(-1, memory_order_relaxed);
+	made.child[1].store(-1, memory_order_relaxed);
+
+	//publish; if another thread got there first its node wins and this slot is wasted.
+	if (from.child[action].compare_exchange_strong(existing, index, memory_order_acq_rel))
+		return index;
+	return existing;
+}
+
+//the action UCT prefers at the node (unexpanded actions first).
+int Mcts_policy::select(int parent) const
+{
+	const Node & from = pool[parent];
+	double sign = from.ai_to_move ? 1.0 : -1.0;	//each side maximizes its own result.
+	double log_visits = log(double(from.visits.load(memory_order_relaxed)) + 1.0);
+	int best = 0;
+	double best_score = -1e300;
+	for (int action = 0; action < 2; ++action)
+	{
+		int index = from.child[action].load(memory_order_acquire);
+		if (index < 0)
+			return action;
+		const Node & child = pool[index];
+		int32_t visits = child.visits.load(memory_order_relaxed);
+		if (visits <= 0)
+			return action;
+		double mean = double(child.total.load(memory_order_relaxed)) / visits;
+		double score = sign * mean + MCTS_EXPLORATION * sqrt(log_visits / visits);
+		if (score > best_score)
+		{
+			best_score = score;
+			best = action;
+		}
+	}
+	return best;
+}
+
+//plays random actions until someone faints, returns +1 (AI won), -1 or 0 (too long).
+int Mcts_policy::rollout(Combatant self, Combatant opponent, bool ai_to_move, uint64_t & rng)
+{
+	for (int turn = 0; turn < MCTS_ROLLOUT_TURNS; ++turn)
+	{
+		rng ^= rng << 13;	//xorshift64
+		rng ^= rng >> 7;
+		rng ^= rng << 17;
+		int action = int(rng >> 63) + 1;
+		if (ai_to_move)
+		{
+			combatant_strike(self, opponent, action);
+			if (opponent.health <= 0)
+				return 1;
+		}
+		else
+		{
+			combatant_strike(opponent, self, action);
+			if (self.health <= 0)
+				return -1;
+		}
+		ai_to_move = !ai_to_move;
+	}
+	return 0;
+}
+
+//selection, expansion, rollout and backup until the deadline.
+void Mcts_policy::search(uint64_t seed)
+{
+	uint64_t rng = seed | 1;
+	int path[MCTS_MAX_PATH];
+	long long played = 0;
+	do
+	{
+		//descend, taking a virtual loss (for the side that chose it) on every node entered.
+		int length = 0;
+		int node = 0;
+		path[length++] = node;
+		pool[node].visits.fetch_add(1, memory_order_relaxed);
+		while (pool[node].result == 0 && length < MCTS_MAX_PATH)
+		{
+			int action = select(node);
+			bool fresh = pool[node].child[action].load(memory_order_acquire) < 0;
+			int next = expand(node, action);
+			if (next < 0)
+				break;	//pool full: play out from here.
+			node = next;
+			path[length++] = node;
+			pool[node].visits.fetch_add(1, memory_order_relaxed);
+			pool[node].total.fetch_add(-pool[node].mover, memory_order_relaxed);
+			if (fresh)
+				break;	//one new node per playout.
+		}
+
+		const Node & leaf = pool[node];
+		int result = leaf.result != 0 ? leaf.result : rollout(leaf.self, leaf.opponent, leaf.ai_to_move, rng);
+
+		//back up, replacing each virtual loss with the real result.
+		pool[path[0]].total.fetch_add(result, memory_order_relaxed);
+		for (int i = 1; i < length; ++i)
+			pool[path[i]].total.fetch_add(result + pool[path[i]].mover, memory_order_relaxed);
+		++played;
+	} while ((played & 15) != 0 || chrono::steady_clock::now() < deadline);
+	rollouts.fetch_add(played, memory_order_relaxed);
+}
+
+
+//prints the statistics of either AI, returns 0 if it is neither.
+int display_search_stats(const Policy & ai, ostream & out)
+{
+	if (const Expectimax_policy * expectimax = dynamic_cast<const Expectimax_policy *>(&ai))
+	{
+		const Search_stats & stats = expectimax->get_stats();
+		out << "Computer: " << stats.decisions << " moves, " << stats.nodes << " positions searched ("
+		    << (long long)stats.nodes_per_second() << "/s), table hit rate "
+		    << (int)(stats.hit_rate() * 100) << "%" << endl;
+		return 1;
+	}
+	if (const Mcts_policy * mcts = dynamic_cast<const Mcts_policy *>(&ai))
+	{
+		const Mcts_stats & stats = mcts->get_stats();
+		out << "Computer: " << stats.decisions << " moves, " << stats.rollouts << " rollouts on "
+		    << stats.threads << " threads (" << (long long)stats.rollouts_per_second_per_core()
+		    << "/s per core)" << endl;
+		return 1;
+	}
+	return 0;
+}
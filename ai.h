@@ -0,0 +1,153 @@
+// Author: Pokemon Battle contributors
+// Date: 10-17-2026
+//
+// This file contains the class declarations for the computer opponent.
+
+/*
+ * Expectimax AI for Pokemon Battle Simulation
+ *
+ * `Expectimax_policy` picks Attack or Special Ability for the Pokemon it plays by searching
+ * a fixed number of actions ahead. A battle state is just (own health, opponent health,
+ * side to move) for a pair of types, so:
+ * - The AI's own turns are max nodes (best of its two actions).
+ * - The opponent's turns are chance nodes (each action equally likely, since a human or a
+ *   random policy is on the other side).
+ * - Leaves are scored by the health difference; a won battle is +1 and a lost one -1.
+ *
+ * Every searched state is stored in a transposition table (a power of two array, one entry
+ * per slot; a new state takes the slot, the same state keeps its deepest result). The same
+ * states come up again through different move orders and on the next turn, so the table
+ * lives as long as the policy.
+ * Damage comes from the Combatant tables, never from the printing combat methods.
+ *
+ * `Mcts_policy` is the anytime alternative: Monte Carlo tree search that runs until a time
+ * budget (in microseconds) is spent and then plays the most visited action.
+ * - Tree parallel: a fixed pool of worker threads shares one tree. Node statistics are
+ *   atomics, children are published with compare-and-swap, nodes come from a preallocated
+ *   pool that is reset in O(1) before every decision -- no locks, no allocation.
+ * - Virtual loss: a thread counts a loss on every node of its path until its rollout is
+ *   backed up, so other threads spread out to other branches meanwhile.
+ * - Both sides pick the action best for themselves (UCT); rollouts play random actions on
+ *   Combatant values with a private generator, so they never print or allocate.
+ */
+
+#ifndef AI_H
+#define AI_H
+
+#include "engine.h"
+#include "combatant.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+const int DEFAULT_SEARCH_DEPTH = 12;	//actions searched ahead.
+const int DEFAULT_TABLE_BITS = 16;	//table slots = 2^bits.
+
+/* This struct holds what the searches have cost so far. */
+struct Search_stats
+{
+	long long decisions;	//choose() calls.
+	long long nodes;	//states visited.
+	long long probes;	//table lookups.
+	long long hits;		//lookups that returned a stored value.
+	double seconds;		//time spent searching.
+	double nodes_per_second() const;
+	double hit_rate() const;	//hits / probes.
+};
+
+/* This class is a depth limited expectimax search with a transposition table. */
+class Expectimax_policy: public Policy
+{
+	public:
+		Expectimax_policy(int depth = DEFAULT_SEARCH_DEPTH, int table_bits = DEFAULT_TABLE_BITS);
+		int choose(const Pokemon & self, const Pokemon & opponent, int turn);	//searches, returns ATTACK or SPECIAL.
+		int choose(const Combatant & self, const Combatant & opponent);		//the same on value types.
+		double evaluate(const Combatant & self, const Combatant & opponent, int action);	//expected score of an action.
+		const Search_stats & get_stats() const;
+		void reset_stats();
+		void clear_table();	//forgets every stored state.
+		size_t table_size() const;	//slots in the table.
+	private:
+		/* This struct is one table slot. */
+		struct Entry
+		{
+			uint64_t key;	//packed state, 0 = empty.
+			float value;	//expected score for the AI.
+			int32_t depth;	//how deep the value was searched.
+		};
+		int depth;		//actions searched ahead.
+		vector<Entry> table;	//the transposition table.
+		uint64_t mask;		//table size - 1.
+		Search_stats stats;	//running totals.
+		float search(Combatant self, Combatant opponent, bool self_to_move, int depth);	//expected score.
+		static uint64_t key(const Combatant & self, const Combatant & opponent, bool self_to_move);
+};
+
+const int DEFAULT_MCTS_BUDGET_US = 2000;	//search time per move.
+const int DEFAULT_MCTS_NODES = 1 << 16;	//tree size limit per move.
+
+/* This struct holds what the tree searches have cost so far. */
+struct Mcts_stats
+{
+	long long decisions;	//choose() calls.
+	long long rollouts;	//playouts finished, over every thread.
+	long long nodes;	//tree nodes created.
+	double seconds;		//wall time spent searching.
+	int threads;		//threads searching together.
+	double rollouts_per_second() const;
+	double rollouts_per_second_per_core() const;
+};
+
+/* This class is a tree parallel Monte Carlo tree search with a time budget. */
+class Mcts_policy: public Policy
+{
+	public:
+		Mcts_policy(int threads = 1, int budget_us = DEFAULT_MCTS_BUDGET_US, int max_nodes = DEFAULT_MCTS_NODES);
+		~Mcts_policy();		//stops the worker threads.
+		int choose(const Pokemon & self, const Pokemon & opponent, int turn);	//searches, returns ATTACK or SPECIAL.
+		int choose(const Combatant & self, const Combatant & opponent);		//the same on value types.
+		void set_budget(int budget_us);	//microseconds per move.
+		const Mcts_stats & get_stats() const;
+		void reset_stats();
+	private:
+		/* This struct is one tree node: the state after an action plus its statistics. */
+		struct alignas(64) Node
+		{
+			Combatant self;		//the AI's Pokemon.
+			Combatant opponent;	//the other Pokemon.
+			int8_t ai_to_move;	//1 if the AI moves next.
+			int8_t mover;		//+1 if the AI's action led here, -1 if the opponent's.
+			int8_t result;		//+1 AI won, -1 AI lost, 0 still running.
+			atomic<int32_t> visits;	//playouts through here (plus virtual losses in flight).
+			atomic<int64_t> total;	//sum of results, from the AI's side.
+			atomic<int32_t> child[2];	//node index per action, -1 = not expanded.
+		};
+		int threads;		//threads searching, including the caller.
+		int budget_us;		//microseconds per move.
+		int capacity;		//nodes in the pool.
+		unique_ptr<Node[]> pool;	//every node of the current tree; index 0 is the root.
+		atomic<int32_t> used;	//nodes handed out this decision.
+		atomic<long long> rollouts;	//playouts this decision.
+		chrono::steady_clock::time_point deadline;	//when to stop.
+		Mcts_stats stats;	//running totals.
+
+		vector<thread> workers;	//threads - 1 helpers, parked between decisions.
+		mutex lock;		//guards the fields below.
+		condition_variable wake;	//a new decision started (or quitting).
+		condition_variable done;	//a helper finished its part.
+		long long generation;	//decisions started.
+		int busy;		//helpers still searching.
+		bool quitting;		//set by the destructor.
+
+		void work(int id);	//helper thread body.
+		void search(uint64_t seed);	//runs playouts until the deadline.
+		int expand(int parent, int action);	//the child node, created on first use (-1 if the pool is full).
+		int select(int parent) const;	//the action UCT prefers.
+		static int rollout(Combatant self, Combatant opponent, bool ai_to_move, uint64_t & rng);	//random playout result.
+};
+
+int display_search_stats(const Policy & ai, ostream & out);	//prints the statistics of either AI, 0 if it is neither.
+
+#endif
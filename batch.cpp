@@ -0,0 +1,326 @@
+// Author: Pokemon Battle contributors
+// Date: 10-17-2026
+//
+// This file contains the implementation of the Battle_batch class and its turn kernels.
+
+/*
+ * Overview:
+ * - Every kernel works on a range of lanes. For each running lane:
+ *     damage = max((action == ATTACK ? attack : special) - other defend, 0)
+ *   is taken off the second Pokemon; lanes where it faints get winner 1 and stop.
+ *   The remaining lanes strike back at the first Pokemon the same way (winner 2).
+ * - "Running" is a mask (winner == 0), so finished battles and padding lanes are
+ *   carried along without being changed.
+ * - The AVX2 and SSE4.1 kernels are compiled with target attributes and picked
+ *   with __builtin_cpu_supports, so no special compiler flags are needed.
+ */
+
+#include "batch.h"
+
+static const int LANES = 8;	//arrays are padded to a multiple of the widest kernel.
+static const int32_t BOTH_FAINTED = 3;	//stored winner of a battle added with both sides down (reported as 0).
+
+typedef void (*Turn_kernel)(int32_t *, const int32_t *, const int32_t *, const int32_t *, const int32_t *,
+	int32_t *, const int32_t *, const int32_t *, const int32_t *, const int32_t *,
+	int32_t *, int32_t *, int);
+
+//plain C++ turn, one lane at a time.
+static void scalar_turn(int32_t * h1, const int32_t * a1, const int32_t * s1, const int32_t * d1, const int32_t * act1,
+	int32_t * h2, const int32_t * a2, const int32_t * s2, const int32_t * d2, const int32_t * act2,
+	int32_t * winner, int32_t * turns, int lanes)
+{
+	for (int i = 0; i < lanes; ++i)
+	{
+		if (winner[i] != 0)
+			continue;
+		++turns[i];
+		int32_t hit = (act1[i] == ATTACK ? a1[i] : s1[i]) - d2[i];
+		h2[i] -= hit > 0 ? hit : 0;
+		if (h2[i] <= 0)
+		{
+			h2[i] = 0;
+			winner[i] = 1;
+			continue;
+		}
+		hit = (act2[i] == ATTACK ? a2[i] : s2[i]) - d1[i];
+		h1[i] -= hit > 0 ? hit : 0;
+		if (h1[i] <= 0)
+		{
+			h1[i] = 0;
+			winner[i] = 2;
+		}
+	}
+}
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define HAVE_X86_KERNELS 1
+
+//8 lanes per instruction.
+__attribute__((target("avx2")))
+static void avx2_turn(int32_t * h1, const int32_t * a1, const int32_t * s1, const int32_t * d1, const int32_t * act1,
+	int32_t * h2, const int32_t * a2, const int32_t * s2, const int32_t * d2, const int32_t * act2,
+	int32_t * winner, int32_t * turns, int lanes)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i one = _mm256_set1_epi32(1);
+	const __m256i two = _mm256_set1_epi32(2);
+	const __m256i attack = _mm256_set1_epi32(ATTACK);
+	for (int i = 0; i < lanes; i += 8)
+	{
+		__m256i win = _mm256_loadu_si256((const __m256i *)(winner + i));
+		__m256i running = _mm256_cmpeq_epi32(win, zero);
+		if (_mm256_testz_si256(running, running))
+			continue;
+
+		__m256i turn = _mm256_loadu_si256((const __m256i *)(turns + i));
+		turn = _mm256_sub_epi32(turn, running);	//running lanes are -1.
+		_mm256_storeu_si256((__m256i *)(turns + i), turn);
+
+		//first strikes second.
+		__m256i uses_attack = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)(act1 + i)), attack);
+		__m256i power = _mm256_blendv_epi8(_mm256_loadu_si256((const __m256i *)(s1 + i)),
+			_mm256_loadu_si256((const __m256i *)(a1 + i)), uses_attack);
+		__m256i hit = _mm256_max_epi32(_mm256_sub_epi32(power, _mm256_loadu_si256((const __m256i *)(d2 + i))), zero);
+		__m256i health = _mm256_loadu_si256((const __m256i *)(h2 + i));
+		health = _mm256_blendv_epi8(health, _mm256_max_epi32(_mm256_sub_epi32(health, hit), zero), running);
+		_mm256_storeu_si256((__m256i *)(h2 + i), health);
+		__m256i fainted = _mm256_and_si256(running, _mm256_cmpeq_epi32(health, zero));
+		win = _mm256_blendv_epi8(win, one, fainted);
+		running = _mm256_andnot_si256(fainted, running);
+
+		//second strikes back.
+		uses_attack = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)(act2 + i)), attack);
+		power = _mm256_blendv_epi8(_mm256_loadu_si256((const __m256i *)(s2 + i)),
+			_mm256_loadu_si256((const __m256i *)(a2 + i)), uses_attack);
+		hit = _mm256_max_epi32(_mm256_sub_epi32(power, _mm256_loadu_si256((const __m256i *)(d1 + i))), zero);
+		health = _mm256_loadu_si256((const __m256i *)(h1 + i));
+		health = _mm256_blendv_epi8(health, _mm256_max_epi32(_mm256_sub_epi32(health, hit), zero), running);
+		_mm256_storeu_si256((__m256i *)(h1 + i), health);
+		fainted = _mm256_and_si256(running, _mm256_cmpeq_epi32(health, zero));
+		win = _mm256_blendv_epi8(win, two, fainted);
+		_mm256_storeu_si256((__m256i *)(winner + i), win);
+	}
+}
+
+//4 lanes per instruction.
+__attribute__((target("sse4.1")))
+static void sse41_turn(int32_t * h1, const int32_t * a1, const int32_t * s1, const int32_t * d1, const int32_t * act1,
+	int32_t * h2, const int32_t * a2, const int32_t * s2, const int32_t * d2, const int32_t * act2,
+	int32_t * winner, int32_t * turns, int lanes)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i one = _mm_set1_epi32(1);
+	const __m128i two = _mm_set1_epi32(2);
+	const __m128i attack = _mm_set1_epi32(ATTACK);
+	for (int i = 0; i < lanes; i += 4)
+	{
+		__m128i win = _mm_loadu_si128((const __m128i *)(winner + i));
+		__m128i running = _mm_cmpeq_epi32(win, zero);
+		if (_mm_testz_si128(running, running))
+			continue;
+
+		__m128i turn = _mm_loadu_si128((const __m128i *)(turns + i));
+		_mm_storeu_si128((__m128i *)(turns + i), _mm_sub_epi32(turn, running));
+
+		__m128i uses_attack = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(act1 + i)), attack);
+		__m128i power = _mm_blendv_epi8(_mm_loadu_si128((const __m128i *)(s1 + i)),
+			_mm_loadu_si128((const __m128i *)(a1 + i)), uses_attack);
+		__m128i hit = _mm_max_epi32(_mm_sub_epi32(power, _mm_loadu_si128((const __m128i *)(d2 + i))), zero);
+		__m128i health = _mm_loadu_si128((const __m128i *)(h2 + i));
+		health = _mm_blendv_epi8(health, _mm_max_epi32(_mm_sub_epi32(health, hit), zero), running);
+		_mm_storeu_si128((__m128i *)(h2 + i), health);
+		__m128i fainted = _mm_and_si128(running, _mm_cmpeq_epi32(health, zero));
+		win = _mm_blendv_epi8(win, one, fainted);
+		running = _mm_andnot_si128(fainted, running);
+
+		uses_attack = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(act2 + i)), attack);
+		power = _mm_blendv_epi8(_mm_loadu_si128((const __m128i *)(s2 + i)),
+			_mm_loadu_si128((const __m128i *)(a2 + i)), uses_attack);
+		hit = _mm_max_epi32(_mm_sub_epi32(power, _mm_loadu_si128((const __m128i *)(d1 + i))), zero);
+		health = _mm_loadu_si128((const __m128i *)(h1 + i));
+		health = _mm_blendv_epi8(health, _mm_max_epi32(_mm_sub_epi32(health, hit), zero), running);
+		_mm_storeu_si128((__m128i *)(h1 + i), health);
+		fainted = _mm_and_si128(running, _mm_cmpeq_epi32(health, zero));
+		win = _mm_blendv_epi8(win, two, fainted);
+		_mm_storeu_si128((__m128i *)(winner + i), win);
+	}
+}
+#endif
+
+//picks the widest kernel this CPU supports, once.
+static Turn_kernel pick_kernel(const char *& name)
+{
+#ifdef HAVE_X86_KERNELS
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+	{
+		name = "avx2";
+		return avx2_turn;
+	}
+	if (__builtin_cpu_supports("sse4.1"))
+	{
+		name = "sse4.1";
+		return sse41_turn;
+	}
+#endif
+	name = "scalar";
+	return scalar_turn;
+}
+
+static const char * chosen_name = "scalar";	//name of the kernel in use.
+static Turn_kernel turn_kernel = pick_kernel(chosen_name);	//kernel in use.
+
+
+/****** BATTLE_BATCH IMPLEMENTATION ******/
+
+//empty batch.
+Battle_batch::Battle_batch(): count(0)
+{}
+
+//copies both Pokemon's stats into the arrays.
+int Battle_batch::add(const Pokemon & first, const Pokemon & second, int first_action, int second_action)
+{
+	if (count == int(winner.size()))
+		pad();
+	int i = count++;
+	health1[i] = first.get_health();
+	attack1[i] = first.get_attack();
+	special1[i] = first.get_special();
+	defend1[i] = first.get_defend();
+	action1[i] = first_action;
+	health2[i] = second.get_health();
+	attack2[i] = second.get_attack();
+	special2[i] = second.get_special();
+	defend2[i] = second.get_defend();
+	action2[i] = second_action;
+	turns[i] = 0;
+	//same rule as Battle_engine: over if either side is down, no winner if both are.
+	if (health1[i] <= 0 || health2[i] <= 0)
+		winner[i] = health1[i] > 0 ? 1 : health2[i] > 0 ? 2 : BOTH_FAINTED;
+	else
+		winner[i] = 0;
+	return i;
+}
+
+//changes the actions used from the next turn on.
+void Battle_batch::set_actions(int index, int first_action, int second_action)
+{
+	if (index < 0 || index >= count)
+		return;
+	action1[index] = first_action;
+	action2[index] = second_action;
+}
+
+//advances every running battle one turn.
+int Battle_batch::step()
+{
+	if (count == 0)
+		return 0;
+	turn_kernel(health1.data(), attack1.data(), special1.data(), defend1.data(), action1.data(),
+		health2.data(), attack2.data(), special2.data(), defend2.data(), action2.data(),
+		winner.data(), turns.data(), int(winner.size()));
+	int running = 0;
+	for (int i = 0; i < count; ++i)
+		running += winner[i] == 0;
+	return running;
+}
+
+//steps until every battle is over or the turn limit is hit. Battles where
+//neither side can do damage are draws and don't keep the loop going.
+int Battle_batch::run(int max_turns)
+{
+	int stalled = 0;
+	for (int i = 0; i < count; ++i)
+	{
+		int hit1 = (action1[i] == ATTACK ? attack1[i] : special1[i]) - defend2[i];
+		int hit2 = (action2[i] == ATTACK ? attack2[i] : special2[i]) - defend1[i];
+		stalled += winner[i] == 0 && hit1 <= 0 && hit2 <= 0;
+	}
+	int taken = 0;
+	while (taken < max_turns && step() > stalled)
+		++taken;
+	return taken;
+}
+
+//number of battles.
+int Battle_batch::size() const
+{
+	return count;
+}
+
+//1, 2 or 0.
+int Battle_batch::get_winner(int index) const
+{
+	if (index < 0 || index >= count)
+		return -1;
+	return winner[index] == BOTH_FAINTED ? 0 : winner[index];
+}
+
+//turns taken.
+int Battle_batch::get_turns(int index) const
+{
+	return index >= 0 && index < count ? turns[index] : 0;
+}
+
+//health of side 1 or 2.
+int Battle_batch::get_health(int index, int side) const
+{
+	if (index < 0 || index >= count)
+		return 0;
+	return side == 1 ? health1[index] : health2[index];
+}
+
+//removes every battle.
+void Battle_batch::clear()
+{
+	vector<int32_t> * fields[] = {&health1, &attack1, &special1, &defend1, &action1,
+		&health2, &attack2, &special2, &defend2, &action2, &winner, &turns};
+	for (vector<int32_t> * field : fields)
+		field->clear();
+	count = 0;
+}
+
+//name of the kernel in use.
+const char * Battle_batch::kernel_name()
+{
+	return chosen_name;
+}
+
+//switches to the named kernel if this CPU runs it.
+int Battle_batch::use_kernel(const string & name)
+{
+	if (name == "scalar")
+	{
+		chosen_name = "scalar";
+		turn_kernel = scalar_turn;
+		return 1;
+	}
+#ifdef HAVE_X86_KERNELS
+	__builtin_cpu_init();
+	if (name == "avx2" && __builtin_cpu_supports("avx2"))
+	{
+		chosen_name = "avx2";
+		turn_kernel = avx2_turn;
+		return 1;
+	}
+	if (name == "sse4.1" && __builtin_cpu_supports("sse4.1"))
+	{
+		chosen_name = "sse4.1";
+		turn_kernel = sse41_turn;
+		return 1;
+	}
+#endif
+	return 0;
+}
+
+//doubles every array (always a multiple of LANES), padding lanes start out finished.
+void Battle_batch::pad()
+{
+	size_t grown = winner.empty() ? LANES : winner.size() * 2;
+	vector<int32_t> * fields[] = {&health1, &attack1, &special1, &defend1, &action1,
+		&health2, &attack2, &special2, &defend2, &action2, &turns};
+	for (vector<int32_t> * field : fields)
+		field->resize(grown, 0);
+	winner.resize(grown, -1);
+}
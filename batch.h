@@ -0,0 +1,53 @@
+// Author: Pokemon Battle contributors
+// Date: 10-17-2026
+//
+// This file contains the class declaration for the batched (structure-of-arrays) battle kernel.
+
+/*
+ * Batched Battle Kernel for Pokemon Battle Simulation
+ *
+ * `Battle_batch` stores N battles as parallel arrays -- health, attack, special and defend
+ * values for each side, plus the action each side uses -- instead of 2N Pokemon objects.
+ * `step` advances every battle by one turn with the same rules as `Battle_engine`:
+ * the first Pokemon acts, and if the second is still standing it acts back.
+ *
+ * The turn kernel has three versions, picked once at run time:
+ * - AVX2 (8 battles per instruction) and SSE4.1 (4 per instruction) on x86-64,
+ * - a scalar loop everywhere else.
+ * All three give identical results; `use_kernel` switches between them to compare.
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "engine.h"
+#include <cstdint>
+
+/* This class holds many battles at once and advances all of them together. */
+class Battle_batch
+{
+	public:
+		Battle_batch();		//empty batch.
+		int add(const Pokemon & first, const Pokemon & second,
+			int first_action = ATTACK, int second_action = ATTACK);	//copies the stats, returns the battle's index.
+		void set_actions(int index, int first_action, int second_action);	//changes the actions for later turns.
+		int step();		//advances every running battle one turn, returns how many are still running.
+		int run(int max_turns = 10000);	//steps until every battle is over or stalled (or the limit), returns turns taken.
+		int size() const;	//number of battles.
+		int get_winner(int index) const;	//1, 2 or 0 (still running / draw).
+		int get_turns(int index) const;	//turns the battle has taken.
+		int get_health(int index, int side) const;	//health of side 1 or 2.
+		void clear();		//removes every battle.
+		static const char * kernel_name();	//"avx2", "sse4.1" or "scalar".
+		static int use_kernel(const string & name);	//switches kernels (checks, benchmarks; no batch may be running): 1 = done, 0 = not on this CPU.
+	private:
+		//one array per field, padded to a multiple of LANES with finished dummy battles.
+		vector<int32_t> health1, attack1, special1, defend1, action1;
+		vector<int32_t> health2, attack2, special2, defend2, action2;
+		vector<int32_t> winner;	//0 while running, 1 or 2 once over, 3 if added with both down, -1 for padding.
+		vector<int32_t> turns;	//turns taken.
+		int count;		//real battles (without padding).
+		void pad();		//grows the arrays to a multiple of LANES.
+};
+
+#endif
@@ -6,7 +6,7 @@
 /*
  * Overview:
  * - `Trainer` Class:
- *   - Manages a trainer's Pokemon team using a BST.
+ *   - Manages a trainer's Pokemon team using a B-tree (Roster).
  *   - Provides functionality to build a team, display the team, remove all Pokemon, and retrieve a Pokemon for battle.
  *
  * - `Stadium` Class:
@@ -20,10 +20,11 @@
  */
 
 #include "battle.h"
+#include "battle_log.h"
 
 /****** TRAINER CLASS IMPLEMENTATION *****/
 // Default constructor initializes the trainer's name.
-Trainer::Trainer() : name("")
+Trainer::Trainer() : name(""), quiet(false)
 {}
 
 // Destructor removes all Pokemon from the team.
@@ -35,14 +36,7 @@ Trainer::~Trainer()
 //returns a random number from the given range
 int Trainer::random_num(int min, int max)
 {
-	if (min > max) {
-		throw "Invalid Range: min should be <= max.";
-	}
-	random_device rd;
-	mt19937 gen(rd());	//gets the random num	
-	uniform_int_distribution<> distrib(min,max);
-	return distrib(gen);
-
+	return RNG::random_num(min, max);	//per thread engine, seeded once.
 }
 
 //returns name for simplicity.
@@ -66,31 +60,24 @@ int Trainer::build_team(int size)
 		return -1;
 	}
 
+	vector<Pokemon *> batch;
+	batch.reserve(size);
 	for (int i = 0; i < size; ++i)
 	{
 		int type = random_num(1, 3); // Randomly decide Pokemon type (1 = Fire, 2 = Water, 3 = Grass)
-		Pokemon *new_pokemon = nullptr;
 
-		if (type == 1)
-		{
-			new_pokemon = new Fire();
-		}
-		else if (type == 2)
-		{
-			new_pokemon = new Water();
-		}
-		else if (type == 3)
-		{
-			new_pokemon = new Grass();
-		}
-		else
+		// Made directly in the roster's pool, linked all at once below
+		Pokemon *new_pokemon = my_pokemons.make(type);
+		if (!new_pokemon)
 		{
 			cerr << "Error: Invalid Pokemon type generated." << endl;
 			continue;
 		}
-
-		add_pokemon(new_pokemon);
+		batch.push_back(new_pokemon);
+		if (!quiet)
+			cout << "\t" << new_pokemon->get_name() << " added to " << name << "'s team." << endl;
 	}
+	my_pokemons.bulk_load(batch);
 
 	return 0; // Success
 }
@@ -104,9 +91,10 @@ int Trainer::add_pokemon(Pokemon *new_pokemon)
 		return -1;
 	}
 
-	// Insert into the team's 2-3 tree
+	if (!quiet)
+		cout << "\t" << new_pokemon->get_name() << " added to " << name << "'s team." << endl;
+	// Moves it into the team's B-tree (new_pokemon is deleted)
 	my_pokemons.insert(new_pokemon);
-	cout << "\t" << new_pokemon->get_name() << " added to " << name << "'s team." << endl;
 	return 0;
 }
 
@@ -121,11 +109,40 @@ void Trainer::display_team() const
 void Trainer::remove_all_pokemon()
 {
 	my_pokemons.remove_all(); // Assumes `remove_all()` clears the tree
-	cout << name << "'s team has been cleared." << endl;
+	if (!quiet)
+		cout << name << "'s team has been cleared." << endl;
+}
+
+// Appends every Pokemon on the team, the trainer keeps ownership.
+int Trainer::get_team(vector<Pokemon *> &team) const
+{
+	return my_pokemons.collect(team);
+}
+
+// Finds one exact team member by its (species id, instance id) key.
+Pokemon *Trainer::get_pokemon(int species_id, uint32_t id) const
+{
+	Pokemon *found = nullptr;
+	my_pokemons.retrieve(species_id, id, found);
+	return found;
+}
+
+// Same, but the team's own copy, safe to change while snapshots of the team exist.
+Pokemon *Trainer::get_pokemon_for_update(int species_id, uint32_t id)
+{
+	Pokemon *found = nullptr;
+	my_pokemons.retrieve_for_update(species_id, id, found);
+	return found;
+}
+
+// Turns the team announcements off (or back on).
+void Trainer::set_quiet(bool to_set)
+{
+	quiet = to_set;
 }
 
 // Prompts the user to choose a Pokemon by name and retrieves it from the team.
-Pokemon *&Trainer::send_to_battle()
+Pokemon *Trainer::send_to_battle()
 {
 	string chosen_name; // Store the Pokemon name input by the user
 	cout << "\nCurrent Team: " << endl;
@@ -135,7 +152,27 @@ Pokemon *&Trainer::send_to_battle()
 	// Prompt the user to pick a Pokemon by name
 	cout << endl << name << endl << "Choose a Pokemon to battle by its name: ";
 	getline(cin, chosen_name);
-	return my_pokemons.retrieve(chosen_name);	//returns the pokemon returned from retrieve function.
+	Pokemon *chosen = nullptr;
+	// A name that isn't exact can still be the start of exactly one name on the team, in any case
+	vector<int> matches;
+	if (Pokemon::species_id(chosen_name) < 0 && !chosen_name.empty() && my_pokemons.complete(chosen_name, matches) == 1)
+		chosen_name = Pokemon::species_name(matches[0]);
+	// Battles change its health, so get the team's own copy (not one a snapshot shares)
+	if (!my_pokemons.retrieve_for_update(chosen_name, chosen))
+	{
+		cerr << "Error: Pokemon not found." << endl;
+		// Several names on the team start that way, or it is close to some: list them
+		if (matches.empty())
+			my_pokemons.suggest(chosen_name, NAME_SUGGESTION_EDITS, matches);
+		if (!matches.empty())
+		{
+			cerr << "Did you mean:";
+			for (int species : matches)
+				cerr << " " << Pokemon::species_name(species);
+			cerr << "?" << endl;
+		}
+	}
+	return chosen;	//nullptr when the name isn't on the team.
 }
 
 /***** END OF TRAINER CLASS *****/
@@ -145,7 +182,7 @@ Pokemon *&Trainer::send_to_battle()
 
 /******* GAME CLASS IMPLEMENTATION ********/
 // Default constructor for the Stadium
-Stadium::Stadium():trainer1_wins(0), trainer2_wins(0)
+Stadium::Stadium():trainer1_wins(0), trainer2_wins(0), ai_side(0)
 {
 	cout << "Welcome to the Pokemon Stadium!" << endl;
 }
@@ -258,19 +295,21 @@ void Stadium::start_battle()
 	cout << "\nThe battle between " << trainer1.get_name() << " and " << trainer2.get_name() << " begins!" << endl;
 
 	Pokemon *pokemon1 = trainer1.send_to_battle();
+	if (!pokemon1)
+	{
+		return;	//mistyped name: back to the menu.
+	}
 	cout << "\n\n";
 	pokemon1->display();	
 	cout << "\nReady to Battle!!!\n";
 	Pokemon *pokemon2 = trainer2.send_to_battle();
-	cout << "\n\n";
-	pokemon1->display();	
-	cout << "\nReady to Battle!!!\n";
-
-	if (!pokemon1 || !pokemon2)
+	if (!pokemon2)
 	{
-		cerr << "Error: Unable to retrieve Pokemon for battle!" << endl;
 		return;
 	}
+	cout << "\n\n";
+	pokemon2->display();	
+	cout << "\nReady to Battle!!!\n";
 
 	// Perform the battle
 	int result = battle(pokemon1, pokemon2);
@@ -287,6 +326,40 @@ void Stadium::start_battle()
 }
 
 
+//records every later battle into a binary log file.
+void Stadium::set_log(const string & path)
+{
+	log_path = path;
+}
+
+//lets the computer pick trainer 1's or trainer 2's moves (0 = both human).
+void Stadium::set_ai(int side, Policy * computer)
+{
+	ai_side = side == 1 || side == 2 ? side : 0;
+	if (computer)
+		ai.reset(computer);
+	else if (ai_side && !ai)
+		ai.reset(new Expectimax_policy());
+}
+
+//the computer player, nullptr if off.
+const Policy * Stadium::get_ai() const
+{
+	return ai_side ? ai.get() : nullptr;
+}
+
+//returns trainer 1 or 2.
+Trainer & Stadium::get_trainer(int which)
+{
+	return which == 2 ? trainer2 : trainer1;
+}
+
+//returns trainer 1 or 2.
+const Trainer & Stadium::get_trainer(int which) const
+{
+	return which == 2 ? trainer2 : trainer1;
+}
+
 //prompts for input and does error checking.
 int Stadium::input(int min, int max) const
 {
@@ -320,83 +393,43 @@ void Stadium::show_score() const
 	cout << trainer2.get_name() << ": " << trainer2_wins << " wins" << endl;
 }
 
-//lets the pokemons battle each other.
+//lets the pokemons battle each other, both sides chosen from the menu.
 int Stadium::battle(Pokemon *first, Pokemon *second)
 {
-	if (!first || !second)
+	Text_events console;
+	Interactive_policy player(*this, console);
+	Policy & first_player = ai_side == 1 ? *ai : (Policy &)player;
+	Policy & second_player = ai_side == 2 ? *ai : (Policy &)player;
+	if (log_path.empty())
 	{
-		cerr << "Error: Null Pokemon pointers passed to the battle function!" << endl;
-		return -1; // Indicates an error
+		Battle_engine engine(first, second, &console);
+		return engine.run(first_player, second_player).winner;
 	}
 
-	cout << "\n--- Battle Beins ---" << endl;
-	cout << first->get_name() << " (Health: " << first->get_health() << ")"
-		<< " vs. "
-		<< second->get_name() << " (Health: " << second->get_health() << ")" << endl;
-
-	// Continue the battle until one Pokemon's health reaches 0
-	while (first->get_health() > 0 && second->get_health() > 0)
-	{
-		// Player 1's turn
-		cout << "\nWhat should " << first->get_name() << " do? (1 = Attack, 2 = Special Ability): ";
-		int choice = input(1, 2);
-
-		int first_action = 0;
-		if (choice == 1)
-		{
-			first_action = first->attack();
-			cout << first->get_name() << " attacks!" << endl;
-		}
-		else if (choice == 2)
-		{
-			first_action = first->special_ability();
-			cout << first->get_name() << " uses its special ability!" << endl;
-		}
-
-		int damage_to_second = first_action - second->defend();
-		if (damage_to_second < 0) damage_to_second = 0;
-
-		second->reduce_health(damage_to_second);
-		cout << first->get_name() << " dealt " << damage_to_second << " damage to "
-			<< second->get_name() << "." << endl;
-		cout << second->get_name() << " (Remaining Health: " << second->get_health() << ")" << endl;
-
-		if (second->get_health() <= 0)
-		{
-			cout << second->get_name() << " fainted! " << first->get_name() << " wins the battle!" << endl;
-			return 1; // First Pokemon wins
-		}
+	Log_record record;
+	int winner = Battle_log::play(first, second, first_player, second_player, record, &console).winner;
+	vector<uint8_t> encoded;
+	Battle_log::encode(record, encoded);
+	if (Battle_log::append_file(log_path, encoded) < 0)
+		console.on_error("Cannot write the battle log.");
+	return winner;
+}
+/***** END OF STADIUM CLASS *****/
 
-		// Player 2's turn
-		cout << "\nWhat should " << second->get_name() << " do? (1 = Attack, 2 = Special Ability): ";
-		choice = input(1, 2);
 
-		int second_action = 0;
-		if (choice == 1)
-		{
-			second_action = second->attack();
-			cout << second->get_name() << " attacks!" << endl;
-		}
-		else if (choice == 2)
-		{
-			second_action = second->special_ability();
-			cout << second->get_name() << " uses its special ability!" << endl;
-		}
 
-		int damage_to_first = second_action - first->defend();
-		if (damage_to_first < 0) damage_to_first = 0;
 
-		first->reduce_health(damage_to_first);
-		cout << second->get_name() << " dealt " << damage_to_first << " damage to "
-			<< first->get_name() << "." << endl;
-		cout << first->get_name() << " (Remaining Health: " << first->get_health() << ")" << endl;
+/****** INTERACTIVE_POLICY IMPLEMENTATION ******/
 
-		if (first->get_health() <= 0)
-		{
-			cout << first->get_name() << " fainted! " << second->get_name() << " wins the battle!" << endl;
-			return 2; // Second Pokemon wins
-		}
-	}
+//keeps the stadium for its input checking.
+Interactive_policy::Interactive_policy(const Stadium & stadium, Battle_events & events)
+	: stadium(stadium), events(events)
+{}
 
-	return 0; // Should not reach here, but added for completeness
+//asks the user what the Pokemon should do.
+int Interactive_policy::choose(const Pokemon & self, const Pokemon & opponent, int turn)
+{
+	events.flush();
+	cout << "\nWhat should " << self.get_name() << " do? (1 = Attack, 2 = Special Ability): ";
+	return stadium.input(1, 2);
 }
@@ -9,9 +9,11 @@
  * This file defines the `Trainer` and `Stadium` classes, which together simulate Pokémon battles between trainers.
  * 
  * - `Trainer` Class:
- *   - Manages a Pokémon team using a 2-3 tree (`my_pokemons`), allowing the trainer to build a team, add Pokémon, 
+ *   - Manages a Pokémon team using a B-tree (`my_pokemons`), allowing the trainer to build a team, add Pokémon, 
  *     choose Pokémon for battle, and display or remove their entire team.
  *   - Attributes include the trainer's name and their Pokémon collection.
+ *   - `send_to_battle` takes the exact name, or any prefix (in any case) that only one name on the team
+ *     starts with; otherwise it lists the names on the team it could mean.
  * 
  * - `Stadium` Class:
  *   - Represents the battle arena where two trainers (`trainer1` and `trainer2`) compete.
@@ -21,10 +23,33 @@
  * 
  */
 
+#ifndef BATTLE_H
+#define BATTLE_H
+
 #include "data_structures.h"
+#include "engine.h"
+#include "ai.h"
+
+class Stadium;
+
+const int NAME_SUGGESTION_EDITS = 2;	//typos send_to_battle still suggests a name for.
+
+/* This class is the interactive menu as a battle policy: it asks the
+ * user what each Pokemon should do, using the stadium's input checking.
+ * Buffered battle text is flushed before every prompt.
+ */
+class Interactive_policy: public Policy
+{
+	public:
+		Interactive_policy(const Stadium & stadium, Battle_events & events);	//prompts through this stadium.
+		int choose(const Pokemon & self, const Pokemon & opponent, int turn);	//prompts the user.
+	private:
+		const Stadium & stadium;	//used for input validation.
+		Battle_events & events;		//flushed before prompting.
+};
 
 /* This class is represent a individual trainer, which can have 
- * multiple pokemons -- stored using a 2-3 tree. trainer also 
+ * multiple pokemons -- stored using a B-tree. trainer also 
  * has a nickname stored.
  */
 class Trainer
@@ -33,17 +58,22 @@ class Trainer
 		Trainer();			//constructor
 		~Trainer();			//destructor
 		int build_team(int size);	//builds the team of certain size.
-		int add_pokemon(Pokemon * new_pokemon);	//adds the pokemon passed in to the team.
+		int add_pokemon(Pokemon * new_pokemon);	//moves the heap pokemon passed in into the team (it is deleted).
 		int choose_battle();	//choose your pokemon for batte
 		int set_name(string & toset);		//prompts the user for name. 
 		const string &get_name() const;    // Retrieves the trainer's name
 		int random_num(int min, int max);	//random number function for ease of access.
 		void display_team() const;	//displays the entire team of pokemons.
 		void remove_all_pokemon();	//removes the entire team;
-		Pokemon *& send_to_battle();	//sends one of the pokemons to battle.
+		int get_team(vector<Pokemon *> & team) const;	//appends the whole team (still owned by the trainer).
+		Pokemon * get_pokemon(int species_id, uint32_t id) const;	//one exact team member, nullptr if not on the team.
+		Pokemon * get_pokemon_for_update(int species_id, uint32_t id);	//same, but never shared with a copy of the trainer.
+		void set_quiet(bool to_set);	//true = don't announce added/cleared Pokemon (servers, simulations).
+		Pokemon * send_to_battle();	//sends one of the pokemons to battle by name or unique prefix (any case); nullptr, with suggestions, if it isn't on the team.
 	private:
-		BST my_pokemons;	//the pokemons trainer has collected so far.
+		Roster my_pokemons;	//the pokemons trainer has collected so far.
 		string name;	//name of the trainer
+		bool quiet;	//skip the team announcements.
 };
 
 /* This class is responsible for the staduim related activites needed to make 
@@ -60,10 +90,21 @@ class Stadium
 		void display_trainers() const; // Display either trainer's team
 		void show_score() const;	// Display the current score for both trainers
 		int battle(Pokemon * first, Pokemon * second);	//lets the passed in pokemons battle each other.
+		void set_log(const string & path);	//records every battle into a binary log ("" = off).
+		Trainer & get_trainer(int which);	//returns trainer 1 or 2.
+		const Trainer & get_trainer(int which) const;	//returns trainer 1 or 2.
+		void set_ai(int side, Policy * computer = nullptr);	//the computer (expectimax by default, owned from now on) plays trainer 1 or 2 (0 = both human).
+		const Policy * get_ai() const;	//the computer player, nullptr if off.
 	private:
 		Trainer trainer1;	// First trainer
 		Trainer trainer2;	// Second trainer
 		int trainer1_wins;	// Battles won by trainer 1
 		int trainer2_wins;	// Battles won by trainer 2
+		string log_path;	// Binary battle log, empty if off
+		int ai_side;		// Trainer played by the computer, 0 if none
+		unique_ptr<Policy> ai;	// Kept between battles so its search state is reused
 		int input(int min, int max) const;// Helper function for input validation
+		friend class Interactive_policy;
 };
+
+#endif
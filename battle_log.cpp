@@ -0,0 +1,345 @@
+// Author: Pokemon Battle contributors
+// Date: 10-17-2026
+//
+// This file contains the implementation of the Recording_policy and Battle_log classes.
+
+/*
+ * Overview:
+ * - Record layout (all numbers varints unless noted):
+ *     seed, battle id,
+ *     first Pokemon, second Pokemon:  1 byte (type << 4 | species), health,
+ *                                     zigzag deltas of attack/special/defend from base stats,
+ *     turns, winner + 1 (so -1 fits), damage to first, damage to second,
+ *     first side's action count + bits, second side's action count + bits (bit set = SPECIAL).
+ * - Each record is prefixed with its byte length, so a reader can skip records it can't use.
+ */
+
+#include "battle_log.h"
+#include "matchup.h"
+
+static const char MAGIC[4] = {'P', 'K', 'B', 'L'};	//file signature.
+static const uint8_t VERSION = 1;			//format version.
+
+//zigzag: small negative and positive numbers both become small unsigned ones.
+static uint64_t zigzag(int64_t value)
+{
+	return (uint64_t(value) << 1) ^ uint64_t(value >> 63);
+}
+
+//undoes zigzag.
+static int64_t unzigzag(uint64_t value)
+{
+	return int64_t(value >> 1) ^ -int64_t(value & 1);
+}
+
+
+/****** RECORDING_POLICY IMPLEMENTATION ******/
+
+//records into actions.
+Recording_policy::Recording_policy(Policy & inner, vector<uint8_t> & actions): inner(inner), actions(actions)
+{}
+
+//asks the wrapped policy and remembers the answer.
+int Recording_policy::choose(const Pokemon & self, const Pokemon & opponent, int turn)
+{
+	int action = inner.choose(self, opponent, turn);
+	actions.push_back(uint8_t(action));
+	return action;
+}
+
+
+/****** BATTLE_LOG IMPLEMENTATION ******/
+
+//snapshot of a Pokemon.
+Log_pokemon Battle_log::capture(const Pokemon & pokemon)
+{
+	return Log_pokemon{pokemon.get_type(), pokemon.get_species(), pokemon.get_health(),
+		pokemon.get_attack(), pokemon.get_special(), pokemon.get_defend()};
+}
+
+//runs a battle through the engine and records it.
+Battle_result Battle_log::play(Pokemon * first, Pokemon * second, Policy & first_policy,
+	Policy & second_policy, Log_record & record, Battle_events * events)
+{
+	Stream * stream = RNG::current_stream();
+	record.seed = RNG::get_seed();
+	record.battle_id = stream ? stream->get_battle_id() : 0;
+	record.first_actions.clear();
+	record.second_actions.clear();
+	if (first)
+		record.first = capture(*first);
+	if (second)
+		record.second = capture(*second);
+
+	Recording_policy first_recorder(first_policy, record.first_actions);
+	Recording_policy second_recorder(second_policy, record.second_actions);
+	Battle_engine engine(first, second, events);
+	record.result = engine.run(first_recorder, second_recorder);
+	return record.result;
+}
+
+//"PKBL" + version.
+void Battle_log::write_header(vector<uint8_t> & out)
+{
+	out.insert(out.end(), MAGIC, MAGIC + 4);
+	out.push_back(VERSION);
+}
+
+//appends one record, prefixed with its length.
+void Battle_log::encode(const Log_record & record, vector<uint8_t> & out)
+{
+	vector<uint8_t> body;
+	body.reserve(32);
+	put_varint(body, record.seed);
+	put_varint(body, record.battle_id);
+	put_pokemon(body, record.first);
+	put_pokemon(body, record.second);
+	put_varint(body, uint64_t(record.result.turns));
+	body.push_back(uint8_t(record.result.winner + 1));
+	put_varint(body, uint64_t(record.result.damage_to_first));
+	put_varint(body, uint64_t(record.result.damage_to_second));
+	put_actions(body, record.first_actions);
+	put_actions(body, record.second_actions);
+
+	put_varint(out, body.size());
+	out.insert(out.end(), body.begin(), body.end());
+}
+
+//checks the file header, leaving pos after it.
+int Battle_log::check_header(const vector<uint8_t> & in, size_t & pos)
+{
+	if (in.size() < pos + 5)
+		return 0;
+	for (int i = 0; i < 4; ++i)
+		if (in[pos + i] != uint8_t(MAGIC[i]))
+			return 0;
+	if (in[pos + 4] != VERSION)
+		return 0;
+	pos += 5;
+	return 1;
+}
+
+//reads the record at pos.
+int Battle_log::decode(const vector<uint8_t> & in, size_t & pos, Log_record & record)
+{
+	if (pos >= in.size())
+		return 0;
+	uint64_t length = 0;
+	if (!get_varint(in, pos, in.size(), length) || length > in.size() - pos)
+		return -1;
+	size_t end = pos + size_t(length);
+
+	uint64_t turns = 0, damage_first = 0, damage_second = 0;
+	if (!get_varint(in, pos, end, record.seed) || !get_varint(in, pos, end, record.battle_id)
+		|| !get_pokemon(in, pos, end, record.first) || !get_pokemon(in, pos, end, record.second)
+		|| !get_varint(in, pos, end, turns) || pos >= end)
+		return -1;
+	record.result.turns = int(turns);
+	record.result.winner = int(in[pos++]) - 1;
+	if (!get_varint(in, pos, end, damage_first) || !get_varint(in, pos, end, damage_second)
+		|| !get_actions(in, pos, end, record.first_actions) || !get_actions(in, pos, end, record.second_actions))
+		return -1;
+	record.result.damage_to_first = int(damage_first);
+	record.result.damage_to_second = int(damage_second);
+	pos = end;
+	return 1;
+}
+
+//rebuilds both Pokemon and plays the recorded actions back.
+int Battle_log::replay(const Log_record & record, Battle_result & got)
+{
+	got = Battle_result{-1, 0, 0, 0};
+	Pokemon * first = rebuild(record.first);
+	Pokemon * second = rebuild(record.second);
+	int reproduced = 0;
+	if (first && second)
+	{
+		Stream stream(record.seed, record.battle_id);
+		Stream_scope scope(stream);
+		vector<int> first_script(record.first_actions.begin(), record.first_actions.end());
+		vector<int> second_script(record.second_actions.begin(), record.second_actions.end());
+		Scripted_policy first_policy(first_script);
+		Scripted_policy second_policy(second_script);
+		Battle_engine engine(first, second);
+		got = engine.run(first_policy, second_policy);
+		reproduced = got.winner == record.result.winner && got.turns == record.result.turns
+			&& got.damage_to_first == record.result.damage_to_first
+			&& got.damage_to_second == record.result.damage_to_second;
+	}
+	delete first;
+	delete second;
+	return reproduced;
+}
+
+//replays every record of a file and reports the totals.
+int Battle_log::replay_file(const string & path, ostream & report)
+{
+	ifstream file(path, ios::binary);
+	if (!file)
+	{
+		report << "Cannot open battle log " << path << endl;
+		return -1;
+	}
+	vector<uint8_t> in((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+	size_t pos = 0;
+	if (!check_header(in, pos))
+	{
+		report << path << " is not a battle log." << endl;
+		return -1;
+	}
+
+	long long battles = 0, failed = 0;
+	Log_record record;
+	Battle_result got;
+	int status;
+	while ((status = decode(in, pos, record)) == 1)
+	{
+		++battles;
+		if (!replay(record, got))
+		{
+			++failed;
+			if (failed <= 10)
+				report << "Battle " << record.battle_id << " was not reproduced (winner "
+					<< got.winner << " vs " << record.result.winner << ", turns "
+					<< got.turns << " vs " << record.result.turns << ")\n";
+		}
+	}
+	if (status < 0)
+		report << "Log is corrupt after " << battles << " battles." << endl;
+	report << "Replayed " << battles << " battles from " << path << " (" << in.size() << " bytes): "
+		<< battles - failed << " reproduced, " << failed << " failed." << endl;
+	return status < 0 ? -1 : int(failed > 0x7FFFFFFF ? 0x7FFFFFFF : failed);
+}
+
+//appends records to a log file, writing the header if the file is new.
+int Battle_log::append_file(const string & path, const vector<uint8_t> & records)
+{
+	bool fresh = true;
+	{
+		ifstream existing(path, ios::binary);
+		fresh = !existing || existing.peek() == ifstream::traits_type::eof();
+	}
+	ofstream file(path, ios::binary | ios::app);
+	if (!file)
+		return -1;
+	if (fresh)
+	{
+		vector<uint8_t> header;
+		write_header(header);
+		file.write((const char *)header.data(), streamsize(header.size()));
+	}
+	file.write((const char *)records.data(), streamsize(records.size()));
+	return file ? 0 : -1;
+}
+
+//LEB128: 7 bits per byte, high bit set on every byte but the last.
+void Battle_log::put_varint(vector<uint8_t> & out, uint64_t value)
+{
+	while (value >= 0x80)
+	{
+		out.push_back(uint8_t(value | 0x80));
+		value >>= 7;
+	}
+	out.push_back(uint8_t(value));
+}
+
+//reads a varint, 0 if it runs past end.
+int Battle_log::get_varint(const vector<uint8_t> & in, size_t & pos, size_t end, uint64_t & value)
+{
+	value = 0;
+	for (int shift = 0; shift < 64 && pos < end; shift += 7)
+	{
+		uint8_t byte = in[pos++];
+		value |= uint64_t(byte & 0x7F) << shift;
+		if (!(byte & 0x80))
+			return 1;
+	}
+	return 0;
+}
+
+//type and species in one byte, then health and stat deltas.
+void Battle_log::put_pokemon(vector<uint8_t> & out, const Log_pokemon & pokemon)
+{
+	out.push_back(uint8_t((pokemon.type << 4) | (pokemon.species & 0x0F)));
+	put_varint(out, uint64_t(pokemon.health));
+	put_varint(out, zigzag(pokemon.attack - type_attack(pokemon.type)));
+	put_varint(out, zigzag(pokemon.special - type_special(pokemon.type)));
+	put_varint(out, zigzag(pokemon.defend - type_defend(pokemon.type)));
+}
+
+//reads what put_pokemon wrote.
+int Battle_log::get_pokemon(const vector<uint8_t> & in, size_t & pos, size_t end, Log_pokemon & pokemon)
+{
+	if (pos >= end)
+		return 0;
+	uint8_t tag = in[pos++];
+	pokemon.type = tag >> 4;
+	pokemon.species = (tag & 0x0F) == 0x0F ? -1 : tag & 0x0F;
+	uint64_t health = 0, attack = 0, special = 0, defend = 0;
+	if (!get_varint(in, pos, end, health) || !get_varint(in, pos, end, attack)
+		|| !get_varint(in, pos, end, special) || !get_varint(in, pos, end, defend))
+		return 0;
+	if (attack > uint64_t(INT32_MAX) || special > uint64_t(INT32_MAX) || defend > uint64_t(INT32_MAX))
+		return 0;	//deltas past 2^30 can't be real, and adding them to the base stats would overflow.
+	pokemon.health = int(health);
+	pokemon.attack = type_attack(pokemon.type) + int(unzigzag(attack));
+	pokemon.special = type_special(pokemon.type) + int(unzigzag(special));
+	pokemon.defend = type_defend(pokemon.type) + int(unzigzag(defend));
+	return 1;
+}
+
+//count, then one bit per action (set = SPECIAL), low bit first.
+void Battle_log::put_actions(vector<uint8_t> & out, const vector<uint8_t> & actions)
+{
+	put_varint(out, actions.size());
+	uint8_t bits = 0;
+	for (size_t i = 0; i < actions.size(); ++i)
+	{
+		if (actions[i] == SPECIAL)
+			bits |= uint8_t(1 << (i % 8));
+		if (i % 8 == 7)
+		{
+			out.push_back(bits);
+			bits = 0;
+		}
+	}
+	if (actions.size() % 8)
+		out.push_back(bits);
+}
+
+//reads what put_actions wrote.
+int Battle_log::get_actions(const vector<uint8_t> & in, size_t & pos, size_t end, vector<uint8_t> & actions)
+{
+	uint64_t count = 0;
+	if (!get_varint(in, pos, end, count) || count > uint64_t(end - pos) * 8)
+		return 0;	//compared in bits: rounding a count near 2^64 up to bytes would wrap.
+	actions.resize(size_t(count));
+	for (size_t i = 0; i < actions.size(); ++i)
+		actions[i] = (in[pos + i / 8] >> (i % 8)) & 1 ? SPECIAL : ATTACK;
+	pos += size_t((count + 7) / 8);
+	return 1;
+}
+
+//a new Pokemon of the logged type, name and health (nullptr if the stats can't be matched).
+Pokemon * Battle_log::rebuild(const Log_pokemon & pokemon)
+{
+	Pokemon * made = nullptr;
+	if (pokemon.type == FIRE)
+		made = new Fire;
+	else if (pokemon.type == WATER)
+		made = new Water;
+	else if (pokemon.type == GRASS)
+		made = new Grass;
+	else
+		return nullptr;
+
+	if (made->get_attack() != pokemon.attack || made->get_special() != pokemon.special
+		|| made->get_defend() != pokemon.defend)
+	{
+		delete made;
+		return nullptr;
+	}
+	made->set_species(pokemon.type, pokemon.species);
+	made->set_health(pokemon.health);
+	return made;
+}
@@ -0,0 +1,89 @@
+// Author: Pokemon Battle contributors
+// Date: 10-17-2026
+//
+// This file contains the class declarations for the compact binary battle log and replay.
+
+/*
+ * Binary Battle Log for Pokemon Battle Simulation
+ *
+ * Every battle can be recorded as a `Log_record`: the RNG seed and battle id, both Pokemon
+ * (type, species, health, stats), every action each side chose, and the result.
+ *
+ * On disk a log is the 5 byte header "PKBL" + version, followed by records, each prefixed with
+ * its length. Inside a record numbers are LEB128 varints, stats are zigzag deltas from the
+ * type's base stats (one byte each for a normal Pokemon), and actions are one bit each.
+ * A ten turn battle takes about 25 bytes.
+ *
+ * - `Recording_policy` wraps any policy and remembers what it chose, so recording works with
+ *   the quiet engine as well as the interactive one.
+ * - `Battle_log::play` runs a battle and fills in a record; `Battle_log::replay` rebuilds the
+ *   two Pokemon from a record, re-runs the actions through `Battle_engine` (the engine behind
+ *   `Stadium::battle`) and checks that the result is reproduced exactly.
+ */
+
+#ifndef BATTLE_LOG_H
+#define BATTLE_LOG_H
+
+#include "engine.h"
+#include <cstdint>
+#include <fstream>
+
+/* This struct is one Pokemon as it entered a battle. */
+struct Log_pokemon
+{
+	int type;	//FIRE, WATER or GRASS.
+	int species;	//which of the type's five names.
+	int health;	//health at the start.
+	int attack;	//get_attack() at the start.
+	int special;	//get_special() at the start.
+	int defend;	//get_defend() at the start.
+};
+
+/* This struct is one recorded battle. */
+struct Log_record
+{
+	uint64_t seed;			//global RNG seed.
+	uint64_t battle_id;		//battle id of the stream the battle ran under.
+	Log_pokemon first;		//the first Pokemon.
+	Log_pokemon second;		//the second Pokemon.
+	vector<uint8_t> first_actions;	//every action the first side chose.
+	vector<uint8_t> second_actions;	//every action the second side chose.
+	Battle_result result;		//what happened.
+};
+
+/* This class passes choices through from another policy and remembers them. */
+class Recording_policy: public Policy
+{
+	public:
+		Recording_policy(Policy & inner, vector<uint8_t> & actions);	//records into actions.
+		int choose(const Pokemon & self, const Pokemon & opponent, int turn);
+	private:
+		Policy & inner;			//makes the real decision.
+		vector<uint8_t> & actions;	//where the decisions go.
+};
+
+/* This class encodes, decodes, records and replays battle logs. */
+class Battle_log
+{
+	public:
+		static Log_pokemon capture(const Pokemon & pokemon);	//snapshot of a Pokemon.
+		static Battle_result play(Pokemon * first, Pokemon * second, Policy & first_policy,
+			Policy & second_policy, Log_record & record, Battle_events * events = nullptr);	//runs and records a battle.
+		static void write_header(vector<uint8_t> & out);	//"PKBL" + version.
+		static void encode(const Log_record & record, vector<uint8_t> & out);	//appends one length prefixed record.
+		static int check_header(const vector<uint8_t> & in, size_t & pos);	//1 if the header is valid.
+		static int decode(const vector<uint8_t> & in, size_t & pos, Log_record & record);	//1 on success, 0 at the end, -1 if corrupt.
+		static int replay(const Log_record & record, Battle_result & got);	//1 if the battle is reproduced.
+		static int replay_file(const string & path, ostream & report);	//replays every record, returns how many failed (-1 if unreadable).
+		static int append_file(const string & path, const vector<uint8_t> & records);	//appends encoded records, writing the header first for a new file.
+	private:
+		static void put_varint(vector<uint8_t> & out, uint64_t value);
+		static int get_varint(const vector<uint8_t> & in, size_t & pos, size_t end, uint64_t & value);
+		static void put_pokemon(vector<uint8_t> & out, const Log_pokemon & pokemon);
+		static int get_pokemon(const vector<uint8_t> & in, size_t & pos, size_t end, Log_pokemon & pokemon);
+		static void put_actions(vector<uint8_t> & out, const vector<uint8_t> & actions);
+		static int get_actions(const vector<uint8_t> & in, size_t & pos, size_t end, vector<uint8_t> & actions);
+		static Pokemon * rebuild(const Log_pokemon & pokemon);	//new Pokemon matching a snapshot.
+};
+
+#endif
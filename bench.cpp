@@ -0,0 +1,787 @@
+// Author: Pokemon Battle contributors
+// Date: 10-17-2026
+//
+// This file contains the micro benchmarks for this project (make bench).
+
+/*
+ * Each benchmark is a function registered in BENCHMARKS by name. Run them all with
+ * ./pokemon_bench, or pick some by name: ./pokemon_bench errors
+ *
+ * errors: cost of a roster lookup miss and a combat error, as the old code paid it
+ *   (throw std::string, catch in the caller) and as it is now (status code).
+ * expectimax: nodes/sec, table hit rate and time per move of the AI for a few search
+ *   depths and table sizes, over whole battles between every pair of types.
+ * mcts: rollouts/sec per core of the tree search for 1 .. cores threads and a few budgets.
+ * roster: insert, lookup and teardown of the B-tree Roster against the old BST from 10^3
+ *   to 10^7 Pokemon (the BST stops at 10^5: its duplicate chains make it quadratic).
+ * arena: heap allocations and time to build, clear and rebuild a team from 10^3 to 10^6
+ *   Pokemon made in the roster's pools, and built from heap Pokemon it has to adopt.
+ * bulk: building a team one insert at a time against make() + bulk_load, with 1 and with
+ *   every core sorting, from 10^4 to 10^7 Pokemon.
+ * snapshot: time to snapshot a roster, the first update after it (path copy and Pokemon
+ *   clone) and later updates, from 10^3 to 10^6 Pokemon.
+ * index: point lookups by (species, id) and by name, and updates, through the roster's
+ *   hash index against walking the tree (set_indexed(false)), from 10^4 to 10^6 Pokemon.
+ * stats: k-th healthiest, health range counts and listings and the strongest attacker per
+ *   type from the roster's health counts, health index and species counts, against a full
+ *   walk, and the cost a health change now pays to keep them current, from 10^4 to 10^6
+ *   Pokemon.
+ * names: completing a typed prefix and suggesting names for a typo from the roster's species
+ *   counts, against walking every Pokemon and matching its name, from 10^4 to 10^6 Pokemon.
+ * concurrent: 1 to 64 threads sharing one 10^5 Pokemon roster (80% update, 10% lookup,
+ *   5% insert, 5% remove), the lock-free Concurrent_roster against a Roster behind a mutex.
+ */
+
+#include "battle.h"
+#include "ai.h"
+#include "concurrent_roster.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+using Clock = chrono::steady_clock;
+
+//nanoseconds per operation for count operations that took from start until now.
+static double ns_per(Clock::time_point start, long long count)
+{
+	return chrono::duration<double, nano>(Clock::now() - start).count() / double(count);
+}
+
+//stops the optimizer from dropping a result.
+static volatile long long sink;
+
+//calls to operator new so far (every new in the program goes through the ones below).
+static atomic<long long> heap_allocations(0);
+
+//these stay out of line: inlined, g++ -O2 takes their malloc/free for a mismatched new/delete.
+__attribute__((noinline)) void * operator new(size_t size)
+{
+	heap_allocations.fetch_add(1, memory_order_relaxed);
+	if (void * block = malloc(size ? size : 1))
+		return block;
+	throw bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void * block) noexcept
+{
+	free(block);
+}
+
+__attribute__((noinline)) void operator delete(void * block, size_t) noexcept
+{
+	free(block);
+}
+
+
+/****** ERRORS ******/
+
+//the old lookup: throws on a miss, the caller catches.
+static Pokemon * throwing_retrieve(const BST & tree, const string & name)
+{
+	Pokemon * found = nullptr;
+	if (!tree.retrieve(name, found))
+		throw string("Pokemon not found.");
+	return found;
+}
+
+//the old combat error path: validate by throwing, report in the catch.
+static int throwing_attack(int attack_power, Battle_events & events)
+{
+	try
+	{
+		if (attack_power <= 0)
+			throw string("Invalid attack power in Water::attack()");
+		return attack_power;
+	}
+	catch (const string & e)
+	{
+		events.on_error(e.c_str());
+		return 0;
+	}
+}
+
+//the new combat error path: report and return.
+static int status_attack(int attack_power, Battle_events & events)
+{
+	if (attack_power <= 0)
+	{
+		events.on_error("Invalid attack power in Water::attack()");
+		return 0;
+	}
+	return attack_power;
+}
+
+static void bench_errors()
+{
+	const int team_size = 64;
+	const long long lookups = 200000;
+	BST tree;
+	for (int i = 0; i < team_size; ++i)
+	{
+		int type = RNG::random_num(FIRE, GRASS);
+		tree.insert(type == FIRE ? (Pokemon *)new Fire() : type == WATER ? (Pokemon *)new Water() : (Pokemon *)new Grass());
+	}
+	//half hits, half mistyped names.
+	const string names[4] = {"Charmander", "Charmandr", "Squirtle", "Squirtel"};
+	vector<Pokemon *> team;
+	tree.collect(team);
+	const string hit_names[2] = {team.front()->get_name(), team.back()->get_name()};
+	const string * pick[4] = {&hit_names[0], &names[1], &hit_names[1], &names[3]};
+
+	Clock::time_point start = Clock::now();
+	long long found = 0;
+	for (long long i = 0; i < lookups; ++i)
+	{
+		try
+		{
+			found += throwing_retrieve(tree, *pick[i & 3]) != nullptr;
+		}
+		catch (const string &)
+		{}
+	}
+	double before = ns_per(start, lookups);
+
+	start = Clock::now();
+	for (long long i = 0; i < lookups; ++i)
+	{
+		Pokemon * hit = nullptr;
+		found += tree.retrieve(*pick[i & 3], hit);
+	}
+	double after = ns_per(start, lookups);
+	sink = found;
+	cout << "lookup, 50% misses: throw " << before << " ns, status " << after << " ns ("
+	     << before / after << "x)" << endl;
+
+	Counting_events events;
+	start = Clock::now();
+	long long damage = 0;
+	for (long long i = 0; i < lookups; ++i)
+		damage += throwing_attack(int(i & 1) - 1, events);
+	before = ns_per(start, lookups);
+	start = Clock::now();
+	for (long long i = 0; i < lookups; ++i)
+		damage += status_attack(int(i & 1) - 1, events);
+	after = ns_per(start, lookups);
+	sink = damage;
+	cout << "combat error path: throw " << before << " ns, status " << after << " ns ("
+	     << before / after << "x)" << endl;
+}
+
+
+/****** EXPECTIMAX ******/
+
+static void bench_expectimax()
+{
+	const int depths[] = {8, 12, 16};
+	const int table_bits[] = {8, 12, 16, 20};
+	for (int depth : depths)
+	{
+		for (int bits : table_bits)
+		{
+			//the AI plays side 1 in every type pairing against a random opponent, 50 times.
+			Expectimax_policy ai(depth, bits);
+			int ai_wins = 0, battles = 0;
+			for (int round = 0; round < 50; ++round)
+			{
+				for (int first = FIRE; first <= GRASS; ++first)
+				{
+					for (int second = FIRE; second <= GRASS; ++second)
+					{
+						Combatant self{first, FULL_HEALTH}, opponent{second, FULL_HEALTH};
+						auto search = [&ai](const Combatant & me, const Combatant & them, int) { return ai.choose(me, them); };
+						auto random = [](const Combatant &, const Combatant &, int) { return RNG::random_num(ATTACK, SPECIAL); };
+						ai_wins += combatant_battle(self, opponent, search, random, 200).winner == 1;
+						++battles;
+					}
+				}
+			}
+			const Search_stats & stats = ai.get_stats();
+			cout << "depth " << depth << ", table 2^" << bits << ": " << (long long)stats.nodes_per_second()
+			     << " nodes/s, hit rate " << stats.hit_rate() * 100 << "%, "
+			     << stats.seconds / double(stats.decisions) * 1e6 << " us/move, won "
+			     << ai_wins << "/" << battles << endl;
+		}
+	}
+}
+
+
+/****** MCTS ******/
+
+static void bench_mcts()
+{
+	int cores = int(thread::hardware_concurrency());
+	if (cores < 1) cores = 1;
+	const int budgets[] = {100, 1000};
+	for (int threads = 1; threads <= cores; threads *= 2)
+	{
+		for (int budget : budgets)
+		{
+			//the AI plays side 1 in every type pairing against a random opponent, 5 times.
+			Mcts_policy ai(threads, budget);
+			int ai_wins = 0, battles = 0;
+			for (int round = 0; round < 5; ++round)
+			{
+				for (int first = FIRE; first <= GRASS; ++first)
+				{
+					for (int second = FIRE; second <= GRASS; ++second)
+					{
+						Combatant self{first, FULL_HEALTH}, opponent{second, FULL_HEALTH};
+						auto search = [&ai](const Combatant & me, const Combatant & them, int) { return ai.choose(me, them); };
+						auto random = [](const Combatant &, const Combatant &, int) { return RNG::random_num(ATTACK, SPECIAL); };
+						ai_wins += combatant_battle(self, opponent, search, random, 200).winner == 1;
+						++battles;
+					}
+				}
+			}
+			const Mcts_stats & stats = ai.get_stats();
+			cout << threads << " thread(s), " << budget << " us/move: " << (long long)stats.rollouts_per_second_per_core()
+			     << " rollouts/s per core, " << stats.rollouts / max(1LL, stats.decisions) << " rollouts/move, won "
+			     << ai_wins << "/" << battles << endl;
+		}
+	}
+}
+
+
+/****** ROSTER ******/
+
+//n random Pokemon.
+static void make_pokemon(long long n, vector<Pokemon *> & out)
+{
+	out.clear();
+	out.reserve(size_t(n));
+	for (long long i = 0; i < n; ++i)
+	{
+		int type = RNG::random_num(FIRE, GRASS);
+		out.push_back(type == FIRE ? (Pokemon *)new Fire() : type == WATER ? (Pokemon *)new Water() : (Pokemon *)new Grass());
+	}
+}
+
+//times insert, lookup and teardown for one tree type.
+template <typename Tree>
+static void time_tree(const char * label, long long n)
+{
+	const long long lookups = 100000;
+	const string names[4] = {"Charmander", "Lapras", "Oddish", "Missingno"};	//the last one misses.
+	vector<Pokemon *> batch;
+	make_pokemon(n, batch);
+
+	Tree * tree = new Tree();
+	Clock::time_point start = Clock::now();
+	for (Pokemon * pokemon : batch)
+		tree->insert(pokemon);
+	double insert = ns_per(start, n);
+
+	start = Clock::now();
+	long long found = 0;
+	for (long long i = 0; i < lookups; ++i)
+	{
+		Pokemon * hit = nullptr;
+		found += tree->retrieve(names[i & 3], hit);
+	}
+	double lookup = ns_per(start, lookups);
+	sink = found;
+
+	start = Clock::now();
+	delete tree;
+	double teardown = ns_per(start, n);
+	cout << label << " n=" << n << ": insert " << insert << " ns, lookup " << lookup
+	     << " ns, teardown " << teardown << " ns (per entry)" << endl;
+}
+
+static void bench_roster()
+{
+	for (long long n = 1000; n <= 10000000; n *= 10)
+	{
+		time_tree<Roster>("Roster", n);
+		if (n <= 100000)
+			time_tree<BST>("BST   ", n);
+		else
+			cout << "BST    n=" << n << ": skipped (quadratic)" << endl;
+	}
+}
+
+
+/****** ARENA ******/
+
+//builds n random Pokemon into the roster, made in place or adopted from the heap.
+static void build(Roster & roster, long long n, bool adopt)
+{
+	for (long long i = 0; i < n; ++i)
+	{
+		int type = RNG::random_num(FIRE, GRASS);
+		if (!adopt)
+			roster.create(type);
+		else
+			roster.insert(type == FIRE ? (Pokemon *)new Fire() : type == WATER ? (Pokemon *)new Water() : (Pokemon *)new Grass());
+	}
+}
+
+static void bench_arena()
+{
+	for (long long n = 1000; n <= 1000000; n *= 10)
+	{
+		for (int adopt = 0; adopt < 2; ++adopt)
+		{
+			Roster * roster = new Roster();
+			long long before = heap_allocations;
+			Clock::time_point start = Clock::now();
+			build(*roster, n, adopt);
+			double built = ns_per(start, n);
+			long long allocations = heap_allocations - before;
+
+			start = Clock::now();
+			roster->remove_all();
+			double cleared = ns_per(start, n);
+
+			before = heap_allocations;
+			start = Clock::now();
+			build(*roster, n, adopt);
+			double rebuilt = ns_per(start, n);
+			long long reallocations = heap_allocations - before;
+			sink = roster->size();
+
+			start = Clock::now();
+			delete roster;
+			double freed = ns_per(start, n);
+			cout << (adopt ? "adopt  n=" : "create n=") << n << ": build " << built << " ns (" << allocations
+			     << " allocations), remove_all " << cleared << " ns, rebuild " << rebuilt << " ns ("
+			     << reallocations << " allocations), delete " << freed << " ns (per entry)" << endl;
+		}
+	}
+}
+
+
+/****** BULK ******/
+
+//n random types, so every build makes the same team.
+static vector<int> random_types(long long n)
+{
+	vector<int> types(static_cast<size_t>(n));
+	for (int & type : types)
+		type = RNG::random_num(FIRE, GRASS);
+	return types;
+}
+
+static void bench_bulk()
+{
+	int cores = max(1, int(thread::hardware_concurrency()));
+	for (long long n = 10000; n <= 10000000; n *= 10)
+	{
+		vector<int> types = random_types(n);
+		{
+			Roster roster;
+			Clock::time_point start = Clock::now();
+			for (int type : types)
+				roster.create(type);
+			cout << "insert      n=" << n << ": " << ns_per(start, n) << " ns per entry, height " << roster.height() << endl;
+		}
+		for (int threads : {1, cores})
+		{
+			Roster roster;
+			Clock::time_point start = Clock::now();
+			vector<Pokemon *> batch;
+			batch.reserve(types.size());
+			for (int type : types)
+				batch.push_back(roster.make(type));
+			Clock::time_point made = Clock::now();
+			roster.bulk_load(batch, threads);
+			cout << "bulk_load/" << threads << " n=" << n << ": " << ns_per(start, n) << " ns per entry ("
+			     << ns_per(made, n) << " ns linking), height " << roster.height() << endl;
+			if (cores == 1)
+				break;
+		}
+	}
+}
+
+
+/****** SNAPSHOT ******/
+
+static void bench_snapshot()
+{
+	const int updates = 1000;
+	for (long long n = 1000; n <= 1000000; n *= 10)
+	{
+		Roster roster;
+		vector<Pokemon *> batch;
+		for (int type : random_types(n))
+			batch.push_back(roster.make(type));
+		roster.bulk_load(batch);
+		vector<pair<int, uint32_t>> keys;
+		for (int i = 0; i < updates; ++i)
+		{
+			Pokemon * pokemon = batch[size_t(RNG::random_num(0, int(n - 1)))];
+			keys.push_back({pokemon->get_species_id(), pokemon->get_id()});
+		}
+
+		double snapshot = 0, first = 0, later = 0;
+		for (int i = 0; i < updates; ++i)
+		{
+			Clock::time_point start = Clock::now();
+			Roster checkpoint = roster.snapshot();
+			snapshot += ns_per(start, updates);
+
+			Pokemon * found = nullptr;
+			start = Clock::now();
+			roster.retrieve_for_update(keys[size_t(i)].first, keys[size_t(i)].second, found);
+			found->reduce_health(1);
+			first += ns_per(start, updates);
+
+			start = Clock::now();
+			roster.retrieve_for_update(keys[size_t(i)].first, keys[size_t(i)].second, found);
+			found->reduce_health(1);
+			later += ns_per(start, updates);
+		}
+		cout << "n=" << n << ": snapshot " << snapshot << " ns, first update " << first
+		     << " ns, next update " << later << " ns, height " << roster.height() << endl;
+	}
+}
+
+
+/****** INDEX ******/
+
+//random lookups by key and by name, and updates, with the roster's index on or off.
+static void time_lookups(Roster & roster, const vector<pair<int, uint32_t>> & keys)
+{
+	const int lookups = 1000000;
+	const string names[4] = {"Charmander", "Lapras", "Oddish", "Missingno"};	//the last one misses.
+	long long found = 0;
+	Pokemon * hit = nullptr;
+	Clock::time_point start = Clock::now();
+	for (int i = 0; i < lookups; ++i)
+		found += roster.retrieve(keys[size_t(i) % keys.size()].first, keys[size_t(i) % keys.size()].second, hit);
+	double by_key = ns_per(start, lookups);
+
+	start = Clock::now();
+	for (int i = 0; i < lookups; ++i)
+		found += roster.retrieve(names[i & 3], hit);
+	double by_name = ns_per(start, lookups);
+
+	start = Clock::now();
+	for (int i = 0; i < lookups; ++i)
+		if (roster.retrieve_for_update(keys[size_t(i) % keys.size()].first, keys[size_t(i) % keys.size()].second, hit))
+			hit->reduce_health(0);
+	double update = ns_per(start, lookups);
+	sink = found;
+	cout << (roster.is_indexed() ? "  hash index" : "  tree walk ") << ": by key " << by_key << " ns, by name "
+	     << by_name << " ns, for update " << update << " ns" << endl;
+}
+
+static void bench_index()
+{
+	for (long long n = 10000; n <= 1000000; n *= 10)
+	{
+		Roster roster;
+		vector<Pokemon *> batch;
+		for (int type : random_types(n))
+			batch.push_back(roster.make(type));
+		Clock::time_point start = Clock::now();
+		roster.bulk_load(batch);
+		double loaded = ns_per(start, n);
+
+		vector<pair<int, uint32_t>> keys;
+		for (Pokemon * pokemon : batch)
+			keys.push_back({pokemon->get_species_id(), pokemon->get_id()});
+		shuffle(keys.begin(), keys.end(), mt19937(1));	//no walking the tree in order.
+		cout << "n=" << n << " (bulk_load " << loaded << " ns per entry with the index):" << endl;
+		time_lookups(roster, keys);
+		roster.set_indexed(false);
+		time_lookups(roster, keys);
+	}
+}
+
+
+/****** STATS ******/
+
+static void bench_stats()
+{
+	const int queries = 1000;
+	for (long long n = 10000; n <= 1000000; n *= 10)
+	{
+		Roster roster;
+		vector<Pokemon *> batch;
+		for (int type : random_types(n))
+		{
+			batch.push_back(roster.make(type));
+			batch.back()->set_health(RNG::random_num(0, FULL_HEALTH));
+		}
+		roster.bulk_load(batch);
+		vector<Pokemon *> out;
+
+		Clock::time_point start = Clock::now();
+		long long found = 0;
+		for (int i = 0; i < queries; ++i)
+			found += roster.kth_healthiest(RNG::random_num(1, int(n)))->get_health();
+		double kth = ns_per(start, queries);
+		start = Clock::now();
+		for (int i = 0; i < queries; ++i)
+		{
+			//the walk has to sort to know the k-th; a partial sort is the cheapest way.
+			vector<int> healths;
+			healths.reserve(size_t(n));
+			for (Pokemon * pokemon : roster)
+				healths.push_back(pokemon->get_health());
+			size_t k = size_t(RNG::random_num(1, int(n))) - 1;
+			nth_element(healths.begin(), healths.begin() + k, healths.end(), greater<int>());
+			found += healths[k];
+			if (i == 9)
+				break;	//ten are plenty to time.
+		}
+		double kth_walk = ns_per(start, 10);
+
+		start = Clock::now();
+		for (int i = 0; i < queries; ++i)
+			found += roster.count_health(20, 50);
+		double count = ns_per(start, queries);
+		start = Clock::now();
+		for (Pokemon * pokemon : roster)
+			found += pokemon->get_health() >= 20 && pokemon->get_health() <= 50;
+		double count_walk = ns_per(start, 1);
+
+		start = Clock::now();
+		out.clear();
+		found += roster.retrieve_health_range(20, 22, out);
+		double narrow = ns_per(start, 1);
+		start = Clock::now();
+		out.clear();
+		found += roster.retrieve_health_range(20, 50, out);
+		double range = ns_per(start, 1);
+		start = Clock::now();
+		out.clear();
+		for (Pokemon * pokemon : roster)
+			if (pokemon->get_health() >= 20 && pokemon->get_health() <= 50)
+				out.push_back(pokemon);
+		double range_walk = ns_per(start, 1);
+
+		start = Clock::now();
+		for (int i = 0; i < queries; ++i)
+			for (int type = FIRE; type <= GRASS; ++type)
+				found += roster.strongest_attacker(type)->get_attack();
+		double strongest = ns_per(start, queries);
+
+		start = Clock::now();
+		for (int i = 0; i < queries; ++i)
+		{
+			Pokemon * pokemon = batch[size_t(RNG::random_num(0, int(n - 1)))];
+			pokemon->set_health(RNG::random_num(0, FULL_HEALTH));
+		}
+		double change = ns_per(start, queries);
+		sink = found;
+
+		cout << "n=" << n << ": k-th healthiest " << kth << " ns (walk " << kth_walk / 1000 << " us), count 20-50 "
+		     << count << " ns (walk " << count_walk / 1000 << " us), list 20-22 " << narrow / 1000 << " us, list 20-50 "
+		     << range / 1000 << " us (walk " << range_walk / 1000 << " us), strongest per type " << strongest
+		     << " ns, health change " << change << " ns" << endl;
+	}
+}
+
+
+/****** NAMES ******/
+
+static void bench_names()
+{
+	const int queries = 1000;
+	const string prefixes[4] = {"Ch", "t", "LAP", "Zz"};	//two matches, three, one, none.
+	const string typos[4] = {"Charmandr", "Totodle", "Lapars", "Missingno"};	//the last one is too far.
+	for (long long n = 10000; n <= 1000000; n *= 10)
+	{
+		Roster roster;
+		vector<Pokemon *> batch;
+		for (int type : random_types(n))
+			batch.push_back(roster.make(type));
+		roster.bulk_load(batch);
+		vector<int> out;
+		long long found = 0;
+
+		Clock::time_point start = Clock::now();
+		for (int i = 0; i < queries; ++i)
+		{
+			out.clear();
+			found += roster.complete(prefixes[i % 4], out);
+		}
+		double complete = ns_per(start, queries);
+		start = Clock::now();
+		for (int i = 0; i < 4; ++i)
+		{
+			//what send_to_battle would have to do without the counts: look at every name.
+			bool seen[SPECIES_COUNT] = {};
+			for (Pokemon * pokemon : roster)
+			{
+				const string & name = pokemon->get_name();
+				size_t at = 0;
+				while (at < prefixes[i].size() && at < name.size() && tolower(name[at]) == tolower(prefixes[i][at]))
+					++at;
+				if (at == prefixes[i].size())
+					seen[pokemon->get_species_id()] = true;
+			}
+			found += count(seen, seen + SPECIES_COUNT, true);
+		}
+		double complete_walk = ns_per(start, 4);
+
+		start = Clock::now();
+		for (int i = 0; i < queries; ++i)
+		{
+			out.clear();
+			found += roster.suggest(typos[i % 4], NAME_SUGGESTION_EDITS, out);
+		}
+		double suggest = ns_per(start, queries);
+		start = Clock::now();
+		for (int i = 0; i < 4; ++i)
+		{
+			bool seen[SPECIES_COUNT] = {};
+			for (Pokemon * pokemon : roster)
+				if (Pokemon::name_distance(typos[i], pokemon->get_species_id(), NAME_SUGGESTION_EDITS) <= NAME_SUGGESTION_EDITS)
+					seen[pokemon->get_species_id()] = true;
+			found += count(seen, seen + SPECIES_COUNT, true);
+		}
+		double suggest_walk = ns_per(start, 4);
+		sink = found;
+
+		cout << "n=" << n << ": complete " << complete << " ns (walk " << complete_walk / 1000 << " us), suggest "
+		     << suggest << " ns (walk " << suggest_walk / 1000 << " us)" << endl;
+	}
+}
+
+
+/****** CONCURRENT ******/
+
+const int CONTENDED_SIZE = 100000;		//Pokemon in the shared roster.
+const long long CONTENDED_OPS = 2000000;	//operations per run, split between the threads.
+
+//the operation mix, the same for both rosters: 0-79 update, 80-89 lookup, 90-94 insert, 95-99 remove.
+template <typename Shared>
+static double contend(Shared & shared, const vector<pair<int, uint32_t>> & keys, int threads)
+{
+	vector<thread> workers;
+	Clock::time_point start = Clock::now();
+	for (int t = 0; t < threads; ++t)
+		workers.emplace_back([&shared, &keys, threads, t]()
+		{
+			uint64_t state = RNG::mix(uint64_t(t) + 1) | 1;
+			for (long long i = 0; i < CONTENDED_OPS / threads; ++i)
+			{
+				state ^= state << 13;
+				state ^= state >> 7;
+				state ^= state << 17;
+				const pair<int, uint32_t> & key = keys[size_t((state >> 8) % keys.size())];
+				int op = int(state % 100);
+				if (op < 80)
+					shared.update(key);
+				else if (op < 90)
+					shared.lookup(key);
+				else if (op < 95)
+					shared.insert();
+				else
+					shared.remove(key);
+			}
+		});
+	for (thread & worker : workers)
+		worker.join();
+	return ns_per(start, CONTENDED_OPS / threads * threads);
+}
+
+/* The lock-free roster. */
+struct Lock_free_side
+{
+	Concurrent_roster roster;
+	void update(const pair<int, uint32_t> & key) { roster.update(key.first, key.second, [](Pokemon & pokemon) { pokemon.reduce_health(1); }); }
+	void lookup(const pair<int, uint32_t> & key) { sink = roster.contains(key.first, key.second); }
+	void insert() { roster.insert(new Water()); }
+	void remove(const pair<int, uint32_t> & key) { roster.remove(key.first, key.second); }
+};
+
+/* A Roster behind one mutex. */
+struct Mutex_side
+{
+	Roster roster;
+	mutex lock;
+	void update(const pair<int, uint32_t> & key)
+	{
+		lock_guard<mutex> hold(lock);
+		Pokemon * found = nullptr;
+		if (roster.retrieve_for_update(key.first, key.second, found))
+			found->reduce_health(1);
+	}
+	void lookup(const pair<int, uint32_t> & key)
+	{
+		lock_guard<mutex> hold(lock);
+		Pokemon * found = nullptr;
+		sink = roster.retrieve(key.first, key.second, found);
+	}
+	void insert()
+	{
+		Water made;	//constructed outside the lock, as the lock-free side does.
+		lock_guard<mutex> hold(lock);
+		roster.insert(new Water(made));
+	}
+	void remove(const pair<int, uint32_t> & key)
+	{
+		lock_guard<mutex> hold(lock);
+		roster.remove_specific(key.first, key.second);
+	}
+};
+
+static void bench_concurrent()
+{
+	for (int threads = 1; threads <= 64; threads *= 2)
+	{
+		Lock_free_side lock_free;
+		Mutex_side locked;
+		vector<pair<int, uint32_t>> keys;
+		for (int i = 0; i < CONTENDED_SIZE; ++i)
+		{
+			Pokemon * pokemon = RNG::random_num(0, 1) ? (Pokemon *)new Fire() : (Pokemon *)new Grass();
+			keys.push_back({pokemon->get_species_id(), pokemon->get_id()});
+			locked.roster.insert(clone_pokemon(pokemon));
+			lock_free.roster.insert(pokemon);
+		}
+		double lock_free_ns = contend(lock_free, keys, threads);
+		double locked_ns = contend(locked, keys, threads);
+		cout << threads << " thread(s): lock-free " << 1000.0 / lock_free_ns << " Mops/s, mutex "
+		     << 1000.0 / locked_ns << " Mops/s (" << lock_free.roster.pending() << " nodes waiting for reclamation, "
+		     << lock_free.roster.reclaim() << " after reclaim)" << endl;
+	}
+}
+
+
+/****** DRIVER ******/
+
+struct Benchmark
+{
+	const char * name;
+	void (*run)();
+};
+
+static const Benchmark BENCHMARKS[] = {
+	{"errors", bench_errors},
+	{"expectimax", bench_expectimax},
+	{"mcts", bench_mcts},
+	{"roster", bench_roster},
+	{"arena", bench_arena},
+	{"bulk", bench_bulk},
+	{"snapshot", bench_snapshot},
+	{"index", bench_index},
+	{"stats", bench_stats},
+	{"names", bench_names},
+	{"concurrent", bench_concurrent},
+};
+
+int main(int argc, char *argv[])
+{
+	RNG::set_seed(1);
+	for (const Benchmark & benchmark : BENCHMARKS)
+	{
+		bool wanted = argc < 2;
+		for (int i = 1; i < argc; ++i)
+			wanted = wanted || strcmp(argv[i], benchmark.name) == 0;
+		if (!wanted)
+			continue;
+		cout << "--- " << benchmark.name << " ---" << endl;
+		benchmark.run();
+	}
+	return 0;
+}
@@ -0,0 +1,1825 @@
+// Author: Pokemon Battle contributors
+// Date: 10-18-2026
+//
+// This file contains the randomized correctness checks for this project (make check).
+
+/*
+ * Each check is a function registered in CHECKS by name. make check builds ./pokemon_check and
+ * runs them all; pick some by name: ./pokemon_check roster concurrent. Every mismatch is
+ * printed (the first few of each check) and the run exits with 1 if there was any. Built with
+ * a sanitizer (make -B check CHECK_FLAGS="-O1 -fsanitize=address,undefined", or
+ * -fsanitize=thread) it is a stress test too.
+ *
+ * rng: Philox against its published test vectors; streams regenerated in another order and
+ *   on other threads draw the same numbers; a bound stream feeds RNG::random_num and
+ *   Pokemon::random_num; a seed repeats the per thread engines.
+ * tournament: two stadiums on 1, 3 and 8 workers against every battle replayed in order on
+ *   its own stream: the same tallies, battle for battle.
+ * batch: a thousand battles (some with a side already down) on every SIMD kernel the CPU
+ *   has, against the scalar kernel, which is checked against Battle_engine.
+ * matchup: DAMAGE and OUTCOME against Battle_engine on the combat methods; Matchup::resolve
+ *   against Battle_engine on fresh and on hurt Pokemon; bad type and action codes give -1.
+ * combatant: conversions and stats against the Pokemon classes; combatant_battle against
+ *   Battle_engine with the same position based choices, turn limits included.
+ * events: random battles give the same results with no sink, the null, counting and text
+ *   sinks; events come in battle order and their damage adds up; text is the same with a one
+ *   byte and a 1 MB buffer, and nothing is written before the flush.
+ * roster: random inserts, creates, bulk loads, removes (by key and by name), updates, health
+ *   changes, snapshots, assignments and clears on up to six rosters sharing stores, each
+ *   against a model multimap of (key, health). Every few steps each roster is compared with
+ *   its model: order both ways, lookups, select and rank, species counts, health counts,
+ *   health range listings and the k-th healthiest.
+ * snapshots: a snapshot keeps what it saw while the roster it came from changes; taking,
+ *   updating and dropping snapshots in a loop doesn't grow the pools; copies of one roster
+ *   change on two threads at once and each ends up with exactly its own changes.
+ * bst: random inserts and removes on the BST against a multiset of names, with copies and
+ *   assignments compared too, and const walks from several threads at once.
+ * concurrent: 8 threads insert, remove and update a Concurrent_roster. Each thread owns the
+ *   keys it inserts, so the final contents are known exactly, and every update adds one to
+ *   a health, so no update is lost either. Then 200 threads go inside at once (more than
+ *   there are epoch slots). Then 8 threads insert and remove copies of the same 16 Pokemon,
+ *   so inserts race removes of their own nodes; each key ends up there exactly if its
+ *   inserts outnumber its removes. After reclaim() no removed node may still be waiting.
+ * win_matrix: every type pair at a few healths against 20000 random battles played by
+ *   combatant_battle, and a computed matrix against win_probability cell by cell, on one
+ *   and on several threads.
+ * battle_log: random battles recorded, encoded, decoded and replayed; every cut of a record
+ *   and thousands of corrupted ones decode to an error or a record, never an exception; an
+ *   action count near 2^64 is rejected.
+ * server: every request and every error status over a Unix socket, a battle played to the
+ *   end and its score; a client that pipelines 200000 requests without reading is paused
+ *   while another client is still served, then gets every response once it reads.
+ * expectimax: action values on a fresh table against a plain expectimax without one, and the
+ *   choice against its best action; choices are always Attack or Special, take a knockout
+ *   when there is one and repeat for the same state on warm and tiny tables; the Pokemon
+ *   and Combatant forms agree.
+ * mcts: on 1 and 3 threads, with a full and a tiny node pool and a zero budget, every choice
+ *   is Attack or Special; where one action knocks the opponent out and the other is clearly
+ *   worse, every thread count takes the knockout; the statistics add up and bad types attack.
+ * completion: species ids are in case-folded name order (complete() relies on it);
+ *   name_distance against a full Levenshtein table; complete() and suggest() on random
+ *   rosters against a scan of every species, with typed prefixes, typos and noise.
+ */
+
+#include "ai.h"
+#include "battle.h"
+#include "battle_log.h"
+#include "batch.h"
+#include "combatant.h"
+#include "concurrent_roster.h"
+#include "net_client.h"
+#include "tournament.h"
+#include "win_matrix.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <set>
+#include <sstream>
+#include <thread>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+typedef multimap<uint64_t, int> Roster_model;	//key -> health, equal keys in insertion order.
+
+static atomic<int> mismatches(0);	//in the check running now (threads may report too).
+
+//counts a mismatch and prints the first few.
+static void expect(bool ok, const string & what)
+{
+	if (ok)
+		return;
+	if (++mismatches <= 10)
+		cout << "  mismatch: " << what << endl;
+}
+
+//a heap Pokemon of the type.
+static Pokemon * new_pokemon(int type)
+{
+	if (type == FIRE)
+		return new Fire();
+	if (type == WATER)
+		return new Water();
+	return new Grass();
+}
+
+//a policy that always picks the action.
+static Callback_policy fixed_policy(int action)
+{
+	return Callback_policy([action](const Pokemon &, const Pokemon &, int) { return action; });
+}
+
+
+/****** RNG ******/
+
+//Philox known answers, streams regenerated out of order and on other threads, scopes, and
+//seeded per thread engines.
+static void check_rng()
+{
+	const uint32_t answers[3][10] = {	//counter, key, block (the Random123 test vectors).
+		{0, 0, 0, 0, 0, 0, 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8},
+		{~0u, ~0u, ~0u, ~0u, ~0u, ~0u, 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd},
+		{0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344, 0xa4093822, 0x299f31d0, 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1},
+	};
+	for (const uint32_t * answer : answers)
+	{
+		uint32_t out[4];
+		Philox::block(answer, answer + 4, out);
+		expect(equal(out, out + 4, answer + 6), "Philox4x32-10 known answer");
+	}
+
+	const int battles = 64, turns = 8, draws = 12;
+	auto draw_turn = [](uint64_t battle, uint32_t turn, vector<int> & out) {
+		Stream stream(77, battle, turn);
+		for (int i = 0; i < draws; ++i)
+			out.push_back(stream.random_num(1, 1000));
+	};
+	vector<vector<int>> in_order(battles);
+	for (int battle = 0; battle < battles; ++battle)
+	{
+		Stream stream(77, uint64_t(battle));
+		for (uint32_t turn = 0; turn < turns; ++turn)
+		{
+			stream.set_turn(turn);
+			for (int i = 0; i < draws; ++i)
+				in_order[size_t(battle)].push_back(stream.random_num(1, 1000));
+		}
+	}
+	vector<vector<int>> backwards(battles);
+	for (int battle = battles - 1; battle >= 0; --battle)
+		for (uint32_t turn = 0; turn < turns; ++turn)
+			draw_turn(uint64_t(battle), turn, backwards[size_t(battle)]);
+	expect(backwards == in_order, "streams regenerated in another order");
+	vector<vector<int>> threaded(battles);
+	vector<thread> workers;
+	for (int t = 0; t < 4; ++t)
+		workers.emplace_back([&, t] {
+			for (int battle = t; battle < battles; battle += 4)
+				for (uint32_t turn = 0; turn < turns; ++turn)
+					draw_turn(uint64_t(battle), turn, threaded[size_t(battle)]);
+		});
+	for (thread & worker : workers)
+		worker.join();
+	expect(threaded == in_order, "streams regenerated on four threads");
+	expect(in_order[0] != in_order[1], "two battles drew the same numbers");
+
+	vector<long long> buckets(6, 0);
+	Stream wide(3, 9);
+	for (int i = 0; i < 60000; ++i)
+	{
+		int value = wide.random_num(-2, 3);
+		expect(value >= -2 && value <= 3, "stream number out of range");
+		if (value >= -2 && value <= 3)
+			++buckets[size_t(value + 2)];
+	}
+	for (long long bucket : buckets)
+		expect(fabs(bucket - 10000.0) < 500, "stream numbers uneven: " + to_string(bucket) + " of 60000 in a bucket of 6");
+
+	Stream bound(5, 6);
+	Stream same(5, 6);
+	Fire pokemon;
+	{
+		Stream_scope scope(bound);
+		expect(RNG::current_stream() == &bound, "scope binds its stream");
+		{
+			Stream inner(8, 8);
+			Stream_scope nested(inner);
+			expect(RNG::current_stream() == &inner, "nested scope binds its stream");
+		}
+		expect(RNG::current_stream() == &bound, "nested scope restores the outer stream");
+		bool follows = true;
+		for (int i = 0; i < 50; ++i)
+			follows = follows && RNG::random_num(1, 100) == same.random_num(1, 100)
+				&& pokemon.random_num(0, 9) == same.random_num(0, 9);
+		expect(follows, "RNG::random_num and Pokemon::random_num draw from the bound stream");
+	}
+	expect(RNG::current_stream() == nullptr, "scope unbinds on the way out");
+
+	vector<int> first, again, other;
+	RNG::set_seed(42);
+	for (int i = 0; i < 100; ++i)
+		first.push_back(RNG::random_num(0, 1 << 20));
+	RNG::set_seed(42);
+	for (int i = 0; i < 100; ++i)
+		again.push_back(RNG::random_num(0, 1 << 20));
+	RNG::set_seed(43);
+	for (int i = 0; i < 100; ++i)
+		other.push_back(RNG::random_num(0, 1 << 20));
+	expect(first == again, "the same seed gave different numbers");
+	expect(first != other, "two seeds gave the same numbers");
+}
+
+
+/****** TOURNAMENT ******/
+
+//a quiet trainer with a random team, some of it hurt.
+static void make_trainer(Trainer & trainer, string name, int size)
+{
+	trainer.set_quiet(true);
+	trainer.set_name(name);
+	trainer.build_team(size);
+	vector<Pokemon *> team;
+	trainer.get_team(team);
+	for (size_t i = 0; i < team.size(); i += 3)
+		trainer.get_pokemon_for_update(team[i]->get_species_id(), team[i]->get_id())->set_health(RNG::random_num(1, FULL_HEALTH));
+}
+
+//the tallies one battle at a time on this thread, each on its own stream.
+static Tally replayed_tally(const Trainer & first, const Trainer & second, uint64_t seed, long long offset)
+{
+	Tally tally{0, 0, 0, 0, 0};
+	vector<Pokemon *> firsts, seconds;
+	first.get_team(firsts);
+	second.get_team(seconds);
+	Random_policy random_policy;
+	for (size_t i = 0; i < firsts.size(); ++i)
+		for (size_t j = 0; j < seconds.size(); ++j)
+		{
+			Stream stream(seed, uint64_t(offset + (long long)(i * seconds.size() + j)));
+			Stream_scope scope(stream);
+			unique_ptr<Pokemon> a(clone_pokemon(firsts[i]));
+			unique_ptr<Pokemon> b(clone_pokemon(seconds[j]));
+			Battle_engine engine(a.get(), b.get());
+			Battle_result result = engine.run(random_policy, random_policy);
+			tally.trainer1_wins += result.winner == 1;
+			tally.trainer2_wins += result.winner == 2;
+			tally.draws += result.winner != 1 && result.winner != 2;
+			++tally.battles;
+			tally.turns += result.turns;
+		}
+	return tally;
+}
+
+//true if every count matches.
+static bool same_tally(const Tally & a, const Tally & b)
+{
+	return a.trainer1_wins == b.trainer1_wins && a.trainer2_wins == b.trainer2_wins && a.draws == b.draws
+		&& a.battles == b.battles && a.turns == b.turns;
+}
+
+//two stadiums on 1, 3 and 8 workers give the same tallies as playing every battle in order.
+static void check_tournament()
+{
+	Trainer ash, misty, brock;
+	make_trainer(ash, "Ash", 60);
+	make_trainer(misty, "Misty", 45);
+	make_trainer(brock, "Brock", 30);
+	vector<Tally> expected = {replayed_tally(ash, misty, 1, 0), replayed_tally(brock, ash, 1, 60 * 45)};
+	for (int threads : {1, 3, 8})
+	{
+		Tournament tournament(threads);
+		tournament.add_trainers(ash, misty);
+		tournament.add_trainers(brock, ash);
+		expect(tournament.matchups() == 60 * 45 + 30 * 60, "matchups queued");
+		Tournament_result result = tournament.run();
+		string where = to_string(threads) + " threads: ";
+		expect(result.seed == 1 && result.threads == threads, where + "seed and threads reported");
+		expect(result.stadiums.size() == 2, where + "one tally per stadium");
+		for (size_t s = 0; s < result.stadiums.size() && s < expected.size(); ++s)
+			expect(same_tally(result.stadiums[s], expected[s]), where + "stadium " + to_string(s + 1) + " tally");
+		Tally total = expected[0];
+		total.merge(expected[1]);
+		expect(same_tally(result.total, total), where + "total tally");
+	}
+}
+
+
+/****** BATCH ******/
+
+/* This struct is one batched battle's outcome. */
+struct Batch_outcome
+{
+	int winner, turns, first_health, second_health;
+	bool operator==(const Batch_outcome & other) const
+	{
+		return winner == other.winner && turns == other.turns && first_health == other.first_health
+			&& second_health == other.second_health;
+	}
+};
+
+//runs the battles on the kernel, changing some actions after a few turns when asked to.
+static vector<Batch_outcome> run_batch(const vector<pair<Pokemon *, Pokemon *>> & battles, const vector<pair<int, int>> & actions,
+	bool switch_actions)
+{
+	Battle_batch batch;
+	for (size_t i = 0; i < battles.size(); ++i)
+		batch.add(*battles[i].first, *battles[i].second, actions[i].first, actions[i].second);
+	if (switch_actions)
+	{
+		for (int turn = 0; turn < 3; ++turn)
+			batch.step();
+		for (int i = 0; i < batch.size(); i += 2)
+			batch.set_actions(i, actions[size_t(i)].second, actions[size_t(i)].first);
+	}
+	batch.run();
+	vector<Batch_outcome> out;
+	for (int i = 0; i < batch.size(); ++i)
+		out.push_back(Batch_outcome{batch.get_winner(i), batch.get_turns(i), batch.get_health(i, 1), batch.get_health(i, 2)});
+	return out;
+}
+
+//every kernel this CPU has against the scalar one, and the scalar one against Battle_engine.
+static void check_batch()
+{
+	const char * started = Battle_batch::kernel_name();
+	vector<pair<Pokemon *, Pokemon *>> battles;
+	vector<pair<int, int>> actions;
+	for (int i = 0; i < 1003; ++i)	//not a multiple of the lanes, so the padding is used too.
+	{
+		battles.push_back({new_pokemon(RNG::random_num(FIRE, GRASS)), new_pokemon(RNG::random_num(FIRE, GRASS))});
+		battles.back().first->set_health(RNG::random_num(-3, FULL_HEALTH));
+		battles.back().second->set_health(RNG::random_num(i % 7 == 0 ? -3 : 1, FULL_HEALTH));
+		actions.push_back({RNG::random_num(ATTACK, SPECIAL), RNG::random_num(ATTACK, SPECIAL)});
+	}
+
+	expect(Battle_batch::use_kernel("scalar") == 1, "the scalar kernel is always there");
+	vector<Batch_outcome> scalar = run_batch(battles, actions, false);
+	vector<Batch_outcome> scalar_switched = run_batch(battles, actions, true);
+	for (size_t i = 0; i < battles.size(); ++i)
+	{
+		unique_ptr<Pokemon> first(clone_pokemon(battles[i].first));
+		unique_ptr<Pokemon> second(clone_pokemon(battles[i].second));
+		Callback_policy first_policy = fixed_policy(actions[i].first);
+		Callback_policy second_policy = fixed_policy(actions[i].second);
+		Battle_engine engine(first.get(), second.get());
+		Battle_result result = engine.run(first_policy, second_policy);
+		Batch_outcome expected{result.winner, result.turns, first->get_health(), second->get_health()};
+		if (result.winner == 0)
+			expected.turns = scalar[i].turns;	//a stalled lane keeps counting turns while the others run.
+		expect(scalar[i] == expected, "battle " + to_string(i) + ": scalar kernel against Battle_engine");
+	}
+	for (const char * name : {"sse4.1", "avx2"})
+	{
+		if (!Battle_batch::use_kernel(name))
+			continue;
+		expect(run_batch(battles, actions, false) == scalar, string(name) + " kernel against the scalar one");
+		expect(run_batch(battles, actions, true) == scalar_switched, string(name) + " kernel against the scalar one, actions changed");
+	}
+	Battle_batch::use_kernel(started);
+	expect(string(Battle_batch::kernel_name()) == started, "back on the kernel picked at start");
+	for (pair<Pokemon *, Pokemon *> & battle : battles)
+	{
+		delete battle.first;
+		delete battle.second;
+	}
+}
+
+
+/****** MATCHUP ******/
+
+//true if both results are the same.
+static bool same_result(const Battle_result & a, const Battle_result & b)
+{
+	return a.winner == b.winner && a.turns == b.turns && a.damage_to_first == b.damage_to_first
+		&& a.damage_to_second == b.damage_to_second;
+}
+
+//DAMAGE and OUTCOME against Battle_engine on the combat methods, Matchup::resolve on fresh and
+//hurt Pokemon, and bad codes.
+static void check_matchup()
+{
+	Null_events quiet;
+	for (int first = FIRE; first <= GRASS; ++first)
+		for (int second = FIRE; second <= GRASS; ++second)
+			for (int first_action = ATTACK; first_action <= SPECIAL; ++first_action)
+			{
+				string pair = "types " + to_string(first) + " and " + to_string(second) + ", action " + to_string(first_action);
+				unique_ptr<Pokemon> attacker(new_pokemon(first));
+				unique_ptr<Pokemon> defender(new_pokemon(second));
+				Battle_engine one_strike(attacker.get(), defender.get(), &quiet);
+				one_strike.act(first_action);
+				expect(one_strike.get_result().damage_to_second == DAMAGE[first - 1][first_action - 1][second - 1], pair + ": DAMAGE");
+
+				for (int second_action = ATTACK; second_action <= SPECIAL; ++second_action)
+				{
+					const Battle_result & table = OUTCOME[first - 1][first_action - 1][second - 1][second_action - 1];
+					unique_ptr<Pokemon> a(new_pokemon(first));
+					unique_ptr<Pokemon> b(new_pokemon(second));
+					Callback_policy first_policy = fixed_policy(first_action);
+					Callback_policy second_policy = fixed_policy(second_action);
+					Battle_engine engine(a.get(), b.get(), &quiet);
+					expect(same_result(engine.run(first_policy, second_policy), table), pair + ": OUTCOME");
+					unique_ptr<Pokemon> c(new_pokemon(first));
+					unique_ptr<Pokemon> d(new_pokemon(second));
+					expect(same_result(Matchup::resolve(c.get(), d.get(), first_action, second_action), table)
+						&& c->get_health() == a->get_health() && d->get_health() == b->get_health(), pair + ": resolve on fresh Pokemon");
+				}
+			}
+
+	for (int i = 0; i < 2000; ++i)
+	{
+		int first_action = RNG::random_num(ATTACK, SPECIAL);
+		int second_action = RNG::random_num(ATTACK, SPECIAL);
+		unique_ptr<Pokemon> a(new_pokemon(RNG::random_num(FIRE, GRASS)));
+		unique_ptr<Pokemon> b(new_pokemon(RNG::random_num(FIRE, GRASS)));
+		a->set_health(RNG::random_num(0, 2) ? RNG::random_num(0, FULL_HEALTH) : FULL_HEALTH);
+		b->set_health(RNG::random_num(0, 2) ? RNG::random_num(0, FULL_HEALTH) : FULL_HEALTH);
+		unique_ptr<Pokemon> c(clone_pokemon(a.get()));
+		unique_ptr<Pokemon> d(clone_pokemon(b.get()));
+		Callback_policy first_policy = fixed_policy(first_action);
+		Callback_policy second_policy = fixed_policy(second_action);
+		Battle_engine engine(a.get(), b.get());
+		Battle_result played = engine.run(first_policy, second_policy);
+		expect(same_result(Matchup::resolve(c.get(), d.get(), first_action, second_action), played)
+			&& c->get_health() == a->get_health() && d->get_health() == b->get_health(), "resolve on hurt Pokemon, case " + to_string(i));
+	}
+
+	const int bad_types[][2] = {{0, FIRE}, {GRASS + 1, WATER}, {FIRE, -1}, {WATER, 4}};
+	for (const int * types : bad_types)
+	{
+		Combatant a{types[0], FULL_HEALTH};
+		Combatant b{types[1], FULL_HEALTH};
+		expect(combatant_battle(a, b, ATTACK, ATTACK).winner == -1, "combatant_battle with type " + to_string(types[0]) + " and " + to_string(types[1]));
+	}
+	const int bad_actions[][2] = {{0, ATTACK}, {SPECIAL + 1, ATTACK}, {ATTACK, -7}, {SPECIAL, 3}};
+	for (const int * actions : bad_actions)
+	{
+		Combatant a{FIRE, FULL_HEALTH};
+		Combatant b{GRASS, FULL_HEALTH};
+		string which = to_string(actions[0]) + " and " + to_string(actions[1]);
+		expect(combatant_battle(a, b, actions[0], actions[1]).winner == -1, "combatant_battle with actions " + which);
+		Fire fire;
+		Grass grass;
+		expect(Matchup::resolve(&fire, &grass, actions[0], actions[1]).winner == -1, "resolve with actions " + which);
+	}
+}
+
+
+/****** COMBATANT ******/
+
+//an action that depends only on the position, so Pokemon and Combatant can both ask it.
+static int position_action(int self_type, int self_health, int opponent_health)
+{
+	return (self_health * 7 + opponent_health * 3 + self_type) % 5 < 2 ? SPECIAL : ATTACK;
+}
+
+//conversions and stats against the Pokemon classes, and combatant_battle against Battle_engine.
+static void check_combatant()
+{
+	vector<Pokemon *> roster;
+	for (int i = 0; i < 30; ++i)
+	{
+		roster.push_back(new_pokemon(RNG::random_num(FIRE, GRASS)));
+		roster.back()->set_health(RNG::random_num(0, FULL_HEALTH));
+	}
+	roster.insert(roster.begin() + 7, nullptr);
+	vector<Combatant> values = to_combatants(roster);
+	expect(values.size() == roster.size() - 1, "to_combatants skips nullptr");
+	size_t at = 0;
+	for (Pokemon * pokemon : roster)
+	{
+		if (!pokemon || at >= values.size())
+			continue;
+		const Combatant & value = values[at++];
+		expect(value.type == pokemon->get_type() && value.health == pokemon->get_health(), "to_combatants keeps type, health and order");
+		expect(combatant_power(value, ATTACK) == pokemon->get_attack() && combatant_power(value, SPECIAL) == pokemon->get_special()
+			&& combatant_defend(value) == pokemon->get_defend(), "combatant stats for type " + to_string(value.type));
+	}
+	for (Pokemon * pokemon : roster)
+		delete pokemon;
+
+	auto chooser = [](const Combatant & self, const Combatant & opponent, int) {
+		return position_action(self.type, self.health, opponent.health);
+	};
+	Callback_policy policy([](const Pokemon & self, const Pokemon & opponent, int) {
+		return position_action(self.get_type(), self.get_health(), opponent.get_health());
+	});
+	for (int i = 0; i < 3000; ++i)
+	{
+		unique_ptr<Pokemon> a(new_pokemon(RNG::random_num(FIRE, GRASS)));
+		unique_ptr<Pokemon> b(new_pokemon(RNG::random_num(FIRE, GRASS)));
+		a->set_health(RNG::random_num(0, FULL_HEALTH));
+		b->set_health(RNG::random_num(0, FULL_HEALTH));
+		int limit = i % 10 == 0 ? RNG::random_num(1, 6) : DEFAULT_MAX_TURNS;
+		Combatant first = to_combatant(*a);
+		Combatant second = to_combatant(*b);
+		Battle_result valued = combatant_battle(first, second, chooser, chooser, limit);
+		Battle_engine engine(a.get(), b.get());
+		engine.set_max_turns(limit);
+		Battle_result played = engine.run(policy, policy);
+		expect(same_result(valued, played) && first.health == a->get_health() && second.health == b->get_health(),
+			"battle " + to_string(i) + ": combatant_battle against Battle_engine");
+	}
+}
+
+
+/****** EVENTS ******/
+
+/* This class writes every event as one letter, and adds up the damage. */
+class Event_trace: public Battle_events
+{
+	public:
+		string letters;		//S start, A attack, P special, D defend, H damage, F faint, W win, E error.
+		long long damage[2] = {0, 0};	//taken by the first and the second Pokemon.
+		const Pokemon * first = nullptr;	//the first Pokemon, from on_start.
+		void on_start(const Pokemon & a, const Pokemon &) { letters += 'S'; first = &a; }
+		void on_attack(const Pokemon &, int action, const char *, int) { letters += action == ATTACK ? 'A' : 'P'; }
+		void on_defend(const Pokemon &, const char *, int) { letters += 'D'; }
+		void on_damage(const Pokemon &, const Pokemon & defender, int dealt) { letters += 'H'; damage[&defender == first ? 0 : 1] += dealt; }
+		void on_faint(const Pokemon &, const Pokemon &) { letters += 'F'; }
+		void on_win(const Pokemon &, int side) { letters += char('0' + side); }
+		void on_error(const char *) { letters += 'E'; }
+};
+
+//S, then attack or special, defend and damage for every strike, then faint and the winning
+//side if a Pokemon fainted.
+static bool in_battle_order(const string & letters, int strikes, int fainted_side)
+{
+	size_t at = 0;
+	if (letters.empty() || letters[at++] != 'S')
+		return false;
+	for (int strike = 0; strike < strikes; ++strike, at += 3)
+		if (letters.compare(at, 3, "ADH") != 0 && letters.compare(at, 3, "PDH") != 0)
+			return false;
+	string end = fainted_side == 1 || fainted_side == 2 ? "F" + to_string(fainted_side) : "";
+	return letters.compare(at, string::npos, end) == 0;
+}
+
+//one battle on clones with the sink (nullptr for none), under the battle's own stream.
+static Battle_result play_with(const Pokemon & a, const Pokemon & b, uint64_t battle, Battle_events * events)
+{
+	Stream stream(RNG::get_seed(), battle);
+	Stream_scope scope(stream);
+	unique_ptr<Pokemon> first(clone_pokemon(&a));
+	unique_ptr<Pokemon> second(clone_pokemon(&b));
+	Random_policy random_policy;
+	Battle_engine engine(first.get(), second.get(), events);
+	return engine.run(random_policy, random_policy);
+}
+
+//every sink sees the same battle as no sink; events come in order and add up; text is the
+//same however it is buffered.
+static void check_events()
+{
+	Null_events quiet;
+	Counting_events counts;
+	ostringstream whole_text, piece_text, errors;
+	{
+		Text_events whole(whole_text, errors, size_t(1) << 20);
+		Text_events pieces(piece_text, errors, 1);
+		for (int i = 0; i < 500; ++i)
+		{
+			unique_ptr<Pokemon> a(new_pokemon(RNG::random_num(FIRE, GRASS)));
+			unique_ptr<Pokemon> b(new_pokemon(RNG::random_num(FIRE, GRASS)));
+			a->set_name(a->get_type());
+			b->set_name(b->get_type());
+			a->set_health(RNG::random_num(0, FULL_HEALTH));
+			b->set_health(RNG::random_num(0, FULL_HEALTH));
+			string where = "battle " + to_string(i);
+			Battle_result plain = play_with(*a, *b, uint64_t(i), nullptr);
+			expect(same_result(play_with(*a, *b, uint64_t(i), &quiet), plain), where + ": null sink");
+			Battle_result counted = play_with(*a, *b, uint64_t(i), &counts);
+			expect(same_result(counted, plain), where + ": counting sink");
+			expect(same_result(play_with(*a, *b, uint64_t(i), &whole), plain)
+				&& same_result(play_with(*a, *b, uint64_t(i), &pieces), plain), where + ": text sinks");
+
+			Event_trace trace;
+			expect(same_result(play_with(*a, *b, uint64_t(i), &trace), plain), where + ": trace");
+			int strikes = 2 * plain.turns - (plain.winner == 1);
+			expect(in_battle_order(trace.letters, strikes, plain.turns > 0 ? plain.winner : 0), where + ": events " + trace.letters);
+			expect(trace.damage[0] == plain.damage_to_first && trace.damage[1] == plain.damage_to_second, where + ": damage events add up");
+		}
+		expect(whole_text.str().empty(), "a big text buffer wrote before it was flushed");
+		expect(!piece_text.str().empty(), "a one byte text buffer didn't write as it went");
+		whole.flush();
+		expect(whole_text.str() == piece_text.str(), "text differs between buffer sizes");
+		expect(whole_text.str().find("--- Battle Beins ---") != string::npos && whole_text.str().find(" wins the battle!") != string::npos,
+			"text has the console lines");
+		Battle_engine broken(nullptr, nullptr, &whole);
+		expect(errors.str() == "Error: Null Pokemon pointers passed to the battle function!\n", "errors go to the error stream");
+	}
+	expect(counts.battles == 500 && counts.errors == 0, "counted battles");
+	expect(counts.attacks + counts.specials == counts.defends, "a defend for every attack");
+	expect(counts.wins[0] + counts.wins[1] == counts.faints, "a win for every faint");
+}
+
+
+/****** ROSTER ******/
+
+//keys from first up to (not including) last.
+static int count_keys(const Roster_model & model, uint64_t first, uint64_t last)
+{
+	return int(distance(model.lower_bound(first), model.lower_bound(last)));
+}
+
+//the healths under one key, sorted.
+static vector<int> healths_of(const Roster_model & model, uint64_t key)
+{
+	vector<int> out;
+	for (auto entry = model.lower_bound(key); entry != model.end() && entry->first == key; ++entry)
+		out.push_back(entry->second);
+	sort(out.begin(), out.end());
+	return out;
+}
+
+//same healths under one key in the roster.
+static vector<int> healths_of(const vector<Pokemon *> & all, uint64_t key)
+{
+	vector<int> out;
+	for (Pokemon * pokemon : all)
+		if (Roster::key_of(pokemon) == key)
+			out.push_back(pokemon->get_health());
+	sort(out.begin(), out.end());
+	return out;
+}
+
+//the model drops the one entry under the key whose health the roster no longer has.
+static void model_removed(Roster_model & model, const Roster & roster, uint64_t key, const string & where)
+{
+	vector<Pokemon *> all;
+	roster.collect(all);
+	vector<int> before = healths_of(model, key);
+	vector<int> after = healths_of(all, key);
+	vector<int> gone;
+	set_difference(before.begin(), before.end(), after.begin(), after.end(), back_inserter(gone));
+	expect(gone.size() == 1 && after.size() + 1 == before.size(), where + ": remove took one of the key's Pokemon");
+	if (gone.empty())
+		return;
+	for (auto entry = model.lower_bound(key); entry != model.end() && entry->first == key; ++entry)
+		if (entry->second == gone[0])
+		{
+			model.erase(entry);
+			return;
+		}
+}
+
+//the model's entry under the key with the old health gets the new one.
+static void model_changed(Roster_model & model, uint64_t key, int old_health, int health)
+{
+	for (auto entry = model.lower_bound(key); entry != model.end() && entry->first == key; ++entry)
+		if (entry->second == old_health)
+		{
+			entry->second = health;
+			return;
+		}
+	expect(false, "updated Pokemon was not in the model");
+}
+
+//everything the roster answers, against the model.
+static void compare(const Roster & roster, const Roster_model & model, const string & where)
+{
+	vector<Pokemon *> all;
+	roster.collect(all);
+	expect(roster.size() == int(model.size()) && all.size() == model.size(), where + ": size");
+	if (all.size() != model.size())
+		return;
+
+	size_t i = 0;
+	for (const pair<const uint64_t, int> & entry : model)
+	{
+		expect(Roster::key_of(all[i]) == entry.first, where + ": key order");
+		++i;
+	}
+	for (auto entry = model.begin(); entry != model.end(); entry = model.upper_bound(entry->first))
+		expect(healths_of(model, entry->first) == healths_of(all, entry->first), where + ": healths under a key");
+	vector<Pokemon *> backwards(roster.rbegin(), roster.rend());
+	expect(equal(all.rbegin(), all.rend(), backwards.begin(), backwards.end()), where + ": reverse order");
+
+	for (int k = 0; k < int(all.size()); k += max(1, int(all.size()) / 17))
+	{
+		Pokemon * pokemon = all[size_t(k)];
+		uint64_t key = Roster::key_of(pokemon);
+		expect(roster.select(k) == pokemon, where + ": select");
+		expect(roster.rank(pokemon->get_species_id(), pokemon->get_id()) == count_keys(model, 0, key), where + ": rank");
+		Pokemon * found = nullptr;
+		expect(roster.retrieve(pokemon->get_species_id(), pokemon->get_id(), found) == 1
+			&& Roster::key_of(found) == key, where + ": retrieve by id");
+	}
+	expect(roster.select(int(all.size())) == nullptr && roster.select(-1) == nullptr, where + ": select out of range");
+
+	for (int species = 0; species < SPECIES_COUNT; ++species)
+	{
+		uint64_t first = Roster::make_key(species, 0);
+		uint64_t last = Roster::make_key(species + 1, 0);
+		int count = count_keys(model, first, last);
+		expect(roster.count_species(species) == count, where + ": species count");
+		Pokemon * found = nullptr;
+		int got = roster.retrieve(Pokemon::species_name(species), found);
+		expect(got == (count > 0) && (!got || Roster::key_of(found) == model.lower_bound(first)->first), where + ": retrieve by name");
+	}
+
+	vector<int> healths;
+	for (const pair<const uint64_t, int> & entry : model)
+		healths.push_back(entry.second);
+	sort(healths.begin(), healths.end(), greater<int>());
+	for (int low = -5; low < 160; low += 23)
+	{
+		int high = low + RNG::random_num(0, 40);
+		vector<Pokemon *> wanted;
+		for (Pokemon * pokemon : all)
+			if (pokemon->get_health() >= low && pokemon->get_health() <= high)
+				wanted.push_back(pokemon);
+		stable_sort(wanted.begin(), wanted.end(), [](Pokemon * a, Pokemon * b) { return a->get_health() < b->get_health(); });
+		vector<Pokemon *> listed;
+		expect(roster.count_health(low, high) == int(wanted.size()), where + ": health count");
+		expect(roster.retrieve_health_range(low, high, listed) == int(wanted.size()) && listed.size() == wanted.size(), where + ": health range size");
+		for (size_t j = 0; j < listed.size() && j < wanted.size(); ++j)
+			expect(listed[j]->get_health() == wanted[j]->get_health() && Roster::key_of(listed[j]) == Roster::key_of(wanted[j]),
+				where + ": health range order");
+	}
+	for (int k = 1; k <= int(healths.size()); k += max(1, int(healths.size()) / 13))
+	{
+		Pokemon * pokemon = roster.kth_healthiest(k);
+		int health = healths[size_t(k - 1)];
+		uint64_t first = NO_KEY;
+		for (const pair<const uint64_t, int> & entry : model)
+			if (entry.second == health)
+				first = min(first, entry.first);
+		expect(pokemon && pokemon->get_health() == health && Roster::key_of(pokemon) == first, where + ": k-th healthiest");
+		if (pokemon)
+			expect(roster.health_rank(pokemon) == int(lower_bound(healths.begin(), healths.end(), health, greater<int>()) - healths.begin()),
+				where + ": health rank");
+	}
+	expect(roster.kth_healthiest(0) == nullptr && roster.kth_healthiest(int(healths.size()) + 1) == nullptr, where + ": k-th out of range");
+}
+
+//one random step on a roster and its model.
+static void roster_step(Roster & roster, Roster_model & model, const string & where)
+{
+	vector<Pokemon *> all;
+	roster.collect(all);
+	Pokemon * some = all.empty() ? nullptr : all[size_t(RNG::random_num(0, int(all.size()) - 1))];
+	int op = RNG::random_num(0, 99);
+	if (op < 20)
+	{
+		Pokemon * made = roster.create(RNG::random_num(FIRE, GRASS));
+		model.insert({Roster::key_of(made), made->get_health()});
+	}
+	else if (op < 26)
+	{
+		Pokemon * made = new_pokemon(RNG::random_num(FIRE, GRASS));
+		made->set_health(RNG::random_num(0, 150));
+		model.insert({Roster::key_of(made), made->get_health()});
+		roster.insert(made);
+	}
+	else if (op < 32 && some)
+	{
+		model.insert({Roster::key_of(some), some->get_health()});	//a copy under the same key.
+		roster.insert(clone_pokemon(some));
+	}
+	else if (op < 36)
+	{
+		vector<Pokemon *> batch;
+		for (int i = RNG::random_num(0, 60); i > 0; --i)
+		{
+			batch.push_back(roster.make(RNG::random_num(FIRE, GRASS)));
+			batch.back()->set_health(RNG::random_num(0, 120));
+			model.insert({Roster::key_of(batch.back()), batch.back()->get_health()});
+		}
+		roster.bulk_load(batch, RNG::random_num(1, 3));
+	}
+	else if (op < 52 && some)
+	{
+		uint64_t key = Roster::key_of(some);
+		expect(roster.remove_specific(some->get_species_id(), some->get_id()) == 1, where + ": remove by id");
+		model_removed(model, roster, key, where);
+	}
+	else if (op < 56)
+	{
+		int species = RNG::random_num(0, SPECIES_COUNT - 1);
+		auto first = model.lower_bound(Roster::make_key(species, 0));
+		bool any = first != model.end() && first->first < Roster::make_key(species + 1, 0);
+		uint64_t key = any ? first->first : 0;
+		expect(roster.remove_specific(Pokemon::species_name(species)) == int(any), where + ": remove by name");
+		if (any)
+			model_removed(model, roster, key, where);
+	}
+	else if (op < 80 && some)
+	{
+		Pokemon * found = nullptr;
+		expect(roster.retrieve_for_update(some->get_species_id(), some->get_id(), found) == 1, where + ": retrieve for update");
+		if (!found)
+			return;
+		int old_health = found->get_health();
+		int how = RNG::random_num(0, 4);
+		if (how == 0)
+			found->reduce_health(RNG::random_num(0, 40));
+		else if (how == 1)
+			found->heal();
+		else if (how == 2)
+			found->set_health(RNG::random_num(0, 300));
+		else if (how == 3)
+			found->reduce_health(1000);
+		else
+		{
+			Pokemon * saved = clone_pokemon(found);	//a state to go back to.
+			saved->set_health(RNG::random_num(0, 150));
+			*found = *saved;
+			delete saved;
+		}
+		model_changed(model, Roster::key_of(found), old_health, found->get_health());
+	}
+	else if (op < 82)
+	{
+		Pokemon * found = nullptr;
+		int species = RNG::random_num(0, SPECIES_COUNT - 1);
+		if (roster.retrieve_for_update(Pokemon::species_name(species), found))
+		{
+			int old_health = found->get_health();
+			found->heal();
+			model_changed(model, Roster::key_of(found), old_health, found->get_health());
+		}
+	}
+	else if (op < 84)
+		roster.set_indexed(!roster.is_indexed());
+	else if (op < 85)
+	{
+		roster.remove_all();
+		model.clear();
+	}
+}
+
+//several rosters sharing nodes through snapshots and assignments, each against its model.
+static void check_roster()
+{
+	const int steps = 20000;
+	vector<unique_ptr<Roster>> rosters;
+	vector<Roster_model> models;
+	rosters.emplace_back(new Roster());
+	models.emplace_back();
+	for (int step = 0; step < steps; ++step)
+	{
+		size_t at = size_t(RNG::random_num(0, int(rosters.size()) - 1));
+		string where = "step " + to_string(step);
+		int op = RNG::random_num(0, 99);
+		if (op < 3 && rosters.size() < 6)
+		{
+			rosters.emplace_back(new Roster(rosters[at]->snapshot()));
+			models.push_back(models[at]);
+		}
+		else if (op < 5 && rosters.size() > 1)
+		{
+			size_t from = size_t(RNG::random_num(0, int(rosters.size()) - 1));
+			*rosters[at] = *rosters[from];
+			models[at] = models[from];
+		}
+		else if (op < 7 && rosters.size() > 1)
+		{
+			rosters.erase(rosters.begin() + long(at));
+			models.erase(models.begin() + long(at));
+		}
+		else
+			roster_step(*rosters[at], models[at], where);
+		if (step % 50 == 0 || step == steps - 1)
+			for (size_t i = 0; i < rosters.size(); ++i)
+				compare(*rosters[i], models[i], where + ", roster " + to_string(i));
+	}
+}
+
+
+/****** SNAPSHOTS ******/
+
+//the roster's (key, health) pairs in order.
+static Roster_model model_of(const Roster & roster)
+{
+	Roster_model model;
+	for (Pokemon * pokemon : roster)
+		model.insert(model.end(), {Roster::key_of(pokemon), pokemon->get_health()});
+	return model;
+}
+
+//persistence, reclamation and copies on two threads.
+static void check_snapshots()
+{
+	Roster base;
+	for (int i = 0; i < 20000; ++i)
+		base.create(RNG::random_num(FIRE, GRASS));
+	Roster saved = base.snapshot();
+	Roster_model saved_model = model_of(base);
+	Roster_model model = saved_model;
+	for (int i = 0; i < 5000; ++i)
+		roster_step(base, model, "after snapshot");
+	compare(saved, saved_model, "snapshot after its source changed");
+	compare(base, model, "source after its snapshot");
+
+	vector<Pokemon *> all;
+	base.collect(all);
+	for (int i = 0; i < 2000; ++i)	//warm up: the pools grow to what one snapshot in flight needs.
+	{
+		Roster snapshot = base.snapshot();
+		Pokemon * found = nullptr;
+		Pokemon * some = all[size_t(RNG::random_num(0, int(all.size()) - 1))];
+		if (base.retrieve_for_update(some->get_species_id(), some->get_id(), found))
+			found->heal();
+	}
+	int chunks = base.allocated_chunks();
+	for (int i = 0; i < 50000; ++i)
+	{
+		Roster snapshot = base.snapshot();
+		Pokemon * found = nullptr;
+		Pokemon * some = all[size_t(RNG::random_num(0, int(all.size()) - 1))];
+		if (base.retrieve_for_update(some->get_species_id(), some->get_id(), found))
+			found->heal();
+	}
+	expect(base.allocated_chunks() == chunks, "pools grew over snapshots taken and dropped: "
+		+ to_string(chunks) + " -> " + to_string(base.allocated_chunks()) + " chunks");
+	model = model_of(base);
+	compare(base, model, "after the snapshot loop");
+
+	Roster first(base);
+	Roster second(base);
+	Roster_model first_model = model;
+	Roster_model second_model = model;
+	uint64_t seeds[2] = {11, 12};
+	auto work = [&seeds](Roster & roster, Roster_model & copy_model, int side)
+	{
+		uint64_t state = seeds[side];
+		for (int i = 0; i < 20000; ++i)
+		{
+			state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+			if ((state >> 60) < 8)
+			{
+				Pokemon * made = roster.create(int(state >> 33) % 3 + 1);
+				copy_model.insert({Roster::key_of(made), made->get_health()});
+				continue;
+			}
+			Pokemon * found = nullptr;
+			if (!roster.retrieve_for_update(Pokemon::species_name(int(state >> 33) % SPECIES_COUNT), found))
+				continue;
+			int old_health = found->get_health();
+			found->set_health(int(state >> 40) % 200);
+			model_changed(copy_model, Roster::key_of(found), old_health, found->get_health());
+		}
+	};
+	thread other(work, ref(second), ref(second_model), 1);
+	work(first, first_model, 0);
+	other.join();
+	compare(first, first_model, "first copy changed on its own thread");
+	compare(second, second_model, "second copy changed on its own thread");
+	compare(base, model, "source of the two copies");
+}
+
+
+/****** BST ******/
+
+//the tree's names in order against the multiset.
+static bool same_names(const BST & tree, const multiset<string> & names)
+{
+	vector<Pokemon *> all;
+	tree.collect(all);
+	if (all.size() != names.size())
+		return false;
+	auto name = names.begin();
+	for (Pokemon * pokemon : all)
+		if (pokemon->get_name() != *name++)
+			return false;
+	return true;
+}
+
+//random inserts and removes, copies and assignments, and concurrent const walks.
+static void check_bst()
+{
+	BST tree;
+	multiset<string> names;
+	for (int step = 0; step < 20000; ++step)
+	{
+		if (RNG::random_num(0, 9) < 6)
+		{
+			int type = RNG::random_num(FIRE, GRASS);
+			Pokemon * made = new_pokemon(type);
+			made->set_name(type);
+			names.insert(made->get_name());
+			tree.insert(made);
+		}
+		else
+		{
+			string name = Pokemon::species_name(RNG::random_num(0, SPECIES_COUNT - 1));
+			auto found = names.find(name);
+			Pokemon * retrieved = nullptr;
+			expect(tree.retrieve(name, retrieved) == int(found != names.end()), "BST retrieve " + name);
+			expect(tree.remove_specific(name) == int(found != names.end()), "BST remove " + name);
+			if (found != names.end())
+				names.erase(found);
+		}
+		if (step % 997 == 0)
+		{
+			expect(same_names(tree, names), "BST contents at step " + to_string(step));
+			BST copied(tree);
+			expect(same_names(copied, names), "BST copy at step " + to_string(step));
+			BST assigned;
+			assigned = copied;
+			expect(same_names(assigned, names), "BST assignment at step " + to_string(step));
+		}
+	}
+	const BST & shared = tree;
+	atomic<int> wrong(0);
+	vector<thread> readers;
+	for (int i = 0; i < 4; ++i)
+		readers.emplace_back([&shared, &names, &wrong] {
+			for (int k = 0; k < 20; ++k)
+				wrong += !same_names(shared, names);
+		});
+	for (thread & reader : readers)
+		reader.join();
+	expect(wrong == 0, "BST walked from several threads at once");
+}
+
+
+/****** CONCURRENT ******/
+
+//8 threads with exact expected contents, then more threads inside than epoch slots.
+static void check_concurrent()
+{
+	const int threads = 8;
+	const int residents = 2000;
+	Concurrent_roster roster;
+	vector<pair<int, uint32_t>> resident_keys;
+	for (int i = 0; i < residents; ++i)
+	{
+		Pokemon * made = new_pokemon(RNG::random_num(FIRE, GRASS));
+		made->set_health(0);
+		resident_keys.push_back({made->get_species_id(), made->get_id()});
+		roster.insert(made);
+	}
+
+	vector<set<pair<int, uint32_t>>> owned(threads);	//what each thread inserted and hasn't removed.
+	vector<long long> updated(threads, 0);			//updates that found a resident.
+	vector<int> wrong(threads, 0);
+	vector<thread> workers;
+	for (int t = 0; t < threads; ++t)
+		workers.emplace_back([&, t] {
+			uint64_t state = uint64_t(t) * 7919 + 1;
+			vector<pair<int, uint32_t>> mine;
+			for (int i = 0; i < (t < threads / 2 ? 40000 : 8000); ++i)	//half stop early: their slots go idle.
+			{
+				state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+				int op = int((state >> 20) % 100);
+				if (op < 60)
+				{
+					const pair<int, uint32_t> & key = resident_keys[size_t(state >> 33) % resident_keys.size()];
+					updated[t] += roster.update(key.first, key.second, [](Pokemon & pokemon) { pokemon.set_health(pokemon.get_health() + 1); });
+				}
+				else if (op < 80)
+				{
+					Pokemon * made = new_pokemon(int(state >> 40) % 3 + 1);
+					pair<int, uint32_t> key(made->get_species_id(), made->get_id());
+					wrong[t] += roster.insert(made) != 1;
+					mine.push_back(key);
+					owned[t].insert(key);
+				}
+				else if (!mine.empty())
+				{
+					size_t pick = size_t(state >> 33) % mine.size();
+					pair<int, uint32_t> key = mine[pick];
+					mine[pick] = mine.back();
+					mine.pop_back();
+					wrong[t] += roster.remove(key.first, key.second) != 1;
+					wrong[t] += roster.contains(key.first, key.second) != 0;
+					owned[t].erase(key);
+				}
+			}
+		});
+	for (thread & worker : workers)
+		worker.join();
+
+	size_t expected = residents;
+	long long updates = 0;
+	for (int t = 0; t < threads; ++t)
+	{
+		expect(wrong[t] == 0, "thread " + to_string(t) + ": " + to_string(wrong[t]) + " inserts or removes went wrong");
+		expected += owned[t].size();
+		updates += updated[t];
+		for (const pair<int, uint32_t> & key : owned[t])
+			expect(roster.contains(key.first, key.second) == 1, "an inserted Pokemon is missing");
+	}
+	expect(roster.size() == int(expected), "size " + to_string(roster.size()) + ", expected " + to_string(expected));
+	long long health = 0;
+	for (const pair<int, uint32_t> & key : resident_keys)
+		roster.update(key.first, key.second, [&health](Pokemon & pokemon) { health += pokemon.get_health(); });
+	expect(health == updates, "health added " + to_string(health) + ", updates " + to_string(updates));
+	expect(roster.reclaim() == 0, "nodes still waiting after reclaim: " + to_string(roster.pending()));
+
+	//more threads inside guards at once than there are slots: nobody may wait for a slot.
+	const int crowd = EPOCH_SLOTS + 72;
+	vector<pair<int, uint32_t>> crowd_keys;
+	for (int i = 0; i < 2 * crowd; ++i)
+	{
+		Pokemon * made = new_pokemon(WATER);
+		crowd_keys.push_back({made->get_species_id(), made->get_id()});
+		roster.insert(made);
+	}
+	atomic<int> inside(0);
+	atomic<int> removed(0);
+	workers.clear();
+	for (int t = 0; t < crowd; ++t)
+		workers.emplace_back([&, t] {
+			const pair<int, uint32_t> & key = crowd_keys[size_t(t)];
+			roster.update(key.first, key.second, [&inside, crowd](Pokemon &) {
+				++inside;
+				while (inside < crowd)
+					this_thread::yield();
+			});
+			const pair<int, uint32_t> & gone = crowd_keys[size_t(crowd + t)];
+			removed += roster.remove(gone.first, gone.second);
+		});
+	for (thread & worker : workers)
+		worker.join();
+	expect(inside == crowd, "not every thread got inside");
+	expect(removed == crowd, "removes while crowded: " + to_string(removed));
+	expect(roster.size() == int(expected) + crowd, "size after the crowd");
+	expect(roster.reclaim() == 0, "nodes still waiting after the crowd: " + to_string(roster.pending()));
+
+	//inserts and removes racing on the same few keys, so an insert still linking its upper levels
+	//meets the remove of its own node (under ASan, a node freed while visible shows up here).
+	const int churners = 8;
+	const int shared = 16;
+	vector<Pokemon *> originals;
+	for (int i = 0; i < shared; ++i)
+		originals.push_back(new_pokemon(RNG::random_num(FIRE, GRASS)));
+	vector<vector<int>> net(churners, vector<int>(shared, 0));	//inserts minus removes, per thread and key.
+	workers.clear();
+	for (int t = 0; t < churners; ++t)
+		workers.emplace_back([&, t] {
+			uint64_t state = uint64_t(t) * 104729 + 3;
+			for (int i = 0; i < 30000; ++i)
+			{
+				state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+				int k = int((state >> 33) % shared);
+				int op = int((state >> 20) % 100);
+				const Pokemon * original = originals[size_t(k)];
+				if (op < 45)
+				{
+					Pokemon * copy = clone_pokemon(original);
+					if (roster.insert(copy))
+						++net[t][size_t(k)];
+					else
+						delete copy;
+				}
+				else if (op < 90)
+					net[t][size_t(k)] -= roster.remove(original->get_species_id(), original->get_id());
+				else
+					roster.update(original->get_species_id(), original->get_id(), [](Pokemon & pokemon) { pokemon.heal(); });
+			}
+		});
+	for (thread & worker : workers)
+		worker.join();
+	int present = 0;
+	for (int k = 0; k < shared; ++k)
+	{
+		int total = 0;
+		for (int t = 0; t < churners; ++t)
+			total += net[t][size_t(k)];
+		int there = roster.contains(originals[size_t(k)]->get_species_id(), originals[size_t(k)]->get_id());
+		expect(total == there, "key " + to_string(k) + ": inserts minus removes " + to_string(total) + ", contains " + to_string(there));
+		present += there;
+	}
+	expect(roster.size() == int(expected) + crowd + present, "size after inserts and removes on the same keys");
+	expect(roster.reclaim() == 0, "nodes still waiting after the same-key races: " + to_string(roster.pending()));
+	for (Pokemon * pokemon : originals)
+		delete pokemon;
+}
+
+
+/****** WIN MATRIX ******/
+
+//exact probabilities against sampled battles, and the matrix against the exact cells.
+static void check_win_matrix()
+{
+	const int battles = 20000;
+	const int healths[][2] = {{100, 100}, {100, 70}, {35, 90}, {12, 9}};
+	auto random_action = [](const Combatant &, const Combatant &, int) { return RNG::random_num(ATTACK, SPECIAL); };
+	for (int first = FIRE; first <= GRASS; ++first)
+		for (int second = FIRE; second <= GRASS; ++second)
+			for (const int * health : healths)
+			{
+				int won = 0;
+				for (int i = 0; i < battles; ++i)
+				{
+					Combatant a{first, health[0]};
+					Combatant b{second, health[1]};
+					won += combatant_battle(a, b, random_action, random_action).winner == 1;
+				}
+				double sampled = double(won) / battles;
+				double exact = Win_matrix::win_probability(first, health[0], second, health[1]);
+				double allowed = 5 * sqrt(max(exact * (1 - exact), 1e-4) / battles) + 1e-3;
+				ostringstream what;
+				what << "types " << first << " vs " << second << " at " << health[0] << "/" << health[1]
+				     << ": exact " << exact << ", sampled " << sampled;
+				expect(fabs(sampled - exact) <= allowed, what.str());
+			}
+
+	vector<Pokemon *> rows;
+	vector<Pokemon *> cols;
+	for (int i = 0; i < 150; ++i)	//three tiles down and two across, so the threads split them.
+	{
+		rows.push_back(new_pokemon(RNG::random_num(FIRE, GRASS)));
+		rows.back()->set_health(RNG::random_num(0, FULL_HEALTH));
+	}
+	for (int i = 0; i < 1100; ++i)
+	{
+		cols.push_back(new_pokemon(RNG::random_num(FIRE, GRASS)));
+		cols.back()->set_health(RNG::random_num(0, FULL_HEALTH));
+	}
+	Win_matrix alone;
+	Win_matrix split;
+	alone.compute(rows, cols, 1);
+	split.compute(rows, cols, 4);
+	int wrong = 0;
+	int split_wrong = 0;
+	for (int r = 0; r < alone.get_rows(); ++r)
+		for (int c = 0; c < alone.get_cols(); ++c)
+		{
+			split_wrong += split.at(r, c) != alone.at(r, c);
+			if ((r * alone.get_cols() + c) % 53 != 0)
+				continue;	//win_probability solves a whole table per call: a sample is plenty.
+			float exact = float(Win_matrix::win_probability(rows[size_t(r)]->get_type(), rows[size_t(r)]->get_health(),
+				cols[size_t(c)]->get_type(), cols[size_t(c)]->get_health()));
+			wrong += fabs(alone.at(r, c) - exact) > 1e-6f;
+		}
+	expect(alone.get_rows() == 150 && alone.get_cols() == 1100, "matrix shape");
+	expect(wrong == 0, to_string(wrong) + " matrix cells differ from win_probability");
+	expect(split_wrong == 0, to_string(split_wrong) + " cells differ between one and four threads");
+	for (Pokemon * pokemon : rows)
+		delete pokemon;
+	for (Pokemon * pokemon : cols)
+		delete pokemon;
+}
+
+
+/****** BATTLE LOG ******/
+
+//the fields a decoded record must bring back.
+static bool same_record(const Log_record & a, const Log_record & b)
+{
+	auto same_pokemon = [](const Log_pokemon & x, const Log_pokemon & y) {
+		return x.type == y.type && x.species == y.species && x.health == y.health
+			&& x.attack == y.attack && x.special == y.special && x.defend == y.defend;
+	};
+	return a.seed == b.seed && a.battle_id == b.battle_id && same_pokemon(a.first, b.first)
+		&& same_pokemon(a.second, b.second) && a.first_actions == b.first_actions
+		&& a.second_actions == b.second_actions && a.result.winner == b.result.winner
+		&& a.result.turns == b.result.turns && a.result.damage_to_first == b.result.damage_to_first
+		&& a.result.damage_to_second == b.result.damage_to_second;
+}
+
+//decodes everything after the header, replaying what decodes; false if anything threw.
+static bool decode_all(const vector<uint8_t> & in)
+{
+	try
+	{
+		size_t pos = 0;
+		Log_record record;
+		Battle_result got;
+		if (!Battle_log::check_header(in, pos))
+			return true;
+		while (Battle_log::decode(in, pos, record) == 1)
+			Battle_log::replay(record, got);
+	}
+	catch (...)
+	{
+		return false;
+	}
+	return true;
+}
+
+//round trips and replays of random battles, every cut of a record, random corruptions, and a
+//count too big for the bytes left.
+static void check_battle_log()
+{
+	vector<Log_record> records;
+	vector<uint8_t> log;
+	Battle_log::write_header(log);
+	Random_policy random_policy;
+	for (int i = 0; i < 300; ++i)
+	{
+		Pokemon * first = new_pokemon(RNG::random_num(FIRE, GRASS));
+		Pokemon * second = new_pokemon(RNG::random_num(FIRE, GRASS));
+		first->set_name(first->get_type());
+		second->set_name(second->get_type());
+		second->set_health(RNG::random_num(0, FULL_HEALTH));
+		Stream stream(RNG::get_seed(), uint64_t(i));
+		Stream_scope scope(stream);
+		Log_record record;
+		Battle_log::play(first, second, random_policy, random_policy, record);
+		records.push_back(record);
+		Battle_log::encode(record, log);
+		delete first;
+		delete second;
+	}
+
+	size_t pos = 0;
+	expect(Battle_log::check_header(log, pos) == 1, "header of a fresh log");
+	size_t longest = 0;
+	for (size_t i = 0; i < records.size(); ++i)
+	{
+		Log_record got;
+		Battle_result replayed;
+		expect(Battle_log::decode(log, pos, got) == 1 && same_record(got, records[i]), "record " + to_string(i) + " round trip");
+		expect(Battle_log::replay(got, replayed) == 1, "record " + to_string(i) + " replay");
+		if (records[i].first_actions.size() > records[longest].first_actions.size())
+			longest = i;
+	}
+	Log_record rest;
+	expect(Battle_log::decode(log, pos, rest) == 0 && pos == log.size(), "end of the log");
+
+	vector<uint8_t> one;
+	Battle_log::encode(records[longest], one);
+	for (size_t cut = 1; cut < one.size(); ++cut)
+	{
+		vector<uint8_t> part(one.begin(), one.begin() + long(cut));
+		size_t at = 0;
+		Log_record got;
+		expect(Battle_log::decode(part, at, got) == -1, "record cut after " + to_string(cut) + " bytes");
+	}
+
+	for (int i = 0; i < 5000; ++i)
+	{
+		vector<uint8_t> bad;
+		Battle_log::write_header(bad);
+		Battle_log::encode(records[size_t(RNG::random_num(0, int(records.size()) - 1))], bad);
+		for (int changes = RNG::random_num(1, 3); changes > 0; --changes)
+			bad[size_t(RNG::random_num(5, int(bad.size()) - 1))] = uint8_t(RNG::random_num(0, 255));
+		expect(decode_all(bad), "corrupt log " + to_string(i) + " threw");
+	}
+
+	Log_record quiet = records[0];
+	quiet.first_actions.clear();
+	quiet.second_actions.clear();
+	vector<uint8_t> plain;
+	Battle_log::encode(quiet, plain);	//length byte, body, then two zero counts.
+	vector<uint8_t> huge(plain.begin() + 1, plain.end() - 2);
+	for (int i = 0; i < 9; ++i)
+		huge.push_back(0xFF);		//first count: 2^64 - 1.
+	huge.push_back(0x01);
+	huge.push_back(0x00);
+	huge.insert(huge.begin(), uint8_t(huge.size()));
+	expect(plain.size() < 0x80 && huge.size() < 0x80, "crafted record fits a one byte length");
+	try
+	{
+		size_t at = 0;
+		Log_record got;
+		expect(Battle_log::decode(huge, at, got) == -1, "an action count near 2^64 decoded");
+	}
+	catch (...)
+	{
+		expect(false, "an action count near 2^64 threw");
+	}
+}
+
+
+/****** SERVER ******/
+
+//the status of one request; the payload is left in response.
+static int ask(Net_client & client, uint8_t op, uint8_t a, uint8_t b, vector<uint8_t> & response)
+{
+	return client.request(op, a, b, 0, response);
+}
+
+//the protocol and its errors on one session, a battle to the end, and a client that sends
+//without reading next to one that plays.
+static void check_server()
+{
+#ifdef __linux__
+	string path = "/tmp/pokemon_check_" + to_string(getpid()) + ".sock";
+	Battle_server server(path, 1);
+	thread serving([&server] { server.run(); });
+	Net_client client;
+	for (int tries = 0; tries < 500 && client.connect_to(path) < 0; ++tries)
+		this_thread::sleep_for(chrono::milliseconds(10));
+	vector<uint8_t> got;
+
+	expect(ask(client, OP_TEAM, 1, 0, got) == STATUS_NO_TEAM, "TEAM before HELLO");
+	expect(ask(client, OP_START, 0, 0, got) == STATUS_NO_TEAM, "START before HELLO");
+	expect(ask(client, OP_MOVE, ATTACK, 0, got) == STATUS_NO_BATTLE, "MOVE before START");
+	expect(ask(client, OP_HELLO, 0, 0, got) == STATUS_BAD_REQUEST, "HELLO 0");
+	expect(ask(client, OP_HELLO, MAX_TEAM_SIZE + 1, 0, got) == STATUS_BAD_REQUEST, "HELLO past the team limit");
+	expect(ask(client, 99, 0, 0, got) == STATUS_BAD_REQUEST, "unknown op");
+	expect(ask(client, OP_HELLO, 3, 0, got) == STATUS_OK && got.size() == 3 && got[1] == 3 && got[2] == 3, "HELLO 3");
+	expect(ask(client, OP_TEAM, 3, 0, got) == STATUS_BAD_REQUEST, "TEAM 3");
+	for (uint8_t trainer = 1; trainer <= 2; ++trainer)
+	{
+		bool listed = ask(client, OP_TEAM, trainer, 0, got) == STATUS_OK && got.size() == 2 + 4 * 3 && got[1] == 3;
+		for (size_t at = 2; listed && at < got.size(); at += 4)
+			listed = got[at] >= FIRE && got[at] <= GRASS && (got[at + 2] | got[at + 3] << 8) == FULL_HEALTH;
+		expect(listed, "TEAM " + to_string(trainer) + " lists three full Pokemon");
+	}
+
+	expect(ask(client, OP_START, 3, 0, got) == STATUS_BAD_INDEX, "START past the first team");
+	expect(ask(client, OP_START, 0, 3, got) == STATUS_BAD_INDEX, "START past the second team");
+	expect(ask(client, OP_START, 0, 0, got) == STATUS_OK && got.size() == 7 && got[1] == 0
+		&& (got[3] | got[4] << 8) == FULL_HEALTH && (got[5] | got[6] << 8) == FULL_HEALTH, "START 0 0");
+	expect(ask(client, OP_START, 1, 1, got) == STATUS_BATTLE_RUNNING, "START during a battle");
+	expect(ask(client, OP_HELLO, 3, 0, got) == STATUS_BATTLE_RUNNING, "HELLO during a battle");
+	expect(ask(client, OP_CLEAR, 1, 0, got) == STATUS_BATTLE_RUNNING, "CLEAR during a battle");
+	expect(ask(client, OP_MOVE, 3, 0, got) == STATUS_BAD_REQUEST, "MOVE 3");
+	int winner = 0, moves = 0, health[2] = {FULL_HEALTH, FULL_HEALTH};
+	for (; moves < 10000 && winner == 0; ++moves)
+	{
+		int status = ask(client, OP_MOVE, uint8_t(RNG::random_num(ATTACK, SPECIAL)), 0, got);
+		if (status == STATUS_NO_BATTLE)
+			break;	//a draw ended it on the last move.
+		if (status != STATUS_OK || got.size() != 7)
+		{
+			expect(false, "MOVE " + to_string(moves) + " failed");
+			break;
+		}
+		winner = got[1];
+		int first = got[3] | got[4] << 8, second = got[5] | got[6] << 8;
+		expect(first <= health[0] && second <= health[1], "MOVE " + to_string(moves) + " healed someone");
+		health[0] = first;
+		health[1] = second;
+	}
+	expect(moves < 10000 && winner >= 0 && winner <= 2, "the battle ended");
+	expect(winner == 0 || health[2 - winner] == 0, "the loser is down");
+	expect(ask(client, OP_MOVE, ATTACK, 0, got) == STATUS_NO_BATTLE, "MOVE after the end");
+	expect(ask(client, OP_SCORE, 0, 0, got) == STATUS_OK && got.size() == 5
+		&& (got[1] | got[2] << 8) == (winner == 1) && (got[3] | got[4] << 8) == (winner == 2), "SCORE after one battle");
+	expect(ask(client, OP_CLEAR, 3, 0, got) == STATUS_BAD_REQUEST, "CLEAR 3");
+	expect(ask(client, OP_CLEAR, 2, 0, got) == STATUS_OK && got.size() == 1, "CLEAR 2");
+	expect(ask(client, OP_TEAM, 2, 0, got) == STATUS_OK && got.size() == 2 && got[1] == 0, "TEAM 2 after CLEAR");
+	expect(ask(client, OP_START, 0, 0, got) == STATUS_BAD_INDEX, "START with a cleared team");
+	expect(ask(client, OP_QUIT, 0, 0, got) == STATUS_OK, "QUIT");
+	int after = ask(client, OP_SCORE, 0, 0, got);	//may read the QUIT's own answer first.
+	if (after == STATUS_OK && got.size() == 1)
+		after = ask(client, OP_SCORE, 0, 0, got);
+	expect(after == -1, "the session is closed after QUIT");
+
+	//a client pipelines SCORE requests and doesn't read; its session must stop answering
+	//once its output backs up, and another session must still be served meanwhile.
+	const int PIPELINED = 200000;
+	long long before = server.requests_served();
+	int hog = connect_address(path);
+	if (hog < 0)
+	{
+		expect(false, "connecting the client that doesn't read");
+		server.stop();
+		serving.join();
+		return;
+	}
+	timeval patience{10, 0};
+	setsockopt(hog, SOL_SOCKET, SO_RCVTIMEO, &patience, sizeof(patience));
+	thread sender([hog, PIPELINED]
+	{
+		vector<uint8_t> requests;
+		for (int i = 0; i < PIPELINED; ++i)
+			requests.insert(requests.end(), {OP_SCORE, 0, 0, 0});
+		size_t sent = 0;
+		while (sent < requests.size())
+		{
+			ssize_t put = send(hog, requests.data() + sent, requests.size() - sent, MSG_NOSIGNAL);
+			if (put <= 0)
+				break;
+			sent += size_t(put);
+		}
+	});
+	this_thread::sleep_for(chrono::milliseconds(100));
+	Net_client other;
+	expect(other.connect_to(path) == 0 && ask(other, OP_HELLO, 2, 0, got) == STATUS_OK
+		&& ask(other, OP_SCORE, 0, 0, got) == STATUS_OK, "another client is served next to the one not reading");
+	long long settled = server.requests_served();
+	for (int rounds = 0; rounds < 100; ++rounds)
+	{
+		this_thread::sleep_for(chrono::milliseconds(50));
+		long long now = server.requests_served();
+		if (now == settled)
+			break;
+		settled = now;
+	}
+	settled -= before + 2;	//the other client's two.
+	expect(settled < PIPELINED / 2, "the client not reading got " + to_string(settled) + " of "
+		+ to_string(PIPELINED) + " requests answered before it read");
+
+	vector<uint8_t> responses(size_t(PIPELINED) * 6);
+	size_t read_so_far = 0;
+	while (read_so_far < responses.size())
+	{
+		ssize_t got_now = recv(hog, responses.data() + read_so_far, responses.size() - read_so_far, 0);
+		if (got_now <= 0)
+			break;
+		read_so_far += size_t(got_now);
+	}
+	sender.join();
+	expect(read_so_far == responses.size(), "the client not reading got " + to_string(read_so_far / 6) + " of "
+		+ to_string(PIPELINED) + " responses once it read");
+	bool well_formed = true;
+	for (size_t at = 0; well_formed && at < read_so_far; at += 6)
+		well_formed = responses[at] == 5 && responses[at + 1] == STATUS_OK && responses[at + 2] == 0 && responses[at + 4] == 0;
+	expect(well_formed, "pipelined SCORE responses");
+	expect(ask(other, OP_SCORE, 0, 0, got) == STATUS_OK, "the other client after the pipeline");
+	close(hog);
+
+	server.stop();
+	serving.join();
+#endif
+}
+
+
+/****** EXPECTIMAX ******/
+
+//the expectimax value of a state with no table, as the policy defines it.
+static double plain_expectimax(Combatant self, Combatant opponent, bool self_to_move, int depth)
+{
+	if (depth <= 0)
+		return double(self.health - opponent.health) / FULL_HEALTH;
+	double value = self_to_move ? -1.0 : 0.0;
+	for (int action = ATTACK; action <= SPECIAL; ++action)
+	{
+		if (self_to_move)
+		{
+			Combatant hit = opponent;
+			combatant_strike(self, hit, action);
+			value = max(value, hit.health <= 0 ? 1.0 : plain_expectimax(self, hit, false, depth - 1));
+		}
+		else
+		{
+			Combatant hit = self;
+			combatant_strike(opponent, hit, action);
+			value += 0.5 * (hit.health <= 0 ? -1.0 : plain_expectimax(hit, opponent, true, depth - 1));
+		}
+	}
+	return value;
+}
+
+//the value of taking the action now, with no table.
+static double plain_value(const Combatant & self, const Combatant & opponent, int action, int depth)
+{
+	Combatant hit = opponent;
+	combatant_strike(self, hit, action);
+	return hit.health <= 0 ? 1.0 : plain_expectimax(self, hit, false, depth - 1);
+}
+
+//a random state of two valid types with some health left.
+static pair<Combatant, Combatant> random_state()
+{
+	return {Combatant{RNG::random_num(FIRE, GRASS), RNG::random_num(1, FULL_HEALTH)},
+		Combatant{RNG::random_num(FIRE, GRASS), RNG::random_num(1, FULL_HEALTH)}};
+}
+
+//values and choices against a search without a table; legality, knockouts and repeats.
+static void check_expectimax()
+{
+	const int DEPTH = 6;
+	Expectimax_policy fresh(DEPTH), warm(DEPTH), again(DEPTH, 4);
+	for (int i = 0; i < 400; ++i)
+	{
+		pair<Combatant, Combatant> state = random_state();
+		const Combatant & self = state.first, & opponent = state.second;
+		string where = "state " + to_string(i) + " (" + to_string(self.type) + "/" + to_string(self.health)
+			+ " vs " + to_string(opponent.type) + "/" + to_string(opponent.health) + ")";
+		double attack = plain_value(self, opponent, ATTACK, DEPTH), special = plain_value(self, opponent, SPECIAL, DEPTH);
+		fresh.clear_table();
+		double got_attack = fresh.evaluate(self, opponent, ATTACK);
+		fresh.clear_table();
+		double got_special = fresh.evaluate(self, opponent, SPECIAL);
+		expect(fabs(got_attack - attack) < 1e-4 && fabs(got_special - special) < 1e-4, where + ": values on a fresh table");
+		fresh.clear_table();
+		int chosen = fresh.choose(self, opponent);
+		expect(chosen == ATTACK || chosen == SPECIAL, where + ": choice " + to_string(chosen));
+		if (fabs(attack - special) > 1e-4)
+			expect(chosen == (special > attack ? SPECIAL : ATTACK), where + ": choice against the plain search");
+		Combatant taken = opponent;
+		combatant_strike(self, taken, chosen);
+		for (int action = ATTACK; action <= SPECIAL; ++action)
+		{
+			Combatant hit = opponent;
+			combatant_strike(self, hit, action);
+			if (hit.health <= 0)
+				expect(taken.health <= 0, where + ": passed up a knockout");
+		}
+		int warm_choice = warm.choose(self, opponent);	//may use deeper stored values.
+		expect(warm_choice == warm.choose(self, opponent), where + ": warm table, same state twice");
+		double warm_value = warm.evaluate(self, opponent, warm_choice);
+		expect(warm_value >= -1.0 && warm_value <= 1.0, where + ": warm value " + to_string(warm_value));
+		int tiny_choice = again.choose(self, opponent);
+		expect((tiny_choice == ATTACK || tiny_choice == SPECIAL) && tiny_choice == again.choose(self, opponent), where + ": tiny table");
+
+		Pokemon * first = new_pokemon(self.type);
+		Pokemon * second = new_pokemon(opponent.type);
+		first->set_health(self.health);
+		second->set_health(opponent.health);
+		fresh.clear_table();
+		expect(fresh.choose(*first, *second, i) == chosen, where + ": Pokemon form");
+		delete first;
+		delete second;
+	}
+	expect(fresh.choose(Combatant{0, 50}, Combatant{FIRE, 50}) == ATTACK
+		&& fresh.choose(Combatant{FIRE, 50}, Combatant{GRASS + 1, 50}) == ATTACK, "bad types attack");
+	expect(warm.table_size() == size_t(1) << DEFAULT_TABLE_BITS && again.table_size() == 16, "table sizes");
+	expect(warm.get_stats().decisions == 800 && warm.get_stats().hits <= warm.get_stats().probes, "search stats");
+}
+
+
+/****** MCTS ******/
+
+//legal choices everywhere, the knockout wherever the other action is clearly worse, and the stats.
+static void check_mcts()
+{
+	for (int threads : {1, 3})
+	{
+		string where = to_string(threads) + " thread(s)";
+		Mcts_policy policy(threads, 3000), cramped(threads, 500, 16);
+		int decisions = 0;
+		for (int i = 0; i < 150; ++i)
+		{
+			pair<Combatant, Combatant> state = random_state();
+			const Combatant & self = state.first, & opponent = state.second;
+			string at = where + ", state " + to_string(i) + " (" + to_string(self.type) + "/" + to_string(self.health)
+				+ " vs " + to_string(opponent.type) + "/" + to_string(opponent.health) + ")";
+			int chosen = policy.choose(self, opponent);
+			expect(chosen == ATTACK || chosen == SPECIAL, at + ": choice " + to_string(chosen));
+			int small = cramped.choose(self, opponent);
+			expect(small == ATTACK || small == SPECIAL, at + ": choice with 16 nodes " + to_string(small));
+			++decisions;
+		}
+
+		//every type pair with the opponent just inside the stronger action's reach: that
+		//action knocks it out, and where the weaker one is worth at most 0.5 (on -1 .. 1) it
+		//must be taken.
+		int forced = 0;
+		for (int self_type = FIRE; self_type <= GRASS; ++self_type)
+			for (int opponent_type = FIRE; opponent_type <= GRASS; ++opponent_type)
+				for (int self_health = 5; self_health <= FULL_HEALTH; self_health += 5)
+				{
+					Combatant self{self_type, self_health}, by_attack{opponent_type, FULL_HEALTH}, by_special = by_attack;
+					int attack = combatant_strike(self, by_attack, ATTACK), special = combatant_strike(self, by_special, SPECIAL);
+					if (attack == special)
+						continue;
+					Combatant opponent{opponent_type, max(attack, special)};
+					int knockout = attack > special ? ATTACK : SPECIAL;
+					if (plain_value(self, opponent, knockout == ATTACK ? SPECIAL : ATTACK, 6) > 0.5)
+						continue;
+					++forced;
+					++decisions;
+					expect(policy.choose(self, opponent) == knockout, where + ": passed up a knockout at "
+						+ to_string(self_type) + "/" + to_string(self_health) + " vs " + to_string(opponent_type)
+						+ "/" + to_string(opponent.health));
+				}
+		expect(forced >= 20, where + ": only " + to_string(forced) + " forced knockouts");
+		policy.set_budget(0);
+		pair<Combatant, Combatant> state = random_state();
+		int quick = policy.choose(state.first, state.second);
+		expect(quick == ATTACK || quick == SPECIAL, where + ": zero budget");
+		expect(policy.choose(Combatant{0, 50}, Combatant{FIRE, 50}) == ATTACK
+			&& policy.choose(Combatant{FIRE, 50}, Combatant{GRASS + 1, 50}) == ATTACK, where + ": bad types attack");
+
+		const Mcts_stats & stats = policy.get_stats();
+		expect(stats.decisions == decisions + 1 && stats.threads == threads, where + ": decisions and threads");
+		expect(stats.rollouts >= 16 * stats.decisions && stats.nodes <= stats.decisions * DEFAULT_MCTS_NODES, where + ": rollouts and nodes");
+		expect(cramped.get_stats().nodes <= cramped.get_stats().decisions * 16, where + ": nodes past a full pool");
+	}
+}
+
+
+/****** COMPLETION ******/
+
+//the name in lower case.
+static string lower_case(string name)
+{
+	for (char & letter : name)
+		letter = char(tolower((unsigned char)letter));
+	return name;
+}
+
+//edits from a to b over the whole table, no band and no cut off.
+static int full_levenshtein(const string & a, const string & b)
+{
+	vector<vector<int>> table(a.size() + 1, vector<int>(b.size() + 1));
+	for (size_t i = 0; i <= a.size(); ++i)
+		for (size_t j = 0; j <= b.size(); ++j)
+			table[i][j] = i == 0 ? int(j) : j == 0 ? int(i) : min({table[i - 1][j] + 1, table[i][j - 1] + 1,
+				table[i - 1][j - 1] + (a[i - 1] == b[j - 1] ? 0 : 1)});
+	return table[a.size()][b.size()];
+}
+
+//something a user might type: a piece of a name with random case and a few typos, or noise.
+static string typed_name()
+{
+	string typed;
+	if (RNG::random_num(0, 4) == 0)
+		for (int i = RNG::random_num(0, 12); i > 0; --i)
+			typed += char(RNG::random_num('a', 'z'));
+	else
+	{
+		const string & name = Pokemon::species_name(RNG::random_num(0, SPECIES_COUNT - 1));
+		typed = name.substr(0, size_t(RNG::random_num(0, int(name.size()))));
+		for (int typos = RNG::random_num(0, 3); typos > 0; --typos)
+		{
+			int at = RNG::random_num(0, int(typed.size()));
+			int kind = RNG::random_num(0, 2);
+			if (kind == 0 || typed.empty())
+				typed.insert(size_t(at), 1, char(RNG::random_num('a', 'z')));
+			else if (at < int(typed.size()) && kind == 1)
+				typed.erase(size_t(at), 1);
+			else if (at < int(typed.size()))
+				typed[size_t(at)] = char(RNG::random_num('a', 'z'));
+		}
+	}
+	for (char & letter : typed)
+		if (RNG::random_num(0, 3) == 0)
+			letter = char(toupper((unsigned char)letter));
+	return typed;
+}
+
+//name order of the ids, name_distance against the full table, complete and suggest against scans.
+static void check_completion()
+{
+	for (int species = 0; species + 1 < SPECIES_COUNT; ++species)
+		expect(lower_case(Pokemon::species_name(species)) < lower_case(Pokemon::species_name(species + 1)),
+			"species " + to_string(species) + " and " + to_string(species + 1) + " out of case-folded name order");
+
+	for (int i = 0; i < 200000; ++i)
+	{
+		string typed = typed_name();
+		int species = RNG::random_num(0, SPECIES_COUNT - 1), most = RNG::random_num(0, 5);
+		int exact = full_levenshtein(lower_case(typed), lower_case(Pokemon::species_name(species)));
+		int got = Pokemon::name_distance(typed, species, most);
+		expect(got == min(exact, most + 1), "name_distance(\"" + typed + "\", " + Pokemon::species_name(species) + ", "
+			+ to_string(most) + ") = " + to_string(got) + ", full table " + to_string(exact));
+	}
+	expect(Pokemon::name_distance("Lapras", -1, 2) == 3 && Pokemon::name_distance("Lapras", SPECIES_COUNT, 2) == 3,
+		"name_distance with a bad species id");
+
+	for (int round = 0; round < 300; ++round)
+	{
+		Roster roster;
+		for (int i = RNG::random_num(0, 25); i > 0; --i)
+			roster.create(RNG::random_num(FIRE, GRASS));
+		for (int query = 0; query < 20; ++query)
+		{
+			string typed = typed_name();
+			string where = "round " + to_string(round) + ", \"" + typed + "\"";
+			vector<int> expected, got;
+			for (int species = 0; species < SPECIES_COUNT; ++species)
+				if (roster.count_species(species) > 0
+					&& lower_case(Pokemon::species_name(species)).compare(0, typed.size(), lower_case(typed)) == 0)
+					expected.push_back(species);
+			expect(roster.complete(typed, got) == int(expected.size()) && got == expected, where + ": complete");
+
+			int most = RNG::random_num(0, 4);
+			vector<pair<int, int>> close;
+			for (int species = 0; species < SPECIES_COUNT; ++species)
+			{
+				int distance = full_levenshtein(lower_case(typed), lower_case(Pokemon::species_name(species)));
+				if (roster.count_species(species) > 0 && distance <= most)
+					close.push_back({distance, species});
+			}
+			sort(close.begin(), close.end());
+			expected.clear();
+			for (const pair<int, int> & found : close)
+				expected.push_back(found.second);
+			got.clear();
+			expect(roster.suggest(typed, most, got) == int(expected.size()) && got == expected,
+				where + ": suggest within " + to_string(most));
+		}
+	}
+}
+
+
+/****** DRIVER ******/
+
+struct Check
+{
+	const char * name;
+	void (*run)();
+};
+
+static const Check CHECKS[] = {
+	{"rng", check_rng},
+	{"tournament", check_tournament},
+	{"batch", check_batch},
+	{"matchup", check_matchup},
+	{"combatant", check_combatant},
+	{"events", check_events},
+	{"roster", check_roster},
+	{"snapshots", check_snapshots},
+	{"bst", check_bst},
+	{"concurrent", check_concurrent},
+	{"win_matrix", check_win_matrix},
+	{"battle_log", check_battle_log},
+	{"server", check_server},
+	{"expectimax", check_expectimax},
+	{"mcts", check_mcts},
+	{"completion", check_completion},
+};
+
+int main(int argc, char *argv[])
+{
+	int failed = 0;
+	for (const Check & check : CHECKS)
+	{
+		bool wanted = argc < 2;
+		for (int i = 1; i < argc; ++i)
+			wanted = wanted || strcmp(argv[i], check.name) == 0;
+		if (!wanted)
+			continue;
+		cout << "--- " << check.name << " ---" << endl;
+		mismatches = 0;
+		RNG::set_seed(1);	//each check sees the same numbers however many ran before it.
+		check.run();
+		if (mismatches == 0)
+			cout << "ok" << endl;
+		else
+		{
+			cout << "FAILED: " << mismatches << " mismatch(es)" << endl;
+			++failed;
+		}
+	}
+	return failed == 0 ? 0 : 1;
+}
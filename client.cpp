@@ -3,17 +3,259 @@
 //
 // This file acts as the client for this project. 
 
-#include "battle.h"
+#include "tournament.h"
+#include "batch.h"
+#include "battle_log.h"
+#include "net_client.h"
+#include "win_matrix.h"
+#include <csignal>
+#include <chrono>
 
-int main()
+static Battle_server * serving = nullptr;	//the server --serve runs, stopped by Ctrl-C.
+
+//stops the server on SIGINT/SIGTERM.
+static void stop_serving(int)
+{
+	if (serving)
+		serving->stop();
+}
+
+int main(int argc, char *argv[])
 {
 	try
     {
+        // Command line options
+        //	--seed N		seeds every random number engine so the run can be reproduced.
+        //	--tournament N		simulates every pairing of two random teams of size N, then quits.
+        //	--threads N		workers for --tournament (default: one per core).
+        //	--batch N		runs N random battles through the batched kernel, then quits.
+        //	--record FILE		appends every battle to a binary battle log.
+        //	--replay FILE		replays a battle log and checks every result, then quits.
+        //	--ai			the computer plays trainer 2 (expectimax search).
+        //	--mcts US		the computer plays trainer 2 with tree search, US microseconds a move (uses --threads).
+        //	--matrix N		win probability matrix between two random teams of size N, then quits.
+        //	--csv FILE		exports the --matrix result as CSV.
+        //	--serve ADDR		serves matches on a Unix socket path or tcp:PORT (uses --threads).
+        //	--client ADDR		plays a match against a server by typed commands.
+        //	--loadgen ADDR		measures a server with --sessions N sessions of --moves M requests.
+        int tournament_size = 0;
+        int batch_size = 0;
+        string record_path;
+        string replay_path;
+        int threads = 0;
+        string serve_address;
+        string client_address;
+        string loadgen_address;
+        int sessions = 100;
+        int moves = 1000;
+        bool ai = false;
+        int matrix_size = 0;
+        string csv_path;
+        int mcts_budget = 0;
+        for (int i = 1; i < argc; ++i)
+        {
+            string arg = argv[i];
+            if (arg == "--seed" && i + 1 < argc)
+            {
+                RNG::set_seed(stoull(argv[++i]));
+            }
+            else if (arg == "--tournament" && i + 1 < argc)
+            {
+                tournament_size = stoi(argv[++i]);
+            }
+            else if (arg == "--batch" && i + 1 < argc)
+            {
+                batch_size = stoi(argv[++i]);
+            }
+            else if (arg == "--record" && i + 1 < argc)
+            {
+                record_path = argv[++i];
+            }
+            else if (arg == "--replay" && i + 1 < argc)
+            {
+                replay_path = argv[++i];
+            }
+            else if (arg == "--threads" && i + 1 < argc)
+            {
+                threads = stoi(argv[++i]);
+            }
+            else if (arg == "--ai")
+            {
+                ai = true;
+            }
+            else if (arg == "--mcts" && i + 1 < argc)
+            {
+                mcts_budget = stoi(argv[++i]);
+            }
+            else if (arg == "--matrix" && i + 1 < argc)
+            {
+                matrix_size = stoi(argv[++i]);
+            }
+            else if (arg == "--csv" && i + 1 < argc)
+            {
+                csv_path = argv[++i];
+            }
+            else if (arg == "--serve" && i + 1 < argc)
+            {
+                serve_address = argv[++i];
+            }
+            else if (arg == "--client" && i + 1 < argc)
+            {
+                client_address = argv[++i];
+            }
+            else if (arg == "--loadgen" && i + 1 < argc)
+            {
+                loadgen_address = argv[++i];
+            }
+            else if (arg == "--sessions" && i + 1 < argc)
+            {
+                sessions = stoi(argv[++i]);
+            }
+            else if (arg == "--moves" && i + 1 < argc)
+            {
+                moves = stoi(argv[++i]);
+            }
+            else
+            {
+                cerr << "Unknown option: " << arg << endl;
+                cerr << "Usage: " << argv[0] << " [--seed N] [--tournament N [--threads N]] [--batch N] [--record FILE] [--replay FILE] [--ai | --mcts US] [--matrix N [--csv FILE]]"
+                     << " [--serve ADDR [--threads N]] [--client ADDR] [--loadgen ADDR [--sessions N] [--moves M]]" << endl;
+                return 1;
+            }
+        }
+
+        // Replay a battle log
+        if (!replay_path.empty())
+        {
+            return Battle_log::replay_file(replay_path, cout) == 0 ? 0 : 1;
+        }
+
+        // Battle server
+        if (!serve_address.empty())
+        {
+            Battle_server server(serve_address, threads > 0 ? threads : 1);
+            serving = &server;
+            signal(SIGINT, stop_serving);
+            signal(SIGTERM, stop_serving);
+            cout << "Serving on " << serve_address << endl;
+            int status = server.run();
+            serving = nullptr;
+            cout << "Served " << server.sessions_served() << " sessions, "
+                 << server.requests_served() << " requests." << endl;
+            return status == 0 ? 0 : 1;
+        }
+
+        // Play against a server
+        if (!client_address.empty())
+        {
+            Net_client client;
+            if (client.connect_to(client_address) < 0)
+            {
+                cerr << "Error: cannot connect to " << client_address << endl;
+                return 1;
+            }
+            return client.console(cin, cout) == 0 ? 0 : 1;
+        }
+
+        // Load a server
+        if (!loadgen_address.empty())
+        {
+            Load_generator generator(loadgen_address, sessions, moves);
+            Load_result result;
+            if (generator.run(result) < 0)
+            {
+                cerr << "Error: cannot connect to " << loadgen_address << endl;
+                return 1;
+            }
+            Load_generator::display(result, cout);
+            return 0;
+        }
+
+        // Win probability matrix between two random teams
+        if (matrix_size > 0)
+        {
+            Trainer first, second;
+            first.set_quiet(true);
+            second.set_quiet(true);
+            first.build_team(matrix_size);
+            second.build_team(matrix_size);
+
+            Win_matrix matrix;
+            auto start = chrono::steady_clock::now();
+            long long cells = matrix.compute(first, second, threads);
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            cout << "Matrix: " << matrix.get_rows() << " x " << matrix.get_cols() << " (" << cells << " pairs)" << endl;
+            cout << "Trainer 1 average win probability: " << matrix.mean() << endl;
+            cout << "Time: " << seconds << " s" << endl;
+            if (!csv_path.empty() && matrix.export_csv(csv_path) < 0)
+            {
+                cerr << "Error: cannot write " << csv_path << endl;
+                return 1;
+            }
+            return 0;
+        }
+
+        // Batched kernel on random pairs
+        if (batch_size > 0)
+        {
+            Fire fire;
+            Water water;
+            Grass grass;
+            Pokemon *kinds[3] = {&fire, &water, &grass};
+            Battle_batch batch;
+            for (int i = 0; i < batch_size; ++i)
+            {
+                batch.add(*kinds[RNG::random_num(0, 2)], *kinds[RNG::random_num(0, 2)],
+                          RNG::random_num(ATTACK, SPECIAL), RNG::random_num(ATTACK, SPECIAL));
+            }
+
+            auto start = chrono::steady_clock::now();
+            int turns = batch.run();
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+            long long wins[3] = {0, 0, 0};
+            for (int i = 0; i < batch.size(); ++i)
+                ++wins[batch.get_winner(i)];
+            cout << "Kernel: " << Battle_batch::kernel_name() << endl;
+            cout << "Battles: " << batch.size() << "  Turns: " << turns << endl;
+            cout << "First wins: " << wins[1] << "  Second wins: " << wins[2] << "  Draws: " << wins[0] << endl;
+            cout << "Time: " << seconds << " s  (" << (long long)(seconds > 0 ? batch.size() / seconds : 0)
+                 << " battles/sec)" << endl;
+            return 0;
+        }
+
+        // Non-interactive tournament between two random teams
+        if (tournament_size > 0)
+        {
+            Stadium arena;
+            string name = "Trainer 1";
+            arena.get_trainer(1).set_name(name);
+            arena.get_trainer(1).build_team(tournament_size);
+            name = "Trainer 2";
+            arena.get_trainer(2).set_name(name);
+            arena.get_trainer(2).build_team(tournament_size);
+
+            Tournament tournament(threads);
+            tournament.add_stadium(arena);
+            tournament.set_log(record_path);
+            tournament.display(tournament.run());
+            return 0;
+        }
+
         // Initial Setup
         cout << "Welcome to the Pokemon Battle Simulation!" << endl;
 
         // Create the Stadium (game manager)
         Stadium new_game;
+        new_game.set_log(record_path);
+        if (mcts_budget > 0)
+        {
+            new_game.set_ai(2, new Mcts_policy(threads > 0 ? threads : 1, mcts_budget));
+        }
+        else if (ai)
+        {
+            new_game.set_ai(2);
+        }
 
         // Set up trainers and their teams
         new_game.set_trainers();
@@ -21,14 +263,25 @@ int main()
 		//new_game.start_battle();
         // Display the main menu to start the gameplay loop
         new_game.display_menu();
+        if (new_game.get_ai())
+        {
+            display_search_stats(*new_game.get_ai(), cout);
+        }
     }
     catch (const string &e)
     {
         cerr << "Error: " << e << endl;
+        return 1;
+    }
+    catch (const exception &e)
+    {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
     }
     catch (...)
     {
         cerr << "An unknown error occurred!" << endl;
+        return 1;
     }
 
     return 0;
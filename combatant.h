@@ -0,0 +1,135 @@
+// Author: Pokemon Battle contributors
+// Date: 10-17-2026
+//
+// This file contains the value type (devirtualized) representation of a Pokemon for hot loops.
+
+/*
+ * Combatant -- Devirtualized Pokemon for Pokemon Battle Simulation
+ *
+ * The `Pokemon` hierarchy stays the interactive-facing API. For simulation, a Pokemon can be
+ * converted into a `Combatant`: an 8 byte, type-tagged value with no vtable and no heap
+ * memory. Combatants live in contiguous containers (`vector<Combatant>`) and every stat is
+ * found with a switch on the type tag, so the whole battle loop below can be inlined.
+ *
+ * Stats come from the compile time tables in matchup.h, which are built from the same
+ * constants the `Fire`/`Water`/`Grass` constructors use.
+ */
+
+#ifndef COMBATANT_H
+#define COMBATANT_H
+
+#include "matchup.h"
+#include <cstdint>
+
+/* This struct is a Pokemon as a plain value: its type and its health. */
+struct Combatant
+{
+	int32_t type;		//FIRE, WATER or GRASS.
+	int32_t health;		//current health.
+};
+
+//converts a Pokemon into its value form.
+inline Combatant to_combatant(const Pokemon & pokemon)
+{
+	return Combatant{pokemon.get_type(), pokemon.get_health()};
+}
+
+//converts a whole roster, keeping the order.
+inline vector<Combatant> to_combatants(const vector<Pokemon *> & roster)
+{
+	vector<Combatant> out;
+	out.reserve(roster.size());
+	for (const Pokemon * pokemon : roster)
+		if (pokemon)
+			out.push_back(to_combatant(*pokemon));
+	return out;
+}
+
+//damage an action deals, dispatched with a switch instead of a virtual call.
+inline int combatant_power(const Combatant & attacker, int action)
+{
+	switch (attacker.type)
+	{
+		case FIRE:	return action == ATTACK ? type_attack(FIRE) : type_special(FIRE);
+		case WATER:	return action == ATTACK ? type_attack(WATER) : type_special(WATER);
+		case GRASS:	return action == ATTACK ? type_attack(GRASS) : type_special(GRASS);
+	}
+	return 0;
+}
+
+//damage blocked when defending.
+inline int combatant_defend(const Combatant & defender)
+{
+	switch (defender.type)
+	{
+		case FIRE:	return type_defend(FIRE);
+		case WATER:	return type_defend(WATER);
+		case GRASS:	return type_defend(GRASS);
+	}
+	return 0;
+}
+
+//one action from attacker to defender, returns the damage dealt.
+inline int combatant_strike(const Combatant & attacker, Combatant & defender, int action)
+{
+	int damage = combatant_power(attacker, action) - combatant_defend(defender);
+	if (damage < 0) damage = 0;
+	defender.health -= damage;
+	if (defender.health < 0) defender.health = 0;
+	return damage;
+}
+
+/* Plays a battle on two combatants with the same rules as Battle_engine.
+ * `choose(self, opponent, turn)` is any callable returning ATTACK or SPECIAL;
+ * it is a template parameter so it inlines too.
+ */
+template <typename First_chooser, typename Second_chooser>
+inline Battle_result combatant_battle(Combatant & first, Combatant & second, First_chooser first_choose,
+	Second_chooser second_choose, int max_turns = DEFAULT_MAX_TURNS)
+{
+	Battle_result result{0, 0, 0, 0};
+	if (first.health <= 0 || second.health <= 0)
+	{
+		result.winner = first.health > 0 ? 1 : second.health > 0 ? 2 : 0;
+		return result;
+	}
+	while (result.turns < max_turns)
+	{
+		++result.turns;
+		result.damage_to_second += combatant_strike(first, second, first_choose(first, second, result.turns - 1));
+		if (second.health <= 0)
+		{
+			result.winner = 1;
+			return result;
+		}
+		result.damage_to_first += combatant_strike(second, first, second_choose(second, first, result.turns - 1));
+		if (first.health <= 0)
+		{
+			result.winner = 2;
+			return result;
+		}
+	}
+	return result;
+}
+
+//plays a battle where each side always uses the same action (winner -1 for a bad type or action code).
+inline Battle_result combatant_battle(Combatant & first, Combatant & second, int first_action, int second_action,
+	int max_turns = DEFAULT_MAX_TURNS)
+{
+	if (first.type < FIRE || first.type > GRASS || second.type < FIRE || second.type > GRASS
+		|| (first_action != ATTACK && first_action != SPECIAL) || (second_action != ATTACK && second_action != SPECIAL))
+	{
+		return Battle_result{-1, 0, 0, 0};	//the codes index DAMAGE: nothing outside it.
+	}
+	if (first.health > 0 && second.health > 0
+		&& DAMAGE[first.type - 1][first_action - 1][second.type - 1] == 0
+		&& DAMAGE[second.type - 1][second_action - 1][first.type - 1] == 0)
+	{
+		return Battle_result{0, max_turns, 0, 0};	//nobody can win.
+	}
+	auto fixed_first = [first_action](const Combatant &, const Combatant &, int) { return first_action; };
+	auto fixed_second = [second_action](const Combatant &, const Combatant &, int) { return second_action; };
+	return combatant_battle(first, second, fixed_first, fixed_second, max_turns);
+}
+
+#endif
@@ -0,0 +1,512 @@
+// Author: Pokemon Battle contributors
+// Date: 10-17-2026
+//
+// This file contains the implementation for the Concurrent_roster class.
+
+/*
+ * Overview:
+ * - The list follows the lock-free skip list of Herlihy and Shavit (after Fraser): a node
+ *   is in the set once it is linked on level 0, and removed once its level 0 next pointer
+ *   is marked; the upper levels are only shortcuts.
+ * - Remove marks a node's levels from the top down, and whoever marks level 0 owns the
+ *   removal. It then searches for the key once more, which unlinks the node on every level,
+ *   before retiring it.
+ * - An insert still linking the upper levels can race a remove and link a marked node back
+ *   in after that search (and after it was retired). So after linking a level, insert checks
+ *   for the mark and searches again if it is there, which unlinks it before the insert leaves.
+ *   Meanwhile a thread that entered one epoch later can walk onto the node, so retired nodes
+ *   wait three epochs, not two: the inserter entered no later than the retiring epoch e,
+ *   holds the epoch at e + 1 at most, and anyone who saw the node back in entered by e + 1.
+ * - Epochs: a thread enters by copying the global epoch into a free slot and leaves by
+ *   clearing it. The global epoch only moves on when every occupied slot has seen the current
+ *   one. Retired nodes sit in the retiring slot's list and are freed RETIRE_EPOCHS later.
+ * - Collection: a thread tries to move the epoch on and collects its slot every RETIRE_BATCH
+ *   retirements and every COLLECT_EVERY guards it leaves; on the latter it also helps one idle
+ *   slot (taking it like enter() does, so nobody else touches its list meanwhile). Lists are
+ *   tied to slots, not threads, so a thread that stops removing, or stops altogether, doesn't
+ *   keep its nodes: whoever takes or helps the slot frees them.
+ * - A thread that finds every slot taken enters uncounted (crowded). While any is inside,
+ *   try_advance() leaves the epoch alone, which protects them like an announced epoch would;
+ *   their retired nodes go in one list under a mutex. This only happens with more than
+ *   EPOCH_SLOTS threads inside at once.
+ */
+
+#include "concurrent_roster.h"
+#include <new>
+#include <thread>
+
+const uintptr_t MARK = 1;		//low bit of a next pointer: this node is removed.
+const int RETIRE_BATCH = 64;		//retirements between attempts to advance the epoch.
+const int COLLECT_EVERY = 256;		//guards a slot leaves between collections (and helping an idle slot).
+const int CROWDED = -1;			//the slot of a thread that found every slot taken.
+const uint64_t RETIRE_EPOCHS = 3;	//epochs a retired node waits (two, plus one for a node linked back in).
+
+//true if the next pointer carries the removed mark.
+static inline bool is_marked(uintptr_t next)
+{
+	return next & MARK;
+}
+
+//the slot a thread tries first, so threads mostly keep to their own.
+static int home_slot()
+{
+	static atomic<int> threads(0);
+	thread_local int slot = threads.fetch_add(1, memory_order_relaxed) % EPOCH_SLOTS;
+	return slot;
+}
+
+
+/****** GUARD ******/
+
+/* This class keeps the calling thread inside an epoch for its lifetime. */
+class Concurrent_roster::Guard
+{
+	public:
+		Guard(const Concurrent_roster & roster): roster(const_cast<Concurrent_roster &>(roster)), slot(this->roster.enter())
+		{}
+		~Guard()
+		{
+			roster.leave(slot);
+		}
+		Concurrent_roster & roster;	//whose epoch.
+		int slot;			//the slot taken.
+};
+
+
+/****** CONCURRENT ROSTER IMPLEMENTATION ******/
+
+//empty list: head and tail sentinels linked on every level.
+Concurrent_roster::Concurrent_roster(): epoch(1), entries(0), waiting(0), crowded(0), next_help(0)
+{
+	head = new_node(0, nullptr, SKIP_MAX_LEVEL);
+	tail = new_node(UINT64_MAX, nullptr, SKIP_MAX_LEVEL);
+	for (int level = 0; level < SKIP_MAX_LEVEL; ++level)
+		head->next[level].store(reinterpret_cast<uintptr_t>(tail), memory_order_relaxed);
+	for (Epoch_slot & slot : slots)
+	{
+		slot.taken.store(0, memory_order_relaxed);
+		slot.epoch.store(0, memory_order_relaxed);
+		slot.queued.store(0, memory_order_relaxed);
+		slot.operations = 0;
+	}
+}
+
+//frees every node still linked and every node still waiting.
+Concurrent_roster::~Concurrent_roster()
+{
+	Node * node = head;
+	while (node)
+	{
+		Node * next = node == tail ? nullptr : node_of(node->next[0].load(memory_order_relaxed));
+		free_node(node);
+		node = next;
+	}
+	for (Epoch_slot & slot : slots)
+		for (pair<uint64_t, Node *> & retired : slot.retired)
+			free_node(retired.second);
+	for (pair<uint64_t, Node *> & retired : crowded_retired)
+		free_node(retired.second);
+}
+
+//a next pointer without its mark.
+Concurrent_roster::Node * Concurrent_roster::node_of(uintptr_t next)
+{
+	return reinterpret_cast<Node *>(next & ~MARK);
+}
+
+//an unlinked node with room for height next pointers.
+Concurrent_roster::Node * Concurrent_roster::new_node(uint64_t key, Pokemon * value, int height)
+{
+	void * memory = ::operator new(sizeof(Node) + size_t(height - 1) * sizeof(atomic<uintptr_t>));
+	Node * node = static_cast<Node *>(memory);
+	node->key = key;
+	node->value = value;
+	new (&node->locked) atomic<bool>(false);
+	node->height = height;
+	for (int level = 0; level < height; ++level)
+		new (&node->next[level]) atomic<uintptr_t>(0);
+	return node;
+}
+
+//the node and its Pokemon.
+void Concurrent_roster::free_node(Node * node)
+{
+	delete node->value;
+	::operator delete(node);
+}
+
+//1 + the number of heads in a row from a per thread xorshift.
+int Concurrent_roster::random_height()
+{
+	thread_local uint64_t state = RNG::mix(uint64_t(home_slot()) + 1) | 1;
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	int height = 1;
+	uint64_t bits = state;
+	while (height < SKIP_MAX_LEVEL && (bits & 1))
+	{
+		++height;
+		bits >>= 1;
+	}
+	return height;
+}
+
+//takes a free slot (starting at the thread's own) and announces the current epoch in it. One
+//pass over the slots at most: if all are taken, the thread goes in uncounted, which holds the
+//epoch still until it leaves.
+int Concurrent_roster::enter()
+{
+	int slot = home_slot();
+	for (int tried = 0; tried < EPOCH_SLOTS; ++tried, slot = (slot + 1) % EPOCH_SLOTS)
+	{
+		int expected = 0;
+		if (!slots[slot].taken.compare_exchange_strong(expected, 1, memory_order_acquire))
+			continue;
+		uint64_t seen;
+		do
+		{
+			seen = epoch.load();
+			slots[slot].epoch.store(seen);
+		}
+		while (seen != epoch.load());
+		return slot;
+	}
+	crowded.fetch_add(1);
+	return CROWDED;
+}
+
+//clears the announcement; every COLLECT_EVERY guards, moves the epoch on, frees the slot's old
+//nodes and helps an idle slot before letting the slot go.
+void Concurrent_roster::leave(int slot)
+{
+	if (slot == CROWDED)
+	{
+		crowded.fetch_sub(1);
+		return;
+	}
+	Epoch_slot & mine = slots[slot];
+	mine.epoch.store(0, memory_order_release);
+	if (++mine.operations >= COLLECT_EVERY)
+	{
+		mine.operations = 0;
+		try_advance();
+		if (mine.queued.load(memory_order_relaxed) > 0)
+			collect(slot);
+		help(1);
+	}
+	mine.taken.store(0, memory_order_release);
+}
+
+//queues the node; every RETIRE_BATCH nodes, tries to move the epoch on and frees what it can.
+void Concurrent_roster::retire(int slot, Node * node)
+{
+	waiting.fetch_add(1, memory_order_relaxed);
+	if (slot == CROWDED)
+	{
+		lock_guard<mutex> hold(crowded_lock);
+		crowded_retired.push_back({epoch.load(), node});
+		return;
+	}
+	vector<pair<uint64_t, Node *>> & retired = slots[slot].retired;
+	retired.push_back({epoch.load(), node});
+	slots[slot].queued.store(int(retired.size()), memory_order_relaxed);
+	if (retired.size() % RETIRE_BATCH != 0)
+		return;
+	try_advance();
+	collect(slot);
+}
+
+//moves the epoch on by one if every thread inside a guard has seen the current one and none
+//is inside uncounted.
+void Concurrent_roster::try_advance()
+{
+	uint64_t current = epoch.load();
+	if (crowded.load() != 0)
+		return;
+	for (const Epoch_slot & other : slots)
+	{
+		uint64_t seen = other.epoch.load();
+		if (seen != 0 && seen != current)
+			return;
+	}
+	epoch.compare_exchange_strong(current, current + 1);
+}
+
+//frees the slot's nodes retired at least RETIRE_EPOCHS epochs ago (the caller holds the slot).
+void Concurrent_roster::collect(int slot)
+{
+	vector<pair<uint64_t, Node *>> & retired = slots[slot].retired;
+	uint64_t current = epoch.load();
+	size_t kept = 0;
+	for (pair<uint64_t, Node *> & entry : retired)
+	{
+		if (entry.first + RETIRE_EPOCHS <= current)
+		{
+			free_node(entry.second);
+			waiting.fetch_sub(1, memory_order_relaxed);
+		}
+		else
+			retired[kept++] = entry;
+	}
+	retired.resize(kept);
+	slots[slot].queued.store(int(kept), memory_order_relaxed);
+}
+
+//the same for nodes retired by threads without a slot.
+void Concurrent_roster::collect_crowded()
+{
+	lock_guard<mutex> hold(crowded_lock);
+	uint64_t current = epoch.load();
+	size_t kept = 0;
+	for (pair<uint64_t, Node *> & entry : crowded_retired)
+	{
+		if (entry.first + RETIRE_EPOCHS <= current)
+		{
+			free_node(entry.second);
+			waiting.fetch_sub(1, memory_order_relaxed);
+		}
+		else
+			crowded_retired[kept++] = entry;
+	}
+	crowded_retired.resize(kept);
+}
+
+//takes free slots that still have nodes queued, from a rotating start, and collects them; a
+//slot in use is its owner's to collect. Also collects the crowded list. Returns slots collected.
+int Concurrent_roster::help(int most)
+{
+	int start = next_help.fetch_add(1, memory_order_relaxed);
+	int helped = 0;
+	for (int i = 0; i < EPOCH_SLOTS && helped < most; ++i)
+	{
+		Epoch_slot & other = slots[(start + i) % EPOCH_SLOTS];
+		int expected = 0;
+		if (other.queued.load(memory_order_relaxed) == 0
+			|| !other.taken.compare_exchange_strong(expected, 1, memory_order_acquire))
+			continue;
+		collect(int(&other - slots));
+		other.taken.store(0, memory_order_release);
+		++helped;
+	}
+	bool any;
+	{
+		lock_guard<mutex> hold(crowded_lock);
+		any = !crowded_retired.empty();
+	}
+	if (any)
+		collect_crowded();
+	return helped;
+}
+
+//fills preds and succs with the nodes around key on every level, unlinking marked nodes
+//on the way (and starting over if another thread changed a pred under it).
+int Concurrent_roster::find(uint64_t key, Node ** preds, Node ** succs) const
+{
+	while (true)
+	{
+		bool retry = false;
+		Node * pred = head;
+		Node * curr = nullptr;
+		for (int level = SKIP_MAX_LEVEL - 1; level >= 0 && !retry; --level)
+		{
+			curr = node_of(pred->next[level].load());
+			while (true)
+			{
+				uintptr_t succ = curr->next[level].load();
+				while (curr != tail && is_marked(succ))
+				{
+					uintptr_t expected = reinterpret_cast<uintptr_t>(curr);
+					if (!pred->next[level].compare_exchange_strong(expected, succ & ~MARK))
+					{
+						retry = true;
+						break;
+					}
+					curr = node_of(succ);
+					succ = curr->next[level].load();
+				}
+				if (retry || curr->key >= key)
+					break;
+				pred = curr;
+				curr = node_of(succ);
+			}
+			preds[level] = pred;
+			succs[level] = curr;
+		}
+		if (!retry)
+			return curr != tail && curr->key == key;
+	}
+}
+
+//the first node with a key >= key that isn't removed; reads only.
+Concurrent_roster::Node * Concurrent_roster::first_at_least(uint64_t key) const
+{
+	Node * pred = head;
+	Node * curr = nullptr;
+	for (int level = SKIP_MAX_LEVEL - 1; level >= 0; --level)
+	{
+		curr = node_of(pred->next[level].load());
+		while (curr != tail && curr->key < key)
+		{
+			pred = curr;
+			curr = node_of(curr->next[level].load());
+		}
+	}
+	while (curr != tail && is_marked(curr->next[0].load()))
+		curr = node_of(curr->next[0].load());
+	return curr;
+}
+
+//links the Pokemon on level 0 (which makes it visible), then on its upper levels.
+int Concurrent_roster::insert(Pokemon * to_add)
+{
+	if (!to_add)
+		return 0;
+	Guard guard(*this);
+	uint64_t key = Roster::key_of(to_add);
+	int height = random_height();
+	Node * preds[SKIP_MAX_LEVEL];
+	Node * succs[SKIP_MAX_LEVEL];
+	Node * node = nullptr;
+	while (true)
+	{
+		if (find(key, preds, succs))
+		{
+			if (node)
+			{
+				node->value = nullptr;	//the caller keeps it.
+				free_node(node);
+			}
+			return 0;
+		}
+		if (!node)
+			node = new_node(key, to_add, height);
+		for (int level = 0; level < height; ++level)
+			node->next[level].store(reinterpret_cast<uintptr_t>(succs[level]), memory_order_relaxed);
+		uintptr_t expected = reinterpret_cast<uintptr_t>(succs[0]);
+		if (preds[0]->next[0].compare_exchange_strong(expected, reinterpret_cast<uintptr_t>(node)))
+			break;
+	}
+	entries.fetch_add(1, memory_order_relaxed);
+
+	for (int level = 1; level < height; ++level)
+	{
+		while (true)
+		{
+			uintptr_t next = node->next[level].load();
+			if (is_marked(next))
+				return 1;	//removed already: stop linking.
+			if (node_of(next) != succs[level] && !node->next[level].compare_exchange_strong(next, reinterpret_cast<uintptr_t>(succs[level])))
+				continue;
+			uintptr_t expected = reinterpret_cast<uintptr_t>(succs[level]);
+			if (preds[level]->next[level].compare_exchange_strong(expected, reinterpret_cast<uintptr_t>(node)))
+				break;
+			if (!find(key, preds, succs) || succs[0] != node)
+				return 1;	//removed meanwhile.
+		}
+		if (is_marked(node->next[level].load()))
+		{
+			find(key, preds, succs);	//a remove raced us: make sure nothing links the node.
+			return 1;
+		}
+	}
+	return 1;
+}
+
+//marks every level from the top down; whoever marks level 0 unlinks and retires the node.
+int Concurrent_roster::remove(int species_id, uint32_t id)
+{
+	Guard guard(*this);
+	uint64_t key = Roster::make_key(species_id, id);
+	Node * preds[SKIP_MAX_LEVEL];
+	Node * succs[SKIP_MAX_LEVEL];
+	if (!find(key, preds, succs))
+		return 0;
+	Node * node = succs[0];
+	for (int level = node->height - 1; level >= 1; --level)
+	{
+		uintptr_t next = node->next[level].load();
+		while (!is_marked(next))
+			node->next[level].compare_exchange_weak(next, next | MARK);
+	}
+	uintptr_t next = node->next[0].load();
+	while (true)
+	{
+		if (is_marked(next))
+			return 0;	//another thread removed it first.
+		if (node->next[0].compare_exchange_strong(next, next | MARK))
+			break;
+	}
+	entries.fetch_sub(1, memory_order_relaxed);
+	find(key, preds, succs);	//unlinks it on every level.
+	retire(guard.slot, node);
+	return 1;
+}
+
+//runs visit with the node's spinlock held, unless the node is removed.
+int Concurrent_roster::update(Node * node, const Visitor & visit)
+{
+	while (node->locked.exchange(true, memory_order_acquire))
+		while (node->locked.load(memory_order_relaxed))
+			this_thread::yield();
+	int done = !is_marked(node->next[0].load());
+	if (done)
+		visit(*node->value);
+	node->locked.store(false, memory_order_release);
+	return done;
+}
+
+//exactly that Pokemon.
+int Concurrent_roster::update(int species_id, uint32_t id, const Visitor & visit)
+{
+	Guard guard(*this);
+	uint64_t key = Roster::make_key(species_id, id);
+	Node * node = first_at_least(key);
+	if (node == tail || node->key != key)
+		return 0;
+	return update(node, visit);
+}
+
+//the first Pokemon with the name.
+int Concurrent_roster::update(const string & name, const Visitor & visit)
+{
+	int species = Pokemon::species_id(name);
+	if (species < 0)
+		return 0;
+	Guard guard(*this);
+	Node * node = first_at_least(Roster::make_key(species, 0));
+	if (node == tail || node->key >= Roster::make_key(species + 1, 0))
+		return 0;
+	return update(node, visit);
+}
+
+//1 if the Pokemon is linked and not removed.
+int Concurrent_roster::contains(int species_id, uint32_t id) const
+{
+	Guard guard(*this);
+	uint64_t key = Roster::make_key(species_id, id);
+	Node * node = first_at_least(key);
+	return node != tail && node->key == key;
+}
+
+//Pokemon in the roster.
+int Concurrent_roster::size() const
+{
+	return entries.load(memory_order_relaxed);
+}
+
+//removed nodes not freed yet.
+long long Concurrent_roster::pending() const
+{
+	return waiting.load(memory_order_relaxed);
+}
+
+//RETIRE_EPOCHS epochs on (if no thread inside holds them back) and every idle slot collected:
+//with no thread inside, that frees every removed node.
+long long Concurrent_roster::reclaim()
+{
+	for (uint64_t i = 0; i < RETIRE_EPOCHS; ++i)
+		try_advance();
+	help(EPOCH_SLOTS);
+	return pending();
+}
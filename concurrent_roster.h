@@ -0,0 +1,102 @@
+// Author: Pokemon Battle contributors
+// Date: 10-17-2026
+//
+// This file contains the class declarations for the roster that many threads can share.
+
+/*
+ * Concurrent Roster for Pokemon Battle Simulation
+ *
+ * `Concurrent_roster` holds one trainer's Pokemon for many threads at once: battle workers
+ * look Pokemon up and change them while an admin thread adds and removes entries. It is a
+ * lock-free skip list keyed like `Roster`, on (species id, instance id) packed in 64 bits.
+ * - Lookups never lock or write. Insert and remove link and unlink with compare-and-swap;
+ *   a removed node is first marked (the low bit of its next pointers), and searches unlink
+ *   marked nodes they pass.
+ * - Nobody gets a raw pointer into the list. update() runs a function on the Pokemon while
+ *   holding that node's spinlock, so two updates of the same Pokemon never overlap.
+ * - Removed nodes (and their Pokemon) are freed by epoch based reclamation: every operation
+ *   runs inside an epoch guard, and a node retired in epoch e is only freed once the epoch
+ *   reaches e + 3 (one more than usual, for a node a racing insert linked back in), so nobody
+ *   can still be looking at it. Every thread moves the epoch on and frees its slot's old nodes
+ *   now and then as it leaves a guard, and drains the list of an idle slot whose thread went
+ *   quiet; reclaim() does all of that at once for quiet moments.
+ * - More than EPOCH_SLOTS threads inside at once don't wait for a slot: the extra ones go in
+ *   uncounted, and the epoch holds still until they are out.
+ */
+
+#ifndef CONCURRENT_ROSTER_H
+#define CONCURRENT_ROSTER_H
+
+#include "data_structures.h"
+#include <atomic>
+#include <functional>
+#include <mutex>
+
+const int SKIP_MAX_LEVEL = 24;		//enough levels for 2^24 entries at p = 1/2.
+const int EPOCH_SLOTS = 128;		//threads that can be inside a guard at once with a slot of their own.
+
+/* This class is a lock-free skip list of Pokemon that any number of threads can share. */
+class Concurrent_roster
+{
+	public:
+		typedef function<void(Pokemon &)> Visitor;
+
+		Concurrent_roster();
+		~Concurrent_roster();		// Frees everything (no other thread may still use it)
+		Concurrent_roster(const Concurrent_roster &) = delete;
+		Concurrent_roster & operator=(const Concurrent_roster &) = delete;
+		int insert(Pokemon * to_add);	// Takes a heap Pokemon: 1 = added, 0 = nullptr or already there (not taken)
+		int remove(int species_id, uint32_t id);	// 1 = removed (freed once no thread can see it), 0 = none
+		int update(int species_id, uint32_t id, const Visitor & visit);	// Runs visit on it under its lock: 1 = done, 0 = none
+		int update(const string & name, const Visitor & visit);	// Same, for the first Pokemon with the name
+		int contains(int species_id, uint32_t id) const;	// 1 if it is there
+		int size() const;		// Pokemon in the roster (exact when nothing is running)
+		long long pending() const;	// Removed nodes waiting to be freed
+		long long reclaim();		// Moves the epoch on and frees what nobody can see, returns pending() (for quiet moments)
+	private:
+		struct Node
+		{
+			uint64_t key;			//(species id, instance id), as in Roster.
+			Pokemon * value;		//owned.
+			atomic<bool> locked;		//held while update() runs.
+			int height;			//levels this node is linked on.
+			atomic<uintptr_t> next[1];	//height successors, low bit set once removed.
+		};
+		struct alignas(64) Epoch_slot
+		{
+			atomic<int> taken;		//1 while a thread holds the slot.
+			atomic<uint64_t> epoch;		//epoch seen on entry, 0 when outside.
+			vector<pair<uint64_t, Node *>> retired;	//removed nodes and the epoch they left in.
+			atomic<int> queued;		//nodes in retired, for helpers to see.
+			int operations;			//guards left since the last collection.
+		};
+		class Guard;
+
+		Node * head;			//key 0, every level.
+		Node * tail;			//key max, every level.
+		atomic<uint64_t> epoch;		//global epoch, starts at 1.
+		atomic<int> entries;		//Pokemon linked.
+		atomic<long long> waiting;	//retired nodes not freed yet.
+		Epoch_slot slots[EPOCH_SLOTS];	//one per thread inside a guard.
+		atomic<int> crowded;		//threads inside without a slot (every one was taken).
+		atomic<int> next_help;		//where help() starts looking.
+		mutex crowded_lock;		//guards crowded_retired.
+		vector<pair<uint64_t, Node *>> crowded_retired;	//nodes removed by threads without a slot.
+
+		static Node * node_of(uintptr_t next);	//a next pointer without its mark.
+		static Node * new_node(uint64_t key, Pokemon * value, int height);	//unlinked node.
+		static void free_node(Node * node);	//the node and its Pokemon.
+		static int random_height();	//1 + geometric(1/2), per thread random.
+		int find(uint64_t key, Node ** preds, Node ** succs) const;	//1 if key is linked; unlinks marked nodes on the way.
+		Node * first_at_least(uint64_t key) const;	//the first live node >= key (no unlinking).
+		int update(Node * node, const Visitor & visit);	//runs visit under the node's lock.
+		void retire(int slot, Node * node);	//frees it once no guard can see it.
+		void collect(int slot);		//frees this slot's nodes from RETIRE_EPOCHS back.
+		void collect_crowded();		//the same for the nodes of threads without a slot.
+		void try_advance();		//moves the epoch on if every thread inside has seen it.
+		int help(int most);		//collects up to most idle slots with nodes waiting, returns how many.
+		int enter();			//takes a slot and announces the epoch, returns the slot (CROWDED if none was free).
+		void leave(int slot);		//gives the slot back, collecting now and then.
+};
+
+#endif
@@ -1,7 +1,7 @@
 // Author: Harshiv Mistry
 // Date: 10-29-2024
 //
-// This file contains the class declerations that manage the data structures for this project -- Node class, & BST class.
+// This file contains the class declerations that manage the data structures for this project -- Node class, BST class, & Roster class.
 
 /*
  * BST Tree Implementation for Pokemon Battle Simulation
@@ -10,16 +10,32 @@
  * - `Node` represents individual nodes in the BST tree. Each node holds up to two Pokémon pointers and three child pointers.
  *   It includes getters, setters, and a custom copy constructor for managing data and children pointers.
  * - `BST` is the main class managing the BST tree structure. It supports insertion, display, and removal of Pokémon nodes.
- *   It also includes a custom copy constructor and recursive functions to manage the tree structure.
+ *   It also includes a custom copy constructor and iterative functions to manage the tree structure
+ *   (duplicate names make long chains, deep enough to overflow the stack if it recursed); nodes
+ *   keep a parent pointer so walks need no stack and never modify the tree.
  * 
  * Data organization:
  * - Pokémon data in each `Node` is stored in an array `data[2]`.
  * - Child nodes are stored in an array `child[3]` where `child[0]` is left, `child[1]` is middle, and `child[2]` is right.
  * - The tree sorts data with less values going to the left, greater values going to the right, and in-between values in the middle.
- * 
+ *
+ * `Roster` is the tree trainers keep their teams in: a B-tree of minimum degree ROSTER_DEGREE
+ * keyed on (species id, instance id) packed in 64 bits, with keys, Pokemon and children in
+ * contiguous arrays per node. Nodes and Pokemon come from `Roster_pool`s the roster owns.
+ * Rosters are persistent: a copy or snapshot() is O(1) and shares nodes, which are reference
+ * counted and copied on write. Next to the tree, a `Roster_index` hash answers point lookups,
+ * `Health_counts` and `Health_index` answer health queries, subtree counts give select and
+ * rank, and per species counts back complete() and suggest().
+ * `BST` is kept as the old baseline (bench.cpp compares the two).
  */
 
+#ifndef DATA_STRUCTURES_H
+#define DATA_STRUCTURES_H
+
 #include "pokemon.h"
+#include <atomic>
+#include <iterator>
+#include <mutex>
 
 /* This class represents the node used for the BST in 
  * in this project. 
@@ -33,17 +49,20 @@ class Node
 		Node & operator=(const Node & source);	//only copies data to avoid shallow copy
 		Node *&get_left();                     // Returns the left child pointer
 		Node *&get_right();                    // Returns the right child pointer
+		Node *&get_parent();                   // Returns the parent pointer (nullptr for the root)
 		Pokemon *&get_data();                  // Returns the Pokemon pointer
 
 		void set_left(Node *new_left);         // Sets the left child pointer
 		void set_right(Node *new_right);       // Sets the right child pointer
+		void set_parent(Node *new_parent);     // Sets the parent pointer
 		void set_data(Pokemon *new_data);      // Sets the Pokemon pointer
 
 	private:
 		Pokemon *data;                         // Pointer to Pokemon object
 		Node *left;                            // Pointer to left child
 		Node *right;                           // Pointer to right child
-		void copy(const Pokemon * source);			//copies data.
+		Node *parent;                          // Pointer to parent, so walks need no stack
+		int copy(const Pokemon * source);			//copies data, 0 if the type is unknown.
 };
 
 
@@ -58,19 +77,321 @@ public:
     int display_all() const;               // Displays all Pokemon in the tree
     int remove_all();                      // Removes all Pokemon from the tree
     int remove_specific(const string &name_to_remove); // Removes a specific Pokemon
-    Pokemon *& retrieve(const string &name_to_find); // Retrieves a Pokemon by name
+    int retrieve(const string &name_to_find, Pokemon *&found) const; // Finds a Pokemon by name: 1 = found, 0 = no such name
+    int collect(vector<Pokemon *> &out) const;  // Appends every Pokemon, in order
 
 private:
     Node *root;                            // Root node of the BST
 
-    // Recursive helper functions
-    int insert(Node *&root, Pokemon *to_add);
-    int display_all(Node *root) const;
-    int remove_all(Node *&root);
-    int remove_specific(Node *&root, const string &name_to_remove);
-    Pokemon *& retrieve(Node * root, const string &name_to_find);
-	int copy(Node *& dest, Node * src);
-    // Helper for removing a node
-    Node *find_ios(Node * root) const;   // Finds the node with the minimum value in a subtree
+    // Iterative helper functions
+	int copy(Node * src);                  // Copies src into this empty tree, same shape, in O(n)
+    Node *next_in_order(Node *current) const;    // In-order successor (first node for nullptr), read-only
+};
+
+const int ROSTER_DEGREE = 8;			//minimum degree of the roster B-tree.
+const int ROSTER_MAX_KEYS = 2 * ROSTER_DEGREE - 1;	//entries per node.
+const int ROSTER_MAX_HEIGHT = 12;		//a tree of height h holds >= 2 * 8^(h - 1) - 1 entries, so int sizes stay below 12.
+
+/* This class hands out fixed size slots from chunks it owns. Chunks grow geometrically and
+ * are kept until the pool is destroyed; released slots go on a free list, and reset() makes
+ * every slot free again in O(1) without touching them.
+ */
+class Roster_pool
+{
+	public:
+		Roster_pool(size_t slot_size);	// Slots of at least slot_size bytes
+		~Roster_pool();			// Frees every chunk
+		Roster_pool(const Roster_pool &) = delete;
+		Roster_pool & operator=(const Roster_pool &) = delete;
+		void * allocate();		// One slot (throws bad_alloc like new)
+		void release(void * slot);	// Gives a slot back for reuse
+		void reset();			// Every slot is free again, chunks are kept
+		int chunks() const;		// Chunks allocated so far
+	private:
+		struct Chunk
+		{
+			Chunk * next;		//the chunk allocated after this one.
+			size_t slots;		//slots in this chunk.
+		};
+		size_t slot_size;	//bytes per slot, a multiple of the pointer size.
+		Chunk * first;		//every chunk, in allocation order.
+		Chunk * current;	//the chunk slots are being carved from.
+		char * next_slot;	//next unused slot in current.
+		char * end;		//end of current.
+		void * free_list;	//released slots, linked through their first bytes.
+		int chunk_count;	//chunks allocated so far.
+		static char * slots_of(Chunk * chunk);	//the first slot of a chunk.
+};
+
+/* This struct is one B-tree node: count entries in sorted order, and count + 1 children
+ * unless it is a leaf.
+ */
+struct Roster_node
+{
+	int count;				//entries in use.
+	bool leaf;				//true if it has no children.
+	int total;				//entries in the whole subtree.
+	atomic<int> refs;			//roster roots and parent nodes pointing here.
+	uint64_t keys[ROSTER_MAX_KEYS];		//(species id, instance id) keys, sorted.
+	Pokemon * values[ROSTER_MAX_KEYS];	//the Pokemon, one reference each.
+	Roster_node * children[ROSTER_MAX_KEYS + 1];	//subtrees between the keys.
+	Roster_node(bool leaf);			//one reference, for whoever links it.
+};
+
+class Roster;
+
+/* This class passes health changes on to the roster a Pokemon was last linked into or handed
+ * out by. The store keeps it as long as any of its Pokemon could point at it, and the roster
+ * clears it when it goes, so a Pokemon never tells a roster that is gone.
+ */
+class Roster_watch: public Health_observer
+{
+	public:
+		Roster * roster;	//nullptr once the roster is gone (the watch can be reused).
+		Roster_watch(Roster * roster);
+		void on_health_change(Pokemon & pokemon, int old_health);	// Tells the roster, if any
+};
+
+/* This struct holds the pools a roster and all its snapshots allocate from. Those rosters may
+ * live on different threads, so every use of the pools and the watches takes the lock.
+ */
+struct Roster_store
+{
+	mutex lock;		//guards the pools and the watches.
+	Roster_pool nodes;	//where the nodes live.
+	Roster_pool pokemons;	//where the Pokemon live, each after its reference count.
+	vector<unique_ptr<Roster_watch>> watches;	//one per roster using the store, kept for the Pokemon.
+	Roster_store();
+	Roster_watch * watch(Roster * roster);	//a free watch (or a new one) pointed at the roster.
+	void unwatch(Roster_watch * watch);	//frees the watch for another roster.
+	void * allocate(Roster_pool & pool);	//a slot from one of the pools.
+	void release(Roster_pool & pool, void * slot);	//gives a slot back to its pool.
+	void reset(Roster_pool & pool);	//every slot of the pool is free again.
+	int chunks();		//chunks held by both pools.
+};
+
+/* This class counts Pokemon per health in a Fenwick tree, so range counts, ranks and the k-th
+ * healthiest health are O(log H) for H healths. It doubles to fit the highest health seen.
+ */
+class Health_counts
+{
+	public:
+		Health_counts();			// No Pokemon
+		void add(int health, int change);	// change Pokemon more (or fewer) with the health
+		int count_range(int low, int high) const;	// Pokemon with low <= health <= high
+		int kth_highest(int k) const;		// Health of the k-th healthiest (1 = healthiest), -1 if fewer
+		int total() const;			// Pokemon counted
+		void clear();				// Counts nothing again
+	private:
+		vector<int> tree;		//Fenwick array, tree[i] covers healths (i - lowbit(i), i - 1].
+		int entries;			//Pokemon counted.
+		int count_below(int health) const;	//Pokemon with health < health.
+};
+
+const uint64_t NO_KEY = ~uint64_t(0);		//no roster key packs to this.
+const int INDEX_PAGE_BITS = 10;			//an index page holds up to 2^10 slots (16 KiB).
+const size_t HEALTH_PAGE_ENTRIES = 128;		//most entries in a health index page.
+
+/* This class maps roster keys to Pokemon by open addressing (linear probing, never more than
+ * half full), and remembers the smallest key of each species. Erasing shifts the entries after
+ * it back, so there are no tombstones. Among equal keys it keeps the first one added.
+ * The table is a list of pages; a copy of the index shares them, and either side copies a
+ * page before its first write to it, so copying a big index is cheap and stays cheap.
+ */
+class Roster_index
+{
+	public:
+		Roster_index();				// Empty, with no table yet
+		Pokemon * find(uint64_t key) const;	// The Pokemon under the key, nullptr if none
+		uint64_t first_of(int species_id) const;	// Smallest key of the species, NO_KEY if none
+		void add(uint64_t key, Pokemon * pokemon);	// Adds the key unless it is there (then keeps the old one)
+		void put(uint64_t key, Pokemon * pokemon);	// Adds the key or replaces its Pokemon
+		void erase(uint64_t key);		// Drops the key (not the species first: see set_first)
+		void set_first(int species_id, uint64_t key);	// Sets the smallest key of a species
+		void reserve(size_t count);		// Room for count keys without growing
+		void clear();				// Drops every key and frees the table
+		int size() const;			// Keys in the index
+	private:
+		struct Slot
+		{
+			uint64_t key;		//NO_KEY when empty.
+			Pokemon * pokemon;	//untagged.
+		};
+		typedef shared_ptr<Slot[]> Page;	//page_slots slots, shared with copies of the index.
+		vector<Page> pages;		//the table, capacity slots in all (a power of two, or none).
+		size_t capacity;		//slots in the table.
+		int page_bits;			//log2 of the slots per page.
+		size_t used;			//slots holding a key.
+		int shift;			//64 - log2(capacity), for the multiplicative hash.
+		uint64_t firsts[SPECIES_COUNT];	//smallest key per species.
+		size_t home(uint64_t key) const;	//the slot a key hashes to.
+		size_t slot_of(uint64_t key) const;	//the key's slot, or the empty slot that ends its probe.
+		const Slot & at(size_t slot) const;	//a slot to read.
+		Slot & writable(size_t slot);	//a slot to write, its page copied first if it is shared.
+		void rehash(size_t count);	//moves every key to a table of count slots.
+};
+
+/* This class lists a roster's Pokemon by health, then key (name order), so the Pokemon in a
+ * health range are found in O(log n) and listed in O(k). The entries sit in sorted pages of up
+ * to HEALTH_PAGE_ENTRIES; a page splits when it overflows and joins its neighbour when both
+ * are small. Like the hash index, a copy shares the pages and copies one before writing to it.
+ */
+class Health_index
+{
+	public:
+		struct Entry
+		{
+			int health;		//when it was indexed.
+			uint64_t key;		//the roster key.
+			Pokemon * pokemon;	//the exact Pokemon (copies may share a key).
+		};
+		Health_index();				// Empty
+		void add(int health, uint64_t key, Pokemon * pokemon);	// Indexes it
+		int erase(int health, uint64_t key, const Pokemon * pokemon);	// Drops exactly that entry: 1 = dropped, 0 = none
+		int replace(int health, uint64_t key, const Pokemon * from, Pokemon * to);	// Points the entry at another Pokemon: 1 = done, 0 = none
+		void merge(vector<Entry> & batch);	// Adds a batch at once (sorts it), O(n + b log b)
+		int walk(int low, int high, int limit, vector<Pokemon *> & out) const;	// Appends up to limit in range, by health then key; returns how many
+		void clear();				// Drops every entry
+		int size() const;			// Entries in the index
+	private:
+		typedef shared_ptr<vector<Entry>> Page;	//sorted, never empty, shared with copies of the index.
+		vector<Page> pages;		//in order.
+		vector<Entry> lasts;		//the last entry of every page, so finding a page reads no page.
+		size_t used;			//entries in all pages.
+		size_t page_of(int health, uint64_t key) const;	//the first page whose last entry isn't before (health, key).
+		vector<Entry> & writable(size_t page);	//a page to write, copied first if it is shared.
+		int find(int health, uint64_t key, const Pokemon * pokemon, size_t & page, size_t & at) const;	//where the entry is: 1 = found.
+		void settle(size_t page);	//splits the page if it overflowed, drops it if empty, joins it to a small neighbour.
+};
+
+/* This class is a trainer's team: a persistent B-tree of Pokemon keyed on name. It owns the
+ * Pokemon, together with the rosters it shares them with.
+ */
+class Roster
+{
+	public:
+		/* This class walks a roster in key order, in either direction. The path from the root
+		 * sits in a fixed array, so it never allocates. Any insert or remove invalidates it.
+		 */
+		class iterator
+		{
+			public:
+				using iterator_category = bidirectional_iterator_tag;
+				using value_type = Pokemon *;
+				using difference_type = ptrdiff_t;
+				using pointer = Pokemon * const *;
+				using reference = Pokemon *;	//by value, like the roster's other lookups.
+
+				iterator();				// Past the end of an empty roster
+				reference operator*() const;		// The Pokemon here
+				iterator & operator++();		// Next in key order
+				iterator operator++(int);
+				iterator & operator--();		// Previous (the last one from end())
+				iterator operator--(int);
+				bool operator==(const iterator & other) const;
+				bool operator!=(const iterator & other) const;
+			private:
+				friend class Roster;
+				struct Step
+				{
+					const Roster_node * node;	//a node on the path.
+					int index;		//the entry here (last step) or the child taken (the others).
+				};
+				const Roster_node * root;	//where end() steps back from.
+				Step path[ROSTER_MAX_HEIGHT];	//root first.
+				int depth;			//steps in path, 0 at end().
+				iterator(const Roster_node * root);	//end() of that tree.
+				void descend_first(const Roster_node * node);	//pushes the path to a subtree's first entry.
+				void descend_last(const Roster_node * node);	//pushes the path to a subtree's last entry.
+		};
+		using reverse_iterator = std::reverse_iterator<iterator>;
+
+		Roster();				// Empty roster
+		~Roster();				// Lets go of the store (freed with the last roster sharing it)
+		Roster(const Roster & source);		// O(1) snapshot sharing every node and Pokemon (source must not be in use on another thread)
+		Roster & operator=(const Roster & source);	// O(1) snapshot sharing every node and Pokemon
+		Roster snapshot() const;		// O(1) copy; later writes to either side copy what they touch
+		int insert(Pokemon * to_add);		// Moves a heap Pokemon into the roster and deletes it, returns 1 (0 for nullptr)
+		Pokemon * create(int type);		// A new random Fire, Water or Grass made in the roster (nullptr for a bad type)
+		Pokemon * make(int type);		// Like create, but not linked in yet: pass it to bulk_load
+		int bulk_load(const vector<Pokemon *> & batch, int threads = 1);	// Links Pokemon from make(), returns how many
+		int display_all() const;		// Displays every Pokemon in name order
+		int remove_all();			// Deletes every Pokemon (O(1))
+		int remove_specific(const string & name_to_remove);	// Deletes the first Pokemon with the name: 1 = removed, 0 = none
+		int remove_specific(int species_id, uint32_t id);	// Deletes exactly that Pokemon: 1 = removed, 0 = none
+		int retrieve(const string & name_to_find, Pokemon *& found) const;	// First Pokemon with the name: 1 = found, 0 = none
+		int retrieve(int species_id, uint32_t id, Pokemon *& found) const;	// Exactly that Pokemon: 1 = found, 0 = none
+		int retrieve_for_update(const string & name_to_find, Pokemon *& found);	// Like retrieve, but found is this roster's own copy
+		int retrieve_for_update(int species_id, uint32_t id, Pokemon *& found);	// Like retrieve, but found is this roster's own copy
+		int retrieve_all(const string & name_to_find, vector<Pokemon *> & out) const;	// Appends every Pokemon with the name, returns how many
+		int collect(vector<Pokemon *> & out) const;	// Appends every Pokemon, in order
+		int size() const;			// Pokemon in the roster
+		int height() const;			// Levels in the tree (0 when empty)
+		static uint64_t make_key(int species_id, uint32_t id);	// Packs (species + 1, id); species -1 (unnamed) sorts first
+		static uint64_t key_of(const Pokemon * pokemon);	// The key a Pokemon is stored under
+		int allocated_chunks() const;		// Chunks held by the node and Pokemon pools
+		Pokemon * select(int k) const;		// The k-th Pokemon in name order (from 0), nullptr if out of range; O(log n)
+		int rank(int species_id, uint32_t id) const;	// Pokemon before that key in name order; O(log n)
+		int count_health(int low, int high) const;	// Pokemon with low <= health <= high; O(log H)
+		int health_rank(const Pokemon * pokemon) const;	// Pokemon strictly healthier than it; O(log H)
+		Pokemon * kth_healthiest(int k) const;	// A Pokemon with the k-th highest health (k = 1 is the healthiest; the first in name order among ties), nullptr if none; O(log n)
+		int retrieve_health_range(int low, int high, vector<Pokemon *> & out) const;	// Appends those with health in range, by health then name, returns how many; O(log n + k)
+		int retrieve_attack_range(int low, int high, vector<Pokemon *> & out) const;	// Same for get_attack(); O(species * log n + k)
+		Pokemon * strongest_attacker(int type) const;	// First Pokemon of the type's strongest species here, nullptr if none
+		int count_species(int species_id) const;	// Pokemon of that species, O(1)
+		int complete(const string & prefix, vector<int> & out) const;	// Appends the species here whose name starts with prefix (any case), returns how many
+		int suggest(const string & typed, int most, vector<int> & out) const;	// Appends the species here within most edits of typed, closest first, returns how many
+		int set_indexed(bool on);		// Keeps the hash index (the default) or drops it, so lookups walk the tree; 1 if it changed
+		bool is_indexed() const;		// True while lookups go through the hash index
+		iterator begin() const;			// The first Pokemon in key order
+		iterator end() const;			// Past the last
+		reverse_iterator rbegin() const;	// The last Pokemon
+		reverse_iterator rend() const;		// Before the first
+	private:
+		friend class Roster_watch;
+		Roster_node * root;	//nullptr when empty.
+		int entries;		//Pokemon in the roster.
+		shared_ptr<Roster_store> store;	//pools, shared with snapshots.
+		shared_ptr<Roster_index> hash_index;	//point lookups, shared with snapshots; nullptr when off.
+		shared_ptr<Health_counts> health_counts;	//Pokemon per health, shared with snapshots.
+		shared_ptr<Health_index> health_index;	//Pokemon by health, shared with snapshots.
+		Roster_watch * watch;	//tells this roster about health changes of its Pokemon (lives in the store).
+		int species_counts[SPECIES_COUNT];	//Pokemon per species id.
+
+		static int lower_bound(const Roster_node * node, uint64_t key);	//first entry >= key.
+		static int upper_bound(const Roster_node * node, uint64_t key);	//first entry > key.
+		const Roster_node * first_at_least(uint64_t key, int & index) const;	//node and index of the smallest entry >= key.
+		iterator seek(uint64_t key) const;	//the smallest entry >= key.
+		int remove_key(uint64_t key);	//deletes one Pokemon stored under the key.
+		int add(Pokemon * made);		//links a Pokemon that already lives in the pool.
+		Roster_node * new_node(bool leaf);	//an empty node from the pool.
+		void delete_node(Roster_node * node);	//gives an emptied node of this roster's own back to the pool.
+		Roster_node * own(Roster_node * node);	//the node if this roster holds its only reference, else its copy that is.
+		void unref(Roster_node * node);		//drops a reference; the last one frees the node and drops its children and Pokemon.
+		void unref_pokemon(Pokemon * pokemon);	//drops a reference; the last one frees the Pokemon.
+		void release_tree();			//drops the tree: resets the pools if no roster shares them, else unrefs the root.
+		bool sole_user() const;			//true if no other roster shares the store (so nothing is shared).
+		Roster_index * index_for_write();	//the index, copied first if a snapshot shares it (nullptr when off).
+		Health_counts * counts_for_write();	//the health counts, copied first if a snapshot shares them.
+		Health_index * health_index_for_write();	//the health index, copied first if a snapshot shares it (its pages stay shared).
+		void adopt(Pokemon * pokemon);		//watches a linked Pokemon and counts its health (the caller indexes it).
+		void health_changed(Pokemon & pokemon, int old_health);	//recounts and reindexes it.
+		void move_store(shared_ptr<Roster_store> to);	//switches stores, and watches.
+		static void pull(Roster_node * node);	//recomputes a node's subtree count from its entries and children.
+		void pull_path(Roster_node ** path, int depth);	//pulls the nodes of a path, bottom up.
+		void reindex(uint64_t key);		//brings the index in line with the tree for a key just removed.
+		static atomic<int> & refs_of(const Pokemon * pokemon);	//the reference count in front of a pooled Pokemon.
+		void * pokemon_slot();			//room for a Pokemon in the pool, its count set to one.
+		Pokemon * clone(const Pokemon * source);	//copies a Pokemon into the pool (nullptr if unknown).
+		void split_child(Roster_node * parent, int index);	//splits a full child in two.
+		int fill_child(Roster_node * parent, int index);	//gives a minimal child one more entry, returns its new index.
+		void merge_children(Roster_node * parent, int index);	//joins children index and index + 1.
+		Pokemon * remove_max(Roster_node * node, Roster_node ** path, int & depth);	//unlinks the last entry of a subtree, recording the nodes it passes.
+		Pokemon * remove_min(Roster_node * node, Roster_node ** path, int & depth);	//unlinks the first entry of a subtree, recording the nodes it passes.
+		void shrink_root();			//drops an empty root.
+		Roster_node * build(const pair<uint64_t, Pokemon *> * sorted, size_t count, int height);	//balanced subtree of sorted entries.
 };
 
+Pokemon * clone_pokemon(const Pokemon * source);	//deep copy with the right derived type (nullptr if unknown).
+
+#endif
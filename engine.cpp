@@ -0,0 +1,218 @@
+// Author: Pokemon Battle contributors
+// Date: 10-17-2026
+//
+// This file contains the implementation of the battle engine and the decision policies.
+
+/*
+ * Overview:
+ * - `Policy` and its derived classes pick actions without any input.
+ * - `Battle_engine` holds the state of one battle (side to move, turn, damage totals).
+ *   `act` performs one action; `run` alternates policies until the battle is over.
+ * - Battles without a sink only use `get_attack`/`get_special`/`get_defend`. Battles with
+ *   a sink call `attack`/`special_ability`/`defend` so the Pokemon raise their own events,
+ *   and the engine raises start, damage, faint and win.
+ * - If a `Stream` is bound to the thread, it is moved to the current turn before each
+ *   choice, so random choices are addressed by (seed, battle id, turn).
+ */
+
+#include "engine.h"
+
+/****** POLICY IMPLEMENTATIONS ******/
+
+//destructor
+Policy::~Policy()
+{}
+
+//always attacks.
+int Attack_policy::choose(const Pokemon & self, const Pokemon & opponent, int turn)
+{
+	return ATTACK;
+}
+
+//picks attack or special ability at random.
+int Random_policy::choose(const Pokemon & self, const Pokemon & opponent, int turn)
+{
+	return RNG::random_num(ATTACK, SPECIAL);
+}
+
+//copies the script to play back.
+Scripted_policy::Scripted_policy(const vector<int> & actions): script(actions), next(0)
+{}
+
+//plays back the next scripted action.
+int Scripted_policy::choose(const Pokemon & self, const Pokemon & opponent, int turn)
+{
+	if (next < script.size())
+		return script[next++];
+	return ATTACK;
+}
+
+//starts the script over.
+void Scripted_policy::reset()
+{
+	next = 0;
+}
+
+//stores the callback.
+Callback_policy::Callback_policy(Callback to_call): callback(to_call)
+{}
+
+//asks the callback.
+int Callback_policy::choose(const Pokemon & self, const Pokemon & opponent, int turn)
+{
+	return callback(self, opponent, turn);
+}
+/*** END OF POLICIES ***/
+
+
+
+
+/****** BATTLE_ENGINE IMPLEMENTATION ******/
+
+//sets up a battle, the first Pokemon moves first.
+Battle_engine::Battle_engine(Pokemon * first, Pokemon * second, Battle_events * events)
+	: first(first), second(second), events(events), side(1), max_turns(DEFAULT_MAX_TURNS), done(false),
+	  result{0, 0, 0, 0}
+{
+	if (!first || !second)
+	{
+		if (events)
+			events->on_error("Null Pokemon pointers passed to the battle function!");
+		result.winner = -1;
+		done = true;
+		return;
+	}
+	if (events)
+		events->on_start(*first, *second);
+	if (first->get_health() <= 0 || second->get_health() <= 0)
+	{
+		result.winner = first->get_health() > 0 ? 1 : second->get_health() > 0 ? 2 : 0;
+		done = true;
+	}
+}
+
+//plays the battle to the end, alternating the two policies.
+Battle_result Battle_engine::run(Policy & first_policy, Policy & second_policy)
+{
+	Stream * stream = RNG::current_stream();
+	while (!done)
+	{
+		if (stream && side == 1)
+			stream->set_turn(uint32_t(result.turns));
+		if (side == 1)
+			act(first_policy.choose(*first, *second, result.turns));
+		else
+			act(second_policy.choose(*second, *first, result.turns));
+	}
+	return result;
+}
+
+//the side to move performs the action; returns the winner (0 while running).
+int Battle_engine::act(int action)
+{
+	if (done)
+		return result.winner;
+
+	if (side == 1)
+	{
+		++result.turns;
+		result.damage_to_second += strike(first, second, action);
+		if (second->get_health() <= 0)
+		{
+			if (events)
+			{
+				events->on_faint(*second, *first);
+				events->on_win(*first, 1);
+			}
+			result.winner = 1;
+			done = true;
+			return 1;
+		}
+		side = 2;
+		return 0;
+	}
+
+	result.damage_to_first += strike(second, first, action);
+	if (first->get_health() <= 0)
+	{
+		if (events)
+		{
+			events->on_faint(*first, *second);
+			events->on_win(*second, 2);
+		}
+		result.winner = 2;
+		done = true;
+		return 2;
+	}
+	side = 1;
+	if (result.turns >= max_turns)
+		done = true;	//nobody can win, call it a draw.
+	return 0;
+}
+
+//one action from attacker to defender, returns the damage dealt.
+int Battle_engine::strike(Pokemon * attacker, Pokemon * defender, int action)
+{
+	int power = 0;
+	int blocked = 0;
+	if (events)
+	{
+		if (action == ATTACK)
+			power = attacker->attack(*events);
+		else if (action == SPECIAL)
+			power = attacker->special_ability(*events);
+		blocked = defender->defend(*events);
+	}
+	else
+	{
+		if (action == ATTACK)
+			power = attacker->get_attack();
+		else if (action == SPECIAL)
+			power = attacker->get_special();
+		blocked = defender->get_defend();
+	}
+
+	int damage = power - blocked;
+	if (damage < 0) damage = 0;
+	defender->reduce_health(damage);
+
+	if (events)
+		events->on_damage(*attacker, *defender, damage);
+	return damage;
+}
+
+//1 or 2.
+int Battle_engine::side_to_move() const
+{
+	return side;
+}
+
+//true once the battle is over.
+bool Battle_engine::finished() const
+{
+	return done;
+}
+
+//result so far.
+const Battle_result & Battle_engine::get_result() const
+{
+	return result;
+}
+
+//sets the turn limit.
+void Battle_engine::set_max_turns(int limit)
+{
+	max_turns = limit;
+}
+
+//returns the first Pokemon.
+Pokemon * Battle_engine::get_first() const
+{
+	return first;
+}
+
+//returns the second Pokemon.
+Pokemon * Battle_engine::get_second() const
+{
+	return second;
+}
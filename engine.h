@@ -0,0 +1,121 @@
+// Author: Pokemon Battle contributors
+// Date: 10-17-2026
+//
+// This file contains the class declarations for the headless battle engine and its decision policies.
+
+/*
+ * Headless Battle Engine for Pokemon Battle Simulation
+ *
+ * `Battle_engine` runs the same turn logic as `Stadium::battle` without touching `std::cin`.
+ * Every action is chosen by a `Policy`, and the engine returns a `Battle_result`
+ * (winner, turns, damage totals) instead of only printing.
+ *
+ * - `Policy` is an Abstract Base Class with one pure virtual function -- choose().
+ * - `Attack_policy`, `Random_policy`, `Scripted_policy` and `Callback_policy` are the
+ *   non-interactive policies. The interactive menu is just one more policy (see battle.h).
+ * - The engine can be driven a whole battle at a time (`run`) or one action at a time
+ *   (`act`), which is what servers and search based AIs need.
+ * - Without an event sink the engine only uses the non-printing stat accessors; with
+ *   one (e.g. `Text_events` for the console) it calls the combat methods, which raise
+ *   their events on it.
+ *
+ * Turn order matches `Stadium::battle`: the first Pokemon acts, then (if the second is
+ * still standing) the second Pokemon acts. One turn is one such round.
+ */
+
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include "pokemon.h"
+#include "events.h"
+#include <functional>
+
+const int DEFAULT_MAX_TURNS = 10000;	//turn limit before a battle is called a draw.
+
+/* This struct is what a battle returns. Damage totals are counted after
+ * defending, winner is 1 or 2 (0 if the turn limit was hit, -1 on bad input).
+ */
+struct Battle_result
+{
+	int winner;		//1 = first Pokemon, 2 = second Pokemon, 0 = no winner.
+	int turns;		//rounds started.
+	int damage_to_first;	//total damage dealt to the first Pokemon.
+	int damage_to_second;	//total damage dealt to the second Pokemon.
+};
+
+/* This class is the Abstract Base Class for everything that can pick an action
+ * for a Pokemon (1 = Attack, 2 = Special Ability).
+ */
+class Policy
+{
+	public:
+		virtual ~Policy();	//virtual destructor so the right one gets called for derived class
+		virtual int choose(const Pokemon & self, const Pokemon & opponent, int turn)=0;	//returns ATTACK or SPECIAL.
+};
+
+/* This class always attacks. */
+class Attack_policy: public Policy
+{
+	public:
+		int choose(const Pokemon & self, const Pokemon & opponent, int turn);
+};
+
+/* This class picks uniformly at random, through the shared RNG subsystem
+ * (so it follows --seed and any bound Stream).
+ */
+class Random_policy: public Policy
+{
+	public:
+		int choose(const Pokemon & self, const Pokemon & opponent, int turn);
+};
+
+/* This class plays back a fixed list of actions, then attacks once the list runs out. */
+class Scripted_policy: public Policy
+{
+	public:
+		Scripted_policy(const vector<int> & actions);	//copies the script.
+		int choose(const Pokemon & self, const Pokemon & opponent, int turn);
+		void reset();	//starts the script over.
+	private:
+		vector<int> script;	//the actions to play back.
+		size_t next;		//index of the next action.
+};
+
+/* This class forwards the choice to a callback (e.g. an AI). */
+class Callback_policy: public Policy
+{
+	public:
+		typedef function<int(const Pokemon &, const Pokemon &, int)> Callback;
+		Callback_policy(Callback to_call);	//stores the callback.
+		int choose(const Pokemon & self, const Pokemon & opponent, int turn);
+	private:
+		Callback callback;	//called for every choice.
+};
+
+/* This class runs one battle between two Pokemon. It never reads input or writes
+ * output; everything that happens is raised on the optional event sink.
+ */
+class Battle_engine
+{
+	public:
+		Battle_engine(Pokemon * first, Pokemon * second, Battle_events * events = nullptr);	//does not take ownership.
+		Battle_result run(Policy & first_policy, Policy & second_policy);	//plays the battle to the end.
+		int act(int action);	//the side to move performs the action, returns the winner (0 while running).
+		int side_to_move() const;	//1 or 2.
+		bool finished() const;	//true once a Pokemon fainted or the turn limit was hit.
+		const Battle_result & get_result() const;	//result so far.
+		void set_max_turns(int limit);	//turn limit (battles of two 0 damage actions never end).
+		Pokemon * get_first() const;	//first Pokemon.
+		Pokemon * get_second() const;	//second Pokemon.
+	private:
+		Pokemon * first;	//first Pokemon (acts first every turn).
+		Pokemon * second;	//second Pokemon.
+		Battle_events * events;	//where events go (nullptr = nowhere).
+		int side;		//side to move.
+		int max_turns;		//turn limit.
+		bool done;		//battle over.
+		Battle_result result;	//running result.
+		int strike(Pokemon * attacker, Pokemon * defender, int action);	//one action, returns damage dealt.
+};
+
+#endif
@@ -0,0 +1,215 @@
+// Author: Pokemon Battle contributors
+// Date: 10-17-2026
+//
+// This file contains the implementation of the battle event sinks.
+
+/*
+ * Overview:
+ * - `Text_events` produces the same lines `Stadium::battle` and the combat methods used to
+ *   print, but appends them to a string with '\n' instead of flushing every line with endl.
+ *   The buffer is written out on `flush()`, when it passes its size limit, and on destruction.
+ * - `Counting_events` is plain integer bookkeeping.
+ */
+
+#include "events.h"
+#include "pokemon.h"
+
+/****** BATTLE_EVENTS IMPLEMENTATION ******/
+
+//destructor
+Battle_events::~Battle_events()
+{}
+
+//nothing is buffered by default.
+void Battle_events::flush()
+{}
+
+
+/****** NULL_EVENTS IMPLEMENTATION ******/
+
+void Null_events::on_start(const Pokemon & first, const Pokemon & second) {}
+void Null_events::on_attack(const Pokemon & attacker, int action, const char * move, int power) {}
+void Null_events::on_defend(const Pokemon & defender, const char * move, int blocked) {}
+void Null_events::on_damage(const Pokemon & attacker, const Pokemon & defender, int damage) {}
+void Null_events::on_faint(const Pokemon & fainted, const Pokemon & winner) {}
+void Null_events::on_win(const Pokemon & winner, int side) {}
+void Null_events::on_error(const char * message) {}
+
+
+/****** TEXT_EVENTS IMPLEMENTATION ******/
+
+//sets where the text goes and how much to buffer.
+Text_events::Text_events(ostream & out, ostream & err, size_t limit): out(out), err(err), limit(limit)
+{
+	buffer.reserve(limit < 4096 ? limit : 4096);
+}
+
+//writes out whatever is left.
+Text_events::~Text_events()
+{
+	flush();
+}
+
+//"--- Battle Beins ---" and who is fighting.
+void Text_events::on_start(const Pokemon & first, const Pokemon & second)
+{
+	buffer += "\n--- Battle Beins ---\n";
+	buffer += first.get_name();
+	buffer += " (Health: ";
+	append(first.get_health());
+	buffer += ") vs. ";
+	buffer += second.get_name();
+	buffer += " (Health: ";
+	append(second.get_health());
+	buffer += ")\n";
+	maybe_flush();
+}
+
+//the move itself, then the stadium's line about it.
+void Text_events::on_attack(const Pokemon & attacker, int action, const char * move, int power)
+{
+	buffer += attacker.get_name();
+	buffer += ' ';
+	buffer += move;
+	buffer += '\n';
+	buffer += attacker.get_name();
+	buffer += action == ATTACK ? " attacks!\n" : " uses its special ability!\n";
+	maybe_flush();
+}
+
+//the defending move.
+void Text_events::on_defend(const Pokemon & defender, const char * move, int blocked)
+{
+	buffer += defender.get_name();
+	buffer += ' ';
+	buffer += move;
+	buffer += '\n';
+	maybe_flush();
+}
+
+//how much damage was dealt and what is left.
+void Text_events::on_damage(const Pokemon & attacker, const Pokemon & defender, int damage)
+{
+	buffer += attacker.get_name();
+	buffer += " dealt ";
+	append(damage);
+	buffer += " damage to ";
+	buffer += defender.get_name();
+	buffer += ".\n";
+	buffer += defender.get_name();
+	buffer += " (Remaining Health: ";
+	append(defender.get_health());
+	buffer += ")\n";
+	maybe_flush();
+}
+
+//who fainted and who won.
+void Text_events::on_faint(const Pokemon & fainted, const Pokemon & winner)
+{
+	buffer += fainted.get_name();
+	buffer += " fainted! ";
+	buffer += winner.get_name();
+	buffer += " wins the battle!\n";
+	maybe_flush();
+}
+
+//the faint line already said it all.
+void Text_events::on_win(const Pokemon & winner, int side)
+{}
+
+//errors go straight to the error stream.
+void Text_events::on_error(const char * message)
+{
+	flush();
+	err << "Error: " << message << endl;
+}
+
+//writes the buffer out in one go.
+void Text_events::flush()
+{
+	if (!buffer.empty())
+	{
+		out.write(buffer.data(), streamsize(buffer.size()));
+		out.flush();
+		buffer.clear();
+	}
+}
+
+//appends a number without going through a stream.
+void Text_events::append(int value)
+{
+	char digits[12];
+	int length = 0;
+	unsigned magnitude = value < 0 ? 0u - unsigned(value) : unsigned(value);
+	do
+	{
+		digits[length++] = char('0' + magnitude % 10);
+		magnitude /= 10;
+	} while (magnitude);
+	if (value < 0)
+		buffer += '-';
+	while (length)
+		buffer += digits[--length];
+}
+
+//flushes once the buffer is over its limit.
+void Text_events::maybe_flush()
+{
+	if (buffer.size() >= limit)
+		flush();
+}
+
+
+/****** COUNTING_EVENTS IMPLEMENTATION ******/
+
+//all counts start at 0.
+Counting_events::Counting_events()
+{
+	reset();
+}
+
+void Counting_events::on_start(const Pokemon & first, const Pokemon & second)
+{
+	++battles;
+}
+
+void Counting_events::on_attack(const Pokemon & attacker, int action, const char * move, int power)
+{
+	if (action == ATTACK)
+		++attacks;
+	else
+		++specials;
+}
+
+void Counting_events::on_defend(const Pokemon & defender, const char * move, int blocked)
+{
+	++defends;
+}
+
+void Counting_events::on_damage(const Pokemon & attacker, const Pokemon & defender, int damage)
+{
+	this->damage += damage;
+}
+
+void Counting_events::on_faint(const Pokemon & fainted, const Pokemon & winner)
+{
+	++faints;
+}
+
+void Counting_events::on_win(const Pokemon & winner, int side)
+{
+	if (side == 1 || side == 2)
+		++wins[side - 1];
+}
+
+void Counting_events::on_error(const char * message)
+{
+	++errors;
+}
+
+//sets every count back to 0.
+void Counting_events::reset()
+{
+	battles = attacks = specials = defends = damage = faints = errors = 0;
+	wins[0] = wins[1] = 0;
+}
@@ -0,0 +1,105 @@
+// Author: Pokemon Battle contributors
+// Date: 10-17-2026
+//
+// This file contains the class declarations for battle events and the event sinks.
+
+/*
+ * Battle Events for Pokemon Battle Simulation
+ *
+ * The combat methods (`attack`, `defend`, `special_ability`, `fly`) and `Battle_engine` no
+ * longer print. They return values and raise events on a `Battle_events` sink:
+ *
+ * - `Null_events`     -- ignores everything. No I/O and no formatting.
+ * - `Text_events`     -- formats the events exactly like the old console output, into a
+ *                        buffer that is written out in one go on `flush()` (or when full).
+ * - `Counting_events` -- only counts (attacks, specials, defends, damage, faints, wins).
+ *
+ * Move descriptions are passed as string literals, so raising an event never builds a string.
+ */
+
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <string>
+#include <iostream>
+
+using namespace std;
+
+class Pokemon;
+
+/* This class is the Abstract Base Class for everything that listens to a battle. */
+class Battle_events
+{
+	public:
+		virtual ~Battle_events();	//virtual destructor so the right one gets called for derived class
+		virtual void on_start(const Pokemon & first, const Pokemon & second)=0;	//a battle begins.
+		virtual void on_attack(const Pokemon & attacker, int action, const char * move, int power)=0;	//attack or special ability.
+		virtual void on_defend(const Pokemon & defender, const char * move, int blocked)=0;	//defend or fly.
+		virtual void on_damage(const Pokemon & attacker, const Pokemon & defender, int damage)=0;	//damage taken off health.
+		virtual void on_faint(const Pokemon & fainted, const Pokemon & winner)=0;	//a Pokemon fainted.
+		virtual void on_win(const Pokemon & winner, int side)=0;	//the battle is over.
+		virtual void on_error(const char * message)=0;	//something was wrong with the input.
+		virtual void flush();		//writes out anything buffered (default: nothing).
+};
+
+/* This class ignores every event. */
+class Null_events: public Battle_events
+{
+	public:
+		void on_start(const Pokemon & first, const Pokemon & second);
+		void on_attack(const Pokemon & attacker, int action, const char * move, int power);
+		void on_defend(const Pokemon & defender, const char * move, int blocked);
+		void on_damage(const Pokemon & attacker, const Pokemon & defender, int damage);
+		void on_faint(const Pokemon & fainted, const Pokemon & winner);
+		void on_win(const Pokemon & winner, int side);
+		void on_error(const char * message);
+};
+
+/* This class formats the events as text into a buffer. */
+class Text_events: public Battle_events
+{
+	public:
+		Text_events(ostream & out = cout, ostream & err = cerr, size_t limit = 1 << 16);	//flushes once limit bytes are buffered.
+		~Text_events();		//flushes.
+		void on_start(const Pokemon & first, const Pokemon & second);
+		void on_attack(const Pokemon & attacker, int action, const char * move, int power);
+		void on_defend(const Pokemon & defender, const char * move, int blocked);
+		void on_damage(const Pokemon & attacker, const Pokemon & defender, int damage);
+		void on_faint(const Pokemon & fainted, const Pokemon & winner);
+		void on_win(const Pokemon & winner, int side);
+		void on_error(const char * message);
+		void flush();		//writes the buffer out.
+	private:
+		ostream & out;		//where the text goes.
+		ostream & err;		//where errors go.
+		string buffer;		//text not written yet.
+		size_t limit;		//buffer size that triggers a flush.
+		void append(int value);	//appends a number without a stream.
+		void maybe_flush();	//flushes if the buffer is over the limit.
+};
+
+/* This class only counts events. */
+class Counting_events: public Battle_events
+{
+	public:
+		Counting_events();	//all counts start at 0.
+		void on_start(const Pokemon & first, const Pokemon & second);
+		void on_attack(const Pokemon & attacker, int action, const char * move, int power);
+		void on_defend(const Pokemon & defender, const char * move, int blocked);
+		void on_damage(const Pokemon & attacker, const Pokemon & defender, int damage);
+		void on_faint(const Pokemon & fainted, const Pokemon & winner);
+		void on_win(const Pokemon & winner, int side);
+		void on_error(const char * message);
+		void reset();		//sets every count back to 0.
+
+		long long battles;	//on_start calls.
+		long long attacks;	//attacks used.
+		long long specials;	//special abilities used.
+		long long defends;	//defends (and flies).
+		long long damage;	//total damage dealt.
+		long long faints;	//Pokemon fainted.
+		long long wins[2];	//wins by side 1 and side 2.
+		long long errors;	//errors raised.
+};
+
+#endif
@@ -0,0 +1,57 @@
+// Author: Pokemon Battle contributors
+// Date: 10-17-2026
+//
+// This file contains the implementation of the Matchup class.
+
+/*
+ * Overview:
+ * - `resolve` has the same effect as running `Battle_engine` with two fixed-action
+ *   policies: it returns the result and takes the damage off both Pokemon.
+ * - Fresh Pokemon are answered from `OUTCOME`; anything else is played out on
+ *   `Combatant` copies (no virtual calls) and the damage is copied back.
+ */
+
+#include "combatant.h"
+
+//sanity checks on the generated tables.
+static_assert(DAMAGE[FIRE - 1][ATTACK - 1][WATER - 1] == 30, "Fire Blast vs Water");
+static_assert(DAMAGE[WATER - 1][SPECIAL - 1][FIRE - 1] == 0, "Splash Shield vs Fire");
+static_assert(OUTCOME[FIRE - 1][ATTACK - 1][GRASS - 1][ATTACK - 1].winner == 1, "Fire beats Grass");
+static_assert(OUTCOME[FIRE - 1][ATTACK - 1][GRASS - 1][ATTACK - 1].turns == 3, "in 3 turns");
+
+//true if the Pokemon is at full health with its type's base stats.
+bool Matchup::is_fresh(const Pokemon & pokemon)
+{
+	int type = pokemon.get_type();
+	return pokemon.get_health() == FULL_HEALTH
+		&& pokemon.get_attack() == type_attack(type)
+		&& pokemon.get_special() == type_special(type)
+		&& pokemon.get_defend() == type_defend(type);
+}
+
+//plays a fixed-action battle, from the table when both Pokemon are fresh.
+Battle_result Matchup::resolve(Pokemon * first, Pokemon * second, int first_action, int second_action)
+{
+	if (!first || !second)
+		return Battle_result{-1, 0, 0, 0};
+
+	bool valid_actions = (first_action == ATTACK || first_action == SPECIAL)
+		&& (second_action == ATTACK || second_action == SPECIAL);
+	if (valid_actions && is_fresh(*first) && is_fresh(*second))
+	{
+		const Battle_result & result =
+			OUTCOME[first->get_type() - 1][first_action - 1][second->get_type() - 1][second_action - 1];
+		first->reduce_health(result.damage_to_first);
+		second->reduce_health(result.damage_to_second);
+		return result;
+	}
+
+	if (!valid_actions)
+		return Battle_result{-1, 0, 0, 0};
+	Combatant first_value = to_combatant(*first);
+	Combatant second_value = to_combatant(*second);
+	Battle_result result = combatant_battle(first_value, second_value, first_action, second_action);
+	first->reduce_health(first->get_health() - first_value.health);
+	second->reduce_health(second->get_health() - second_value.health);
+	return result;
+}
@@ -0,0 +1,124 @@
+// Author: Pokemon Battle contributors
+// Date: 10-17-2026
+//
+// This file contains the compile time matchup tables for the three Pokemon types.
+
+/*
+ * Matchup Tables for Pokemon Battle Simulation
+ *
+ * Every `Fire`, `Water` and `Grass` starts with the same fixed stats (see pokemon.h), so the
+ * damage of every (attacker type, attacker action, defender type) triple is a constant.
+ * The tables below are generated by the compiler from those stats:
+ *
+ * - `DAMAGE[attacker][action][defender]` -- damage one action deals after defending.
+ * - `OUTCOME[first][first action][second][second action]` -- the full `Battle_result` of a
+ *   battle between two fresh (full health) Pokemon that always use the same action.
+ *
+ * `Matchup::resolve` answers such battles with one lookup and only falls back to playing
+ * the battle out when a Pokemon's health has been changed (e.g. by `heal`).
+ * Indices are zero based: type - 1 and action - 1.
+ */
+
+#ifndef MATCHUP_H
+#define MATCHUP_H
+
+#include "engine.h"
+#include <array>
+
+//damage attack() deals for a type.
+constexpr int type_attack(int type)
+{
+	return type == FIRE ? FIRE_ATTACK_POWER + FIRE_BURN_DAMAGE
+		: type == WATER ? WATER_ATTACK_POWER : GRASS_ATTACK_POWER;
+}
+
+//damage special_ability() deals for a type.
+constexpr int type_special(int type)
+{
+	return type == FIRE ? FIRE_BURN_DAMAGE * 2
+		: type == WATER ? WATER_SPLASH_RESISTANCE : GRASS_ENTANGLE;
+}
+
+//damage defend() blocks for a type.
+constexpr int type_defend(int type)
+{
+	return type == FIRE ? FIRE_DEFEND_POWER
+		: type == WATER ? WATER_DEFEND_POWER : GRASS_DEFEND_POWER;
+}
+
+//damage one action deals after defending.
+constexpr int type_damage(int attacker, int action, int defender)
+{
+	int hit = (action == ATTACK ? type_attack(attacker) : type_special(attacker)) - type_defend(defender);
+	return hit > 0 ? hit : 0;
+}
+
+//plays a fresh battle with fixed actions, same rules as Battle_engine.
+constexpr Battle_result type_battle(int first, int first_action, int second, int second_action)
+{
+	Battle_result result{0, 0, 0, 0};
+	int to_second = type_damage(first, first_action, second);
+	int to_first = type_damage(second, second_action, first);
+	if (to_second == 0 && to_first == 0)
+	{
+		result.turns = DEFAULT_MAX_TURNS;	//nobody can win, the engine calls it a draw.
+		return result;
+	}
+	int first_health = FULL_HEALTH;
+	int second_health = FULL_HEALTH;
+	while (true)
+	{
+		++result.turns;
+		result.damage_to_second += to_second;
+		second_health -= to_second;
+		if (second_health <= 0)
+		{
+			result.winner = 1;
+			return result;
+		}
+		result.damage_to_first += to_first;
+		first_health -= to_first;
+		if (first_health <= 0)
+		{
+			result.winner = 2;
+			return result;
+		}
+	}
+}
+
+typedef std::array<std::array<std::array<int, 3>, 2>, 3> Damage_table;
+typedef std::array<std::array<std::array<std::array<Battle_result, 2>, 3>, 2>, 3> Outcome_table;
+
+//DAMAGE[attacker][action][defender]
+inline constexpr Damage_table DAMAGE = []()
+{
+	Damage_table table{};
+	for (int attacker = 0; attacker < 3; ++attacker)
+		for (int action = 0; action < 2; ++action)
+			for (int defender = 0; defender < 3; ++defender)
+				table[attacker][action][defender] = type_damage(attacker + 1, action + 1, defender + 1);
+	return table;
+}();
+
+//OUTCOME[first][first action][second][second action]
+inline constexpr Outcome_table OUTCOME = []()
+{
+	Outcome_table table{};
+	for (int first = 0; first < 3; ++first)
+		for (int first_action = 0; first_action < 2; ++first_action)
+			for (int second = 0; second < 3; ++second)
+				for (int second_action = 0; second_action < 2; ++second_action)
+					table[first][first_action][second][second_action] =
+						type_battle(first + 1, first_action + 1, second + 1, second_action + 1);
+	return table;
+}();
+
+/* This class resolves fixed-action battles, from the tables whenever it can. */
+class Matchup
+{
+	public:
+		static Battle_result resolve(Pokemon * first, Pokemon * second, int first_action, int second_action);	//O(1) for fresh Pokemon.
+		static bool is_fresh(const Pokemon & pokemon);	//full health with the type's base stats.
+};
+
+#endif
@@ -0,0 +1,335 @@
+// Author: Pokemon Battle contributors
+// Date: 10-17-2026
+//
+// This file contains the implementation of the Net_client and Load_generator classes.
+
+#include "net_client.h"
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+//connects to "path" or "tcp:PORT", returns the socket or -1.
+int connect_address(const string & address)
+{
+#ifdef __linux__
+	int fd;
+	if (address.compare(0, 4, "tcp:") == 0)
+	{
+		fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		if (fd < 0)
+			return -1;
+		sockaddr_in where{};
+		where.sin_family = AF_INET;
+		where.sin_port = htons(uint16_t(stoi(address.substr(4))));
+		where.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		if (connect(fd, (sockaddr *)&where, sizeof(where)) < 0)
+		{
+			close(fd);
+			return -1;
+		}
+		int on = 1;
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+	}
+	else
+	{
+		fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		if (fd < 0)
+			return -1;
+		sockaddr_un where{};
+		where.sun_family = AF_UNIX;
+		strncpy(where.sun_path, address.c_str(), sizeof(where.sun_path) - 1);
+		if (connect(fd, (sockaddr *)&where, sizeof(where)) < 0)
+		{
+			close(fd);
+			return -1;
+		}
+	}
+	return fd;
+#else
+	return -1;
+#endif
+}
+
+//reads a 16 bit little endian number.
+static int get_u16(const vector<uint8_t> & in, size_t at)
+{
+	return in[at] | (in[at + 1] << 8);
+}
+
+
+/****** NET_CLIENT IMPLEMENTATION ******/
+
+//not connected yet.
+Net_client::Net_client(): fd(-1)
+{}
+
+//closes the connection.
+Net_client::~Net_client()
+{
+#ifdef __linux__
+	if (fd >= 0)
+		close(fd);
+#endif
+}
+
+//connects, returns 0 or -1.
+int Net_client::connect_to(const string & address)
+{
+	fd = connect_address(address);
+	return fd < 0 ? -1 : 0;
+}
+
+//sends one request and waits for its whole response (status, payload), returns the status.
+int Net_client::request(uint8_t op, uint8_t a, uint8_t b, uint8_t c, vector<uint8_t> & response)
+{
+#ifdef __linux__
+	uint8_t out[REQUEST_SIZE] = {op, a, b, c};
+	if (fd < 0 || send(fd, out, sizeof(out), MSG_NOSIGNAL) != sizeof(out))
+		return -1;
+	if (op == OP_QUIT)
+		return STATUS_OK;	//the server closes without answering.
+	uint8_t length = 0;
+	if (recv(fd, &length, 1, MSG_WAITALL) != 1 || length == 0)
+		return -1;
+	response.assign(length, 0);
+	if (recv(fd, response.data(), length, MSG_WAITALL) != length)
+		return -1;
+	return response[0];
+#else
+	return -1;
+#endif
+}
+
+//plays by typed commands until quit or end of input.
+int Net_client::console(istream & in, ostream & out)
+{
+	static const char * STATUS_TEXT[] = {"ok", "bad request", "no team (send hello first)",
+		"no battle (send start first)", "bad index", "battle still running"};
+	string line;
+	vector<uint8_t> response;
+	Fire fire;
+	Water water;
+	Grass grass;
+	Pokemon * kinds[3] = {&fire, &water, &grass};	//looks up species names.
+	out << "Commands: hello SIZE, team 1|2, start I J, move 1|2, score, clear 1|2, quit" << endl;
+	while (getline(in, line))
+	{
+		istringstream words(line);
+		string command;
+		int a = 0, b = 0;
+		words >> command >> a >> b;
+		uint8_t op = command == "hello" ? OP_HELLO : command == "team" ? OP_TEAM :
+			command == "start" ? OP_START : command == "move" ? OP_MOVE :
+			command == "score" ? OP_SCORE : command == "clear" ? OP_CLEAR :
+			command == "quit" ? OP_QUIT : 0;
+		if (command.empty())
+			continue;
+		if (!op)
+		{
+			out << "Unknown command: " << command << endl;
+			continue;
+		}
+		int status = request(op, uint8_t(a), uint8_t(b), 0, response);
+		if (status < 0)
+		{
+			out << "Connection lost." << endl;
+			return -1;
+		}
+		if (op == OP_QUIT)
+			return 0;
+		if (status != STATUS_OK)
+		{
+			out << "Error: " << (status <= STATUS_BATTLE_RUNNING ? STATUS_TEXT[status] : "unknown") << endl;
+			continue;
+		}
+		if (op == OP_HELLO)
+			out << "Teams of " << int(response[1]) << " built." << endl;
+		else if (op == OP_TEAM)
+		{
+			for (int i = 0; i < response[1]; ++i)
+			{
+				size_t at = 2 + size_t(i) * 4;
+				int type = response[at] >= FIRE && response[at] <= GRASS ? response[at] : FIRE;
+				kinds[type - 1]->set_species(type, response[at + 1]);
+				out << "\t" << i << ": " << kinds[type - 1]->get_name()
+					<< " (" << get_u16(response, at + 2) << " HP)" << endl;
+			}
+		}
+		else if (op == OP_START || op == OP_MOVE)
+		{
+			out << "HP " << get_u16(response, 3) << " vs " << get_u16(response, 5);
+			if (response[1])
+				out << " -- trainer " << int(response[1]) << " wins!" << endl;
+			else
+				out << " -- trainer " << int(response[2]) << " to move" << endl;
+		}
+		else if (op == OP_SCORE)
+			out << "Score: " << get_u16(response, 1) << " - " << get_u16(response, 3) << endl;
+		else
+			out << "Done." << endl;
+	}
+	return 0;
+}
+
+
+/****** LOAD_GENERATOR IMPLEMENTATION ******/
+
+//remembers the target, nothing is opened until run().
+Load_generator::Load_generator(const string & address, int sessions, int moves)
+	: address(address), sessions(sessions > 0 ? sessions : 1), moves(moves > 0 ? moves : 1)
+{}
+
+#ifdef __linux__
+
+namespace
+{
+	using Clock = chrono::steady_clock;
+
+	/* This struct is one simulated player: HELLO, START, MOVE ... until the battle ends, again. */
+	struct Player
+	{
+		int fd;
+		int sent;		//requests sent.
+		uint8_t last_op;	//the request in flight.
+		Clock::time_point started;	//when it was sent.
+		vector<uint8_t> input;	//partial response.
+		int round;		//battles started, picks the next matchup.
+	};
+}
+
+//sends the next request of the player's script.
+static bool send_next(Player & player, uint8_t op, uint8_t a, uint8_t b)
+{
+	uint8_t out[REQUEST_SIZE] = {op, a, b, 0};
+	player.last_op = op;
+	player.started = Clock::now();
+	++player.sent;
+	return send(player.fd, out, sizeof(out), MSG_NOSIGNAL) == sizeof(out);
+}
+
+//connects every session, then keeps each one busy until it has made its moves.
+int Load_generator::run(Load_result & result)
+{
+	result = Load_result{};
+	int poller = epoll_create1(EPOLL_CLOEXEC);
+	if (poller < 0)
+		return -1;
+	vector<Player> players(static_cast<size_t>(sessions));
+	vector<double> latencies;
+	latencies.reserve(size_t(sessions) * size_t(moves + moves / 4 + 2));
+	const int team_size = 3;
+
+	Clock::time_point begin = Clock::now();
+	for (Player & player : players)
+	{
+		player.fd = connect_address(address);
+		if (player.fd < 0)
+		{
+			for (Player & opened : players)
+				if (opened.fd > 0)
+					close(opened.fd);
+			close(poller);
+			return -1;
+		}
+		epoll_event event{};
+		event.events = EPOLLIN;
+		event.data.ptr = &player;
+		epoll_ctl(poller, EPOLL_CTL_ADD, player.fd, &event);
+		send_next(player, OP_HELLO, team_size, 0);
+	}
+
+	int active = sessions;
+	vector<epoll_event> ready(256);
+	uint8_t chunk[1024];
+	while (active > 0)
+	{
+		int count = epoll_wait(poller, ready.data(), int(ready.size()), 1000);
+		if (count < 0 && errno != EINTR)
+			break;
+		for (int i = 0; i < count; ++i)
+		{
+			Player & player = *(Player *)ready[i].data.ptr;
+			ssize_t got = recv(player.fd, chunk, sizeof(chunk), MSG_DONTWAIT);
+			if (got <= 0)
+			{
+				if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+					continue;
+				close(player.fd);
+				--active;
+				continue;
+			}
+			player.input.insert(player.input.end(), chunk, chunk + got);
+			if (player.input.empty() || player.input.size() < size_t(player.input[0]) + 1)
+				continue;	//response not complete yet.
+
+			latencies.push_back(chrono::duration<double, micro>(Clock::now() - player.started).count());
+			++result.requests;
+			vector<uint8_t> response(player.input.begin() + 1, player.input.begin() + 1 + player.input[0]);
+			player.input.clear();	//closed loop: at most one response is ever outstanding.
+
+			bool ok = response[0] == STATUS_OK;
+			if (ok && (player.last_op == OP_START || player.last_op == OP_MOVE) && response[1] != 0)
+				++result.battles;
+			if (!ok || player.sent >= moves)
+			{
+				send_next(player, OP_QUIT, 0, 0);
+				close(player.fd);
+				--active;
+			}
+			else if (player.last_op == OP_HELLO)
+			{
+				send_next(player, OP_START, uint8_t(player.round % team_size), uint8_t(player.round / team_size % team_size));
+				++player.round;
+			}
+			else if (response[1] != 0)
+				send_next(player, OP_HELLO, team_size, 0);	//fresh teams for the next battle.
+			else
+				send_next(player, OP_MOVE, uint8_t(player.sent % 3 ? ATTACK : SPECIAL), 0);
+		}
+	}
+	result.seconds = chrono::duration<double>(Clock::now() - begin).count();
+	close(poller);
+
+	result.requests_per_second = result.seconds > 0 ? result.requests / result.seconds : 0;
+	if (!latencies.empty())
+	{
+		sort(latencies.begin(), latencies.end());
+		result.p50_us = latencies[latencies.size() / 2];
+		result.p99_us = latencies[min(latencies.size() - 1, latencies.size() * 99 / 100)];
+		result.max_us = latencies.back();
+	}
+	return 0;
+}
+
+#else
+
+//the load generator uses epoll, which is Linux only.
+int Load_generator::run(Load_result & result)
+{
+	result = Load_result{};
+	return -1;
+}
+
+#endif
+
+//prints throughput and latency.
+void Load_generator::display(const Load_result & result, ostream & out)
+{
+	out << "Requests: " << result.requests << " (" << result.battles << " battles) in "
+	    << result.seconds << " s" << endl;
+	out << "Throughput: " << (long long)result.requests_per_second << " requests/s" << endl;
+	out << "Latency: p50 " << result.p50_us << " us, p99 " << result.p99_us
+	    << " us, max " << result.max_us << " us" << endl;
+}
@@ -0,0 +1,61 @@
+// Author: Pokemon Battle contributors
+// Date: 10-17-2026
+//
+// This file contains the class declarations for the battle server's client and load generator.
+
+/*
+ * Net_client is a small blocking client: it sends one request and waits for its response.
+ * `console` drives it from typed commands (hello 3, team 1, start 0 1, move 1, score,
+ * clear 1, quit) so a match can be played by hand against a running server.
+ *
+ * Load_generator opens many sessions at once and keeps each one busy in a closed loop
+ * (one request in flight per session) from a single epoll thread, timing every request
+ * to report throughput and latency percentiles.
+ */
+
+#ifndef NET_CLIENT_H
+#define NET_CLIENT_H
+
+#include "server.h"
+
+/* This class is one blocking connection to a battle server. */
+class Net_client
+{
+	public:
+		Net_client();
+		~Net_client();		//closes the connection.
+		int connect_to(const string & address);	//"path" or "tcp:PORT", returns 0 or -1.
+		int request(uint8_t op, uint8_t a, uint8_t b, uint8_t c, vector<uint8_t> & response);	//status, or -1 if the connection failed.
+		int console(istream & in, ostream & out);	//plays by typed commands until quit or end of input.
+	private:
+		int fd;			//the socket, -1 when closed.
+};
+
+/* This struct holds what a load generator run measured. */
+struct Load_result
+{
+	long long requests;	//requests answered.
+	long long battles;	//battles finished.
+	double seconds;		//wall time.
+	double requests_per_second;
+	double p50_us;		//median request latency.
+	double p99_us;		//99th percentile request latency.
+	double max_us;		//slowest request.
+};
+
+/* This class plays many sessions at once against a server and measures it. */
+class Load_generator
+{
+	public:
+		Load_generator(const string & address, int sessions, int moves);	//moves per session.
+		int run(Load_result & result);	//returns 0, or -1 if it could not connect.
+		static void display(const Load_result & result, ostream & out);
+	private:
+		string address;		//where the server listens.
+		int sessions;		//concurrent sessions.
+		int moves;		//MOVE requests per session.
+};
+
+int connect_address(const string & address);	//blocking connect, returns the socket or -1.
+
+#endif
@@ -3,10 +3,10 @@
 //
 // This file contains the implementation of the core hierarchy used in this project -- Pokemon; Fire; Water; Grass
 
-// Nagivation ---- Pokemon: Line 44
-// 			  ---- Fire: 	Line 197
-//			  ---- Water: 	Line 425
-//			  ---- Grass: 	Line 632
+// Nagivation ---- Pokemon: Line 59
+// 			  ---- Fire: 	Line 397
+//			  ---- Water: 	Line 563
+//			  ---- Grass: 	Line 714
 
 /**********************************************************
  * Pokemon.cpp
@@ -40,80 +40,250 @@
  *
  **********************************************************/
 #include "pokemon.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
 
 /* Overview Here */
 
 /********** Pokemon Class Implementation **********/
 
+//hands out instance ids, safe from any thread.
+static uint32_t next_instance_id()
+{
+	static atomic<uint32_t> next(1);
+	return next.fetch_add(1, memory_order_relaxed);
+}
+
 //default constructor
-Pokemon::Pokemon():name(""), health(100)
+Pokemon::Pokemon():species(&UNNAMED), health(FULL_HEALTH), id(next_instance_id()), observer(nullptr)
 {}
 
+//same species, health and id; the copy isn't watched by anyone yet.
+Pokemon::Pokemon(const Pokemon & source):species(source.species), health(source.health), id(source.id), observer(nullptr)
+{}
+
+//same species, health and id; keeps its own observer and tells it about the new health while
+//the Pokemon still has the species and id it is filed under.
+Pokemon & Pokemon::operator=(const Pokemon & source)
+{
+	int old_health = health;
+	health = source.health;
+	health_changed(old_health);
+	species = source.species;
+	id = source.id;
+	return *this;
+}
+
 //destructor
 Pokemon::~Pokemon()
 {
-	name = "";
 	health =0;
 }
 
 //displays the name and the health
 void Pokemon::display()
 {
-	cout << "\nName: " << name << endl << "Health: " << health << endl;
+	cout << "\nName: " << get_name() << endl << "Health: " << health << endl;
 }
 
 //heals the health to a random amount.
 int Pokemon::heal()
 {
+	int old_health = health;
 	health += random_num(10,20);
+	health_changed(old_health);
 	return health;
 }
 
+//names each type picks from, row = type - 1.
+static const string SPECIES_NAMES[3][5] = {
+	{"Charmander", "Vulpix", "Flareon", "Torchic", "Ponyta"},
+	{"Squirtle", "Psyduck", "Lapras", "Vaporeon", "Totodile"},
+	{"Bulbasaur", "Chikorita", "Leafeon", "Turtwig", "Oddish"}
+};
+
+//the name in lower case, for matching what a user typed.
+static string fold_case(const string & name)
+{
+	string folded(name);
+	for (char & letter : folded)
+		letter = char(tolower((unsigned char)letter));
+	return folded;
+}
+
+/* This struct is the flyweight table: one shared record per species, indexed by species id
+ * (the names' alphabetical ranks), with the type's starting stats.
+ */
+struct Species_table
+{
+	Species records[SPECIES_COUNT];		//id -> record.
+	string folded[SPECIES_COUNT];		//id -> lower case name (still sorted: every name is capitalized alike; the completion check asserts it).
+	const Species * by_species[3][5];	//(type, index) -> record.
+	Species_table()
+	{
+		const string * names[SPECIES_COUNT];
+		for (int i = 0; i < SPECIES_COUNT; ++i)
+			names[i] = &SPECIES_NAMES[i / 5][i % 5];
+		sort(names, names + SPECIES_COUNT, [](const string * a, const string * b) { return *a < *b; });
+		for (int i = 0; i < SPECIES_COUNT; ++i)
+		{
+			int row = int(names[i] - &SPECIES_NAMES[0][0]);
+			int type = row / 5 + 1;
+			Species & record = records[i];
+			record.name = *names[i];
+			folded[i] = fold_case(record.name);
+			record.id = i;
+			record.type = type;
+			record.index = row % 5;
+			record.attack_power = type == FIRE ? FIRE_ATTACK_POWER : type == WATER ? WATER_ATTACK_POWER : GRASS_ATTACK_POWER;
+			record.defend_power = type == FIRE ? FIRE_DEFEND_POWER : type == WATER ? WATER_DEFEND_POWER : GRASS_DEFEND_POWER;
+			record.special_power = type == FIRE ? FIRE_BURN_DAMAGE : type == WATER ? WATER_SPLASH_RESISTANCE : GRASS_ENTANGLE;
+			record.fly_power = type == FIRE ? FIRE_FLY_POWER : 0;
+			by_species[type - 1][row % 5] = &record;
+		}
+	}
+};
+
+//the flyweight table, built on first use.
+static const Species_table & species_table()
+{
+	static const Species_table table;
+	return table;
+}
+
+//shared by every Pokemon that hasn't been named yet.
+const Species Pokemon::UNNAMED = {"", -1, 0, -1, 0, 0, 0, 0};
+
 //this function assigns a name based on passed in type.
 //	(1) = Fire Based Pokemon
 //	(2) = Water Based Pokemon
 //	(3) = Grass Based Pokemon
 int Pokemon::set_name(int type)
 {
-	// Create arrays of names using smart pointers
-	static unique_ptr<string[]> fire_names(new string[5]{"Charmander", "Vulpix", "Flareon", "Torchic", "Ponyta"});
-	static unique_ptr<string[]> water_names(new string[5]{"Squirtle", "Psyduck", "Lapras", "Vaporeon", "Totodile"});
-	static unique_ptr<string[]> grass_names(new string[5]{"Bulbasaur", "Chikorita", "Leafeon", "Turtwig", "Oddish"});
-
-	try 
+	if (type < FIRE || type > GRASS)
 	{
-		int index = random_num(0, 4); // Random index from 0 to 4
-
-		if (type == 1) { // Fire-type Pokemon
-			name = fire_names[index];
-		} else if (type == 2) { // Water-type Pokemon
-			name = water_names[index];
-		} else if (type == 3) { // Grass-type Pokemon
-			name = grass_names[index];
-		} else {
-			throw invalid_argument("Invalid type passed to set_name!");
-		}
-	} 
-	catch (const invalid_argument& e)
-	{
-		cerr << "Error: " << e.what() << endl;
+		cerr << "Error: Invalid type passed to set_name!" << endl;
 		return -1;
 	}
+	int index = random_num(0, 4); // Random index from 0 to 4
+	species = species_table().by_species[type - 1][index];
 
 	return 0; // Success	
 }
 
-//returns a random number from the given range
-int Pokemon::random_num(int min, int max)
+//sets the name to a specific one of the type's five names.
+int Pokemon::set_species(int type, int index)
+{
+	if (type < FIRE || type > GRASS || index < 0 || index > 4)
+		return -1;
+	species = species_table().by_species[type - 1][index];
+	return 0;
+}
+
+//returns which of its type's five names this Pokemon has (-1 if none).
+int Pokemon::get_species() const
+{
+	return species->index;
+}
+
+//interned name, in alphabetical order.
+int Pokemon::get_species_id() const
 {
-	if (min > max) {
-		throw "Invalid Range: min should be <= max.";
+	return species->id;
+}
+
+//the shared record of this Pokemon's species.
+const Species & Pokemon::get_species_record() const
+{
+	return *species;
+}
+
+//the shared record of a species id, nullptr if invalid.
+const Species * Pokemon::find_species(int species_id)
+{
+	return species_id >= 0 && species_id < SPECIES_COUNT ? &species_table().records[species_id] : nullptr;
+}
+
+//unique instance id.
+uint32_t Pokemon::get_id() const
+{
+	return id;
+}
+
+//interned id of a name (binary search over the sorted names), -1 if it isn't a species.
+int Pokemon::species_id(const string & name)
+{
+	const Species_table & table = species_table();
+	int low = 0, high = SPECIES_COUNT;
+	while (low < high)
+	{
+		int middle = (low + high) / 2;
+		if (table.records[middle].name < name)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+	return low < SPECIES_COUNT && table.records[low].name == name ? low : -1;
+}
+
+//the names starting with prefix are one run of the sorted table: binary search for where the
+//run starts, then for the first name past it.
+int Pokemon::species_with_prefix(const string & prefix, int & first, int & end)
+{
+	const Species_table & table = species_table();
+	string folded = fold_case(prefix);
+	first = int(lower_bound(table.folded, table.folded + SPECIES_COUNT, folded) - table.folded);
+	end = int(partition_point(table.folded + first, table.folded + SPECIES_COUNT,
+		[&folded](const string & name) { return name.compare(0, folded.size(), folded) == 0; }) - table.folded);
+	return end - first;
+}
+
+//Levenshtein distance over two rows, banded: cell (i, j) is at least |i - j|, so only cells
+//with |i - j| <= most are filled and the cells just outside the band count as most + 1 (the
+//band moves right, so the ones past its end are never written). Gives up as soon as a whole
+//band row is past most.
+int Pokemon::name_distance(const string & typed, int species_id, int most)
+{
+	const Species * record = find_species(species_id);
+	if (!record || most < 0)
+		return most + 1;
+	const string & name = species_table().folded[species_id];
+	string folded = fold_case(typed);
+	int typed_size = int(folded.size()), name_size = int(name.size());
+	if (abs(typed_size - name_size) > most)
+		return most + 1;	//the length difference alone is too many edits.
+	vector<int> above(name_size + 1, most + 1), row(name_size + 1, most + 1);
+	for (int j = 0; j <= min(name_size, most); ++j)
+		above[j] = j;
+	for (int i = 1; i <= typed_size; ++i)
+	{
+		int low = max(1, i - most), high = min(name_size, i + most);
+		row[low - 1] = low == 1 ? min(i, most + 1) : most + 1;
+		int best = row[low - 1];
+		for (int j = low; j <= high; ++j)
+		{
+			row[j] = min({above[j] + 1, row[j - 1] + 1, above[j - 1] + (folded[i - 1] == name[j - 1] ? 0 : 1)});
+			best = min(best, row[j]);
+		}
+		if (best > most)
+			return most + 1;
+		above.swap(row);
 	}
-	random_device rd;
-	mt19937 gen(rd());	//gets the random num	
-	uniform_int_distribution<> distrib(min,max);
-	return distrib(gen);
+	return min(above[name_size], most + 1);
+}
 
+//the name of an interned id.
+const string & Pokemon::species_name(int species_id)
+{
+	const Species * record = find_species(species_id);
+	return record ? record->name : UNNAMED.name;
+}
+
+//returns a random number from the given range
+int Pokemon::random_num(int min, int max)
+{
+	return RNG::random_num(min, max);	//per thread engine, seeded once.
 }
 
 //prompts the user for input error checks for wrong data types
@@ -143,7 +313,7 @@ int Pokemon::input(int min, int max)
 }
 
 //returns health for the battle logic in this game.
-int Pokemon::get_health()
+int Pokemon::get_health() const
 {
     return health;
 }
@@ -152,15 +322,42 @@ int Pokemon::get_health()
 //fight.
 void Pokemon::reduce_health(int damage)
 {
+    int old_health = health;
     health -= damage;
     if (health < 0)
         health = 0; // Ensure health doesn't drop below 0
+    health_changed(old_health);
 }
 
+//sets health directly, used to rebuild a Pokemon from a battle log.
+void Pokemon::set_health(int new_health)
+{
+    int old_health = health;
+    health = new_health < 0 ? 0 : new_health;
+    health_changed(old_health);
+}
+
+//who is told about health changes.
+void Pokemon::set_observer(Health_observer * to_set)
+{
+	observer = to_set;
+}
+
+//tells the observer, if there is one and health did change.
+void Pokemon::health_changed(int old_health)
+{
+	if (observer && health != old_health)
+		observer->on_health_change(*this, old_health);
+}
+
+//nothing to clean up.
+Health_observer::~Health_observer()
+{}
+
 //returns name for battle logic.
 const string & Pokemon::get_name() const
 {
-    return name;
+    return species->name;
 }
 
 /*Overloaded operators are intentionally left empty */
@@ -198,17 +395,8 @@ bool Pokemon::operator !=(const Pokemon * op2)
 
 // Constructor initializes the Fire Pokemon with default attributes and assigns a name.
 Fire::Fire()
-    : attack_power(50), defend_power(30), fly_power(20), burn_damage(15)
 {
-    try
-    {
-        set_name(1); // Assigns a Fire-type name using the base class function
-    }
-    catch (const string &e)
-    {
-        cerr << "Error in Fire::Fire() - " << e << endl;
-        throw; // Re-throw the exception for higher-level handling if necessary
-    }
+    set_name(1); // Assigns a Fire-type name using the base class function
 }
 
 // Destructor
@@ -220,203 +408,150 @@ Fire::~Fire()
 // Displays all attributes of the Fire Pokemon.
 void Fire::display()
 {
-    try
-    {
-        cout << "Fire Pokemon: " << name << endl;
-        cout << "Health: " << health << endl;
-        cout << "Attack Power: " << attack_power << endl;
-        cout << "Defend Power: " << defend_power << endl;
-        cout << "Fly Power: " << fly_power << endl;
-        cout << "Burn Damage: " << burn_damage << endl;
-    }
-    catch (const string &e)
-    {
-        cerr << "Error in Fire::display() - " << e << endl;
-    }
+    cout << "Fire Pokemon: " << get_name() << endl;
+    cout << "Health: " << health << endl;
+    cout << "Attack Power: " << species->attack_power << endl;
+    cout << "Defend Power: " << species->defend_power << endl;
+    cout << "Fly Power: " << species->fly_power << endl;
+    cout << "Burn Damage: " << species->special_power << endl;
 }
 
 // Executes an attack and returns the total damage dealt (attack power + burn damage).
-int Fire::attack()
+int Fire::attack(Battle_events & events)
 {
-    try
-    {
-        if (attack_power <= 0 || burn_damage <= 0)
-        {
-            throw string("Invalid attack or burn damage in Fire::attack()");
-        }
-        cout << name << " attacks with Fire Blast!" << endl;
-        return attack_power + burn_damage;
-    }
-    catch (const string &e)
+    if (species->attack_power <= 0 || species->special_power <= 0)
     {
-        cerr << "Error in Fire::attack() - " << e << endl;
+        events.on_error("Invalid attack or burn damage in Fire::attack()");
         return 0;
     }
+    events.on_attack(*this, ATTACK, "attacks with Fire Blast!", species->attack_power + species->special_power);
+    return species->attack_power + species->special_power;
 }
 
 // Defends against an attack and returns the defense power.
-int Fire::defend()
+int Fire::defend(Battle_events & events)
 {
-    try
-    {
-        if (defend_power <= 0)
-        {
-            throw string("Invalid defend power in Fire::defend()");
-        }
-        cout << name << " defends against the attack!" << endl;
-        return defend_power;
-    }
-    catch (const string &e)
+    if (species->defend_power <= 0)
     {
-        cerr << "Error in Fire::defend() - " << e << endl;
+        events.on_error("Invalid defend power in Fire::defend()");
         return 0;
     }
+    events.on_defend(*this, "defends against the attack!", species->defend_power);
+    return species->defend_power;
 }
 
 // Executes the special ability and returns double the burn damage.
-int Fire::special_ability()
+int Fire::special_ability(Battle_events & events)
 {
-    try
+    if (species->special_power <= 0)
     {
-        if (burn_damage <= 0)
-        {
-            throw string("Invalid burn damage in Fire::special_ability()");
-        }
-        cout << name << " uses Inferno! Massive burn damage!" << endl;
-        return burn_damage * 2;
-    }
-    catch (const string &e)
-    {
-        cerr << "Error in Fire::special_ability() - " << e << endl;
+        events.on_error("Invalid burn damage in Fire::special_ability()");
         return 0;
     }
+    events.on_attack(*this, SPECIAL, "uses Inferno! Massive burn damage!", species->special_power * 2);
+    return species->special_power * 2;
 }
 
 // Dodges an attack by flying and returns the fly power.
-int Fire::fly()
+int Fire::fly(Battle_events & events)
 {
-    try
-    {
-        if (fly_power <= 0)
-        {
-            throw string("Invalid fly power in Fire::fly()");
-        }
-        cout << name << " flies to dodge the attack!" << endl;
-        return fly_power;
-    }
-    catch (const string &e)
+    if (species->fly_power <= 0)
     {
-        cerr << "Error in Fire::fly() - " << e << endl;
+        events.on_error("Invalid fly power in Fire::fly()");
         return 0;
     }
+    events.on_defend(*this, "flies to dodge the attack!", species->fly_power);
+    return species->fly_power;
+}
+
+// Returns the damage attack() deals, without printing.
+int Fire::get_attack() const
+{
+    return species->attack_power + species->special_power;
+}
+
+// Returns the damage special_ability() deals, without printing.
+int Fire::get_special() const
+{
+    return species->special_power * 2;
+}
+
+// Returns the damage defend() blocks, without printing.
+int Fire::get_defend() const
+{
+    return species->defend_power;
+}
+
+// Returns the type code.
+int Fire::get_type() const
+{
+    return FIRE;
 }
 
 // Compares this Pokemon's name with another's (less than).
 bool Fire::operator<(const Pokemon *op2)
 {
-    try
-    {
-        if (!op2)
-        {
-            throw string("Null pointer passed to Fire::operator<");
-        }
-        return this->name < op2->get_name();
-    }
-    catch (const string &e)
+    if (!op2)
     {
-        cerr << "Error in Fire::operator< - " << e << endl;
+        cerr << "Error in Fire::operator< - Null pointer passed to Fire::operator<" << endl;
         return false;
     }
+    return get_name() < op2->get_name();
 }
 
 // Compares this Pokemon's name with another's (greater than).
 bool Fire::operator>(const Pokemon* op2)
 {
-    try
-    {
-        if (!op2)
-        {
-            throw string("Null pointer passed to Fire::operator>");
-        }
-        return this->name > op2->get_name();
-    }
-    catch (const string& e)
+    if (!op2)
     {
-        cerr << "Error in Fire::operator> - " << e << endl;
+        cerr << "Error in Fire::operator> - Null pointer passed to Fire::operator>" << endl;
         return false;
     }
+    return get_name() > op2->get_name();
 }
 
 // Compares this Pokemon's name with another's (less than or equal to).
 bool Fire::operator<=(const Pokemon* op2)
 {
-    try
+    if (!op2)
     {
-        if (!op2)
-        {
-            throw string("Null pointer passed to Fire::operator<=");
-        }
-        return this->name <= op2->get_name();
-    }
-    catch (const string& e)
-    {
-        cerr << "Error in Fire::operator<= - " << e << endl;
+        cerr << "Error in Fire::operator<= - Null pointer passed to Fire::operator<=" << endl;
         return false;
     }
+    return get_name() <= op2->get_name();
 }
 
 // Compares this Pokemon's name with another's (greater than or equal to).
 bool Fire::operator>=(const Pokemon* op2)
 {
-    try
-    {
-        if (!op2)
-        {
-            throw string("Null pointer passed to Fire::operator>=");
-        }
-        return this->name >= op2->get_name();
-    }
-    catch (const string& e)
+    if (!op2)
     {
-        cerr << "Error in Fire::operator>= - " << e << endl;
+        cerr << "Error in Fire::operator>= - Null pointer passed to Fire::operator>=" << endl;
         return false;
     }
+    return get_name() >= op2->get_name();
 }
 
 // Checks if this Pokemon's name is equal to another's.
 bool Fire::operator==(const Pokemon* op2)
 {
-    try
-    {
-        if (!op2)
-        {
-            throw string("Null pointer passed to Fire::operator==");
-        }
-        return this->name == op2->get_name();
-    }
-    catch (const string& e)
+    if (!op2)
     {
-        cerr << "Error in Fire::operator== - " << e << endl;
+        cerr << "Error in Fire::operator== - Null pointer passed to Fire::operator==" << endl;
         return false;
     }
+    return get_name() == op2->get_name();
 }
 
 // Checks if this Pokemon's name is not equal to another's.
 bool Fire::operator!=(const Pokemon* op2)
 {
-    try
+    if (!op2)
     {
-        if (!op2)
-        {
-            throw string("Null pointer passed to Fire::operator!=");
-        }
-        return this->name != op2->get_name();
-    }
-    catch (const string& e)
-    {
-        cerr << "Error in Fire::operator!= - " << e << endl;
+        cerr << "Error in Fire::operator!= - Null pointer passed to Fire::operator!=" << endl;
         return false;
     }
+    return get_name() != op2->get_name();
 }
 /*** END OF Fire Class ***/
 
@@ -426,17 +561,8 @@ bool Fire::operator!=(const Pokemon* op2)
 
 // Constructor initializes the Water Pokemon with default attributes and assigns a name.
 Water::Water()
-    : attack_power(40), defend_power(35), splash_resistance(20)
 {
-    try
-    {
-        set_name(2); // Assigns a Water-type name using the base class function
-    }
-    catch (const string &e)
-    {
-        cerr << "Error in Water::Water() - " << e << endl;
-        throw; // Re-throw the exception for higher-level handling if necessary
-    }
+    set_name(2); // Assigns a Water-type name using the base class function
 }
 
 // Destructor
@@ -447,183 +573,137 @@ Water::~Water()
 // Displays all attributes of the Water Pokemon.
 void Water::display()
 {
-    try
-    {
-        cout << "Water Pokemon: " << name << endl;
-        cout << "Health: " << health << endl;
-        cout << "Attack Power: " << attack_power << endl;
-        cout << "Defend Power: " << defend_power << endl;
-        cout << "Splash Resistance: " << splash_resistance << endl;
-    }
-    catch (const string &e)
-    {
-        cerr << "Error in Water::display() - " << e << endl;
-    }
+    cout << "Water Pokemon: " << get_name() << endl;
+    cout << "Health: " << health << endl;
+    cout << "Attack Power: " << species->attack_power << endl;
+    cout << "Defend Power: " << species->defend_power << endl;
+    cout << "Splash Resistance: " << species->special_power << endl;
 }
 
 // Executes an attack and returns the total damage dealt.
-int Water::attack()
+int Water::attack(Battle_events & events)
 {
-    try
-    {
-        if (attack_power <= 0)
-        {
-            throw string("Invalid attack power in Water::attack()");
-        }
-        cout << name << " attacks with Aqua Blast!" << endl;
-        return attack_power;
-    }
-    catch (const string &e)
+    if (species->attack_power <= 0)
     {
-        cerr << "Error in Water::attack() - " << e << endl;
+        events.on_error("Invalid attack power in Water::attack()");
         return 0;
     }
+    events.on_attack(*this, ATTACK, "attacks with Aqua Blast!", species->attack_power);
+    return species->attack_power;
 }
 
 // Defends against an attack and returns the defense power.
-int Water::defend()
+int Water::defend(Battle_events & events)
 {
-    try
+    if (species->defend_power <= 0)
     {
-        if (defend_power <= 0)
-        {
-            throw string("Invalid defend power in Water::defend()");
-        }
-        cout << name << " defends against the attack!" << endl;
-        return defend_power;
-    }
-    catch (const string &e)
-    {
-        cerr << "Error in Water::defend() - " << e << endl;
+        events.on_error("Invalid defend power in Water::defend()");
         return 0;
     }
+    events.on_defend(*this, "defends against the attack!", species->defend_power);
+    return species->defend_power;
 }
 
 // Executes the special ability and reduces burn damage by half.
-int Water::special_ability()
+int Water::special_ability(Battle_events & events)
 {
-    try
-    {
-        if (splash_resistance <= 0)
-        {
-            throw string("Invalid splash resistance in Water::special_ability()");
-        }
-        cout << name << " uses Splash Shield! Reduces burn damage by half!" << endl;
-        return splash_resistance;
-    }
-    catch (const string &e)
+    if (species->special_power <= 0)
     {
-        cerr << "Error in Water::special_ability() - " << e << endl;
+        events.on_error("Invalid splash resistance in Water::special_ability()");
         return 0;
     }
+    events.on_attack(*this, SPECIAL, "uses Splash Shield! Reduces burn damage by half!", species->special_power);
+    return species->special_power;
+}
+
+// Returns the damage attack() deals, without printing.
+int Water::get_attack() const
+{
+    return species->attack_power;
+}
+
+// Returns the damage special_ability() deals, without printing.
+int Water::get_special() const
+{
+    return species->special_power;
+}
+
+// Returns the damage defend() blocks, without printing.
+int Water::get_defend() const
+{
+    return species->defend_power;
+}
+
+// Returns the type code.
+int Water::get_type() const
+{
+    return WATER;
 }
 
 // Compares this Pokemon's name with another's (less than).
 bool Water::operator<(const Pokemon *op2)
 {
-    try
-    {
-        if (!op2)
-        {
-            throw string("Null pointer passed to Water::operator<");
-        }
-        return this->name < op2->get_name();
-    }
-    catch (const string &e)
+    if (!op2)
     {
-        cerr << "Error in Water::operator< - " << e << endl;
+        cerr << "Error in Water::operator< - Null pointer passed to Water::operator<" << endl;
         return false;
     }
+    return get_name() < op2->get_name();
 }
 
 // Compares this Pokemon's name with another's (greater than).
 bool Water::operator>(const Pokemon *op2)
 {
-    try
-    {
-        if (!op2)
-        {
-            throw string("Null pointer passed to Water::operator>");
-        }
-        return this->name > op2->get_name();
-    }
-    catch (const string &e)
+    if (!op2)
     {
-        cerr << "Error in Water::operator> - " << e << endl;
+        cerr << "Error in Water::operator> - Null pointer passed to Water::operator>" << endl;
         return false;
     }
+    return get_name() > op2->get_name();
 }
 
 // Compares this Pokemon's name with another's (less than or equal to).
 bool Water::operator<=(const Pokemon *op2)
 {
-    try
+    if (!op2)
     {
-        if (!op2)
-        {
-            throw string("Null pointer passed to Water::operator<=");
-        }
-        return this->name <= op2->get_name();
-    }
-    catch (const string &e)
-    {
-        cerr << "Error in Water::operator<= - " << e << endl;
+        cerr << "Error in Water::operator<= - Null pointer passed to Water::operator<=" << endl;
         return false;
     }
+    return get_name() <= op2->get_name();
 }
 
 // Compares this Pokemon's name with another's (greater than or equal to).
 bool Water::operator>=(const Pokemon *op2)
 {
-    try
-    {
-        if (!op2)
-        {
-            throw string("Null pointer passed to Water::operator>=");
-        }
-        return this->name >= op2->get_name();
-    }
-    catch (const string &e)
+    if (!op2)
     {
-        cerr << "Error in Water::operator>= - " << e << endl;
+        cerr << "Error in Water::operator>= - Null pointer passed to Water::operator>=" << endl;
         return false;
     }
+    return get_name() >= op2->get_name();
 }
 
 // Checks if this Pokemon's name is equal to another's.
 bool Water::operator==(const Pokemon *op2)
 {
-    try
-    {
-        if (!op2)
-        {
-            throw string("Null pointer passed to Water::operator==");
-        }
-        return this->name == op2->get_name();
-    }
-    catch (const string &e)
+    if (!op2)
     {
-        cerr << "Error in Water::operator== - " << e << endl;
+        cerr << "Error in Water::operator== - Null pointer passed to Water::operator==" << endl;
         return false;
     }
+    return get_name() == op2->get_name();
 }
 
 // Checks if this Pokemon's name is not equal to another's.
 bool Water::operator!=(const Pokemon *op2)
 {
-    try
+    if (!op2)
     {
-        if (!op2)
-        {
-            throw string("Null pointer passed to Water::operator!=");
-        }
-        return this->name != op2->get_name();
-    }
-    catch (const string &e)
-    {
-        cerr << "Error in Water::operator!= - " << e << endl;
+        cerr << "Error in Water::operator!= - Null pointer passed to Water::operator!=" << endl;
         return false;
     }
+    return get_name() != op2->get_name();
 }
 /*** END OF Water Class ***/
 
@@ -632,17 +712,8 @@ bool Water::operator!=(const Pokemon *op2)
 /******* GRASS CLASS IMPLEMENTATION ********/
 // Constructor initializes the Grass Pokemon with default attributes and assigns a name.
 Grass::Grass()
-    : attack_power(45), defend_power(25), entangle(15)
 {
-    try
-    {
-        set_name(3); // Assigns a Grass-type name using the base class function
-    }
-    catch (const std::string &e)
-    {
-        std::cerr << "Error in Grass::Grass() - " << e << std::endl;
-        throw; // Re-throw the exception for higher-level handling if necessary
-    }
+    set_name(3); // Assigns a Grass-type name using the base class function
 }
 
 // Destructor
@@ -653,182 +724,136 @@ Grass::~Grass()
 // Displays all attributes of the Grass Pokemon.
 void Grass::display()
 {
-    try
-    {
-        std::cout << "Grass Pokemon: " << name << std::endl;
-        std::cout << "Health: " << health << std::endl;
-        std::cout << "Attack Power: " << attack_power << std::endl;
-        std::cout << "Defend Power: " << defend_power << std::endl;
-        std::cout << "Entangle Power: " << entangle << std::endl;
-    }
-    catch (const std::string &e)
-    {
-        std::cerr << "Error in Grass::display() - " << e << std::endl;
-    }
+    std::cout << "Grass Pokemon: " << get_name() << std::endl;
+    std::cout << "Health: " << health << std::endl;
+    std::cout << "Attack Power: " << species->attack_power << std::endl;
+    std::cout << "Defend Power: " << species->defend_power << std::endl;
+    std::cout << "Entangle Power: " << species->special_power << std::endl;
 }
 
 // Executes an attack and returns the total damage dealt.
-int Grass::attack()
+int Grass::attack(Battle_events & events)
 {
-    try
-    {
-        if (attack_power <= 0)
-        {
-            throw std::string("Invalid attack power in Grass::attack()");
-        }
-        std::cout << name << " attacks with Leaf Blade!" << std::endl;
-        return attack_power;
-    }
-    catch (const std::string &e)
+    if (species->attack_power <= 0)
     {
-        std::cerr << "Error in Grass::attack() - " << e << std::endl;
+        events.on_error("Invalid attack power in Grass::attack()");
         return 0;
     }
+    events.on_attack(*this, ATTACK, "attacks with Leaf Blade!", species->attack_power);
+    return species->attack_power;
 }
 
 // Defends against an attack and returns the defense power.
-int Grass::defend()
+int Grass::defend(Battle_events & events)
 {
-    try
+    if (species->defend_power <= 0)
     {
-        if (defend_power <= 0)
-        {
-            throw std::string("Invalid defend power in Grass::defend()");
-        }
-        std::cout << name << " defends against the attack!" << std::endl;
-        return defend_power;
-    }
-    catch (const std::string &e)
-    {
-        std::cerr << "Error in Grass::defend() - " << e << std::endl;
+        events.on_error("Invalid defend power in Grass::defend()");
         return 0;
     }
+    events.on_defend(*this, "defends against the attack!", species->defend_power);
+    return species->defend_power;
 }
 
 // Executes the special ability and stops the opponent from defending.
-int Grass::special_ability()
+int Grass::special_ability(Battle_events & events)
 {
-    try
+    if (species->special_power <= 0)
     {
-        if (entangle <= 0)
-        {
-            throw std::string("Invalid entangle power in Grass::special_ability()");
-        }
-        std::cout << name << " uses Vine Entangle! Stops opponent from defending!" << std::endl;
-        return entangle;
-    }
-    catch (const std::string &e)
-    {
-        std::cerr << "Error in Grass::special_ability() - " << e << std::endl;
+        events.on_error("Invalid entangle power in Grass::special_ability()");
         return 0;
     }
+    events.on_attack(*this, SPECIAL, "uses Vine Entangle! Stops opponent from defending!", species->special_power);
+    return species->special_power;
+}
+
+// Returns the damage attack() deals, without printing.
+int Grass::get_attack() const
+{
+    return species->attack_power;
+}
+
+// Returns the damage special_ability() deals, without printing.
+int Grass::get_special() const
+{
+    return species->special_power;
+}
+
+// Returns the damage defend() blocks, without printing.
+int Grass::get_defend() const
+{
+    return species->defend_power;
+}
+
+// Returns the type code.
+int Grass::get_type() const
+{
+    return GRASS;
 }
 
 // Compares this Pokemon's name with another's (less than).
 bool Grass::operator<(const Pokemon *op2)
 {
-    try
+    if (!op2)
     {
-        if (!op2)
-        {
-            throw std::string("Null pointer passed to Grass::operator<");
-        }
-        return this->name < op2->get_name();
-    }
-    catch (const std::string &e)
-    {
-        std::cerr << "Error in Grass::operator< - " << e << std::endl;
+        cerr << "Error in Grass::operator< - Null pointer passed to Grass::operator<" << endl;
         return false;
     }
+    return get_name() < op2->get_name();
 }
 
 // Compares this Pokemon's name with another's (greater than).
 bool Grass::operator>(const Pokemon *op2)
 {
-    try
-    {
-        if (!op2)
-        {
-            throw std::string("Null pointer passed to Grass::operator>");
-        }
-        return this->name > op2->get_name();
-    }
-    catch (const std::string &e)
+    if (!op2)
     {
-        std::cerr << "Error in Grass::operator> - " << e << std::endl;
+        cerr << "Error in Grass::operator> - Null pointer passed to Grass::operator>" << endl;
         return false;
     }
+    return get_name() > op2->get_name();
 }
 
 // Compares this Pokemon's name with another's (less than or equal to).
 bool Grass::operator<=(const Pokemon *op2)
 {
-    try
+    if (!op2)
     {
-        if (!op2)
-        {
-            throw std::string("Null pointer passed to Grass::operator<=");
-        }
-        return this->name <= op2->get_name();
-    }
-    catch (const std::string &e)
-    {
-        std::cerr << "Error in Grass::operator<= - " << e << std::endl;
+        cerr << "Error in Grass::operator<= - Null pointer passed to Grass::operator<=" << endl;
         return false;
     }
+    return get_name() <= op2->get_name();
 }
 
 // Compares this Pokemon's name with another's (greater than or equal to).
 bool Grass::operator>=(const Pokemon *op2)
 {
-    try
+    if (!op2)
     {
-        if (!op2)
-        {
-            throw std::string("Null pointer passed to Grass::operator>=");
-        }
-        return this->name >= op2->get_name();
-    }
-    catch (const std::string &e)
-    {
-        std::cerr << "Error in Grass::operator>= - " << e << std::endl;
+        cerr << "Error in Grass::operator>= - Null pointer passed to Grass::operator>=" << endl;
         return false;
     }
+    return get_name() >= op2->get_name();
 }
 
 // Checks if this Pokemon's name is equal to another's.
 bool Grass::operator==(const Pokemon *op2)
 {
-    try
-    {
-        if (!op2)
-        {
-            throw std::string("Null pointer passed to Grass::operator==");
-        }
-        return this->name == op2->get_name();
-    }
-    catch (const std::string &e)
+    if (!op2)
     {
-        std::cerr << "Error in Grass::operator== - " << e << std::endl;
+        cerr << "Error in Grass::operator== - Null pointer passed to Grass::operator==" << endl;
         return false;
     }
+    return get_name() == op2->get_name();
 }
 
 // Checks if this Pokemon's name is not equal to another's.
 bool Grass::operator!=(const Pokemon *op2)
 {
-    try
-    {
-        if (!op2)
-        {
-            throw std::string("Null pointer passed to Grass::operator!=");
-        }
-        return this->name != op2->get_name();
-    }
-    catch (const std::string &e)
+    if (!op2)
     {
-        std::cerr << "Error in Grass::operator!= - " << e << std::endl;
+        cerr << "Error in Grass::operator!= - Null pointer passed to Grass::operator!=" << endl;
         return false;
     }
+    return get_name() != op2->get_name();
 }
 /*** END OF GRASS IMPLEMENTATION ***/
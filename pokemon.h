@@ -8,21 +8,78 @@
  * 
  * This file defines an Abstract Base Class (ABC) `Pokemon` and three derived classes (`Fire`, `Water`, `Grass`).
  * Each Pokemon type implements common battle actions: `attack`, `defend`, and `heal`. 
+ * Combat methods don't print; they return their value and raise an event on the `Battle_events`
+ * sink they are given (see events.h).
  * 
  * `Pokemon` provides shared attributes (`name` and `health`) and virtual methods for dynamic binding.
+ * Pokemon are flyweights: name, type and stats live in one shared `Species` record, so a Pokemon
+ * holds only that pointer, its health, a unique instance id and a `Health_observer` told about
+ * every health change. The species id is the name's alphabetical rank, so ordering by
+ * (species id, instance id) is ordering by name, oldest first.
  * `Fire` includes a unique `fly` method, demonstrating RTTI usage.
  * 
  * Comparison operators (`<` and `>=`) support Binary Search Tree (BST) storage for organizing Pokemon.
  */
 
+#ifndef POKEMON_H
+#define POKEMON_H
+
 #include <string>
 #include <vector>
 #include <random>
 #include <iostream>
 #include <memory>
+#include "rng.h"
+#include "events.h"
 
 using namespace std;
 
+/* Battle actions, the same codes the battle menu takes. */
+const int ATTACK = 1;	//attack()
+const int SPECIAL = 2;	//special_ability()
+
+/* Pokemon types, the same codes set_name() takes. */
+const int FIRE = 1;
+const int WATER = 2;
+const int GRASS = 3;
+
+/* Starting stats. Every Pokemon of a type starts with exactly these. */
+const int FULL_HEALTH = 100;
+const int FIRE_ATTACK_POWER = 50;
+const int FIRE_DEFEND_POWER = 30;
+const int FIRE_FLY_POWER = 20;
+const int FIRE_BURN_DAMAGE = 15;
+const int WATER_ATTACK_POWER = 40;
+const int WATER_DEFEND_POWER = 35;
+const int WATER_SPLASH_RESISTANCE = 20;
+const int GRASS_ATTACK_POWER = 45;
+const int GRASS_DEFEND_POWER = 25;
+const int GRASS_ENTANGLE = 15;
+const int SPECIES_COUNT = 15;		//distinct names, 5 per type.
+
+/* This struct is the shared, immutable record of one species. */
+struct Species
+{
+	string name;		//the species name.
+	int id;			//interned species id (alphabetical rank), -1 for "not named yet".
+	int type;		//FIRE, WATER or GRASS.
+	int index;		//which of its type's five names.
+	int attack_power;	//damage of attack() before type extras.
+	int defend_power;	//damage defend() blocks.
+	int special_power;	//burn damage (Fire), splash resistance (Water), entangle (Grass).
+	int fly_power;		//dodge power of Fire::fly (0 for the others).
+};
+
+class Pokemon;
+
+/* This class is told whenever a Pokemon's health changes. */
+class Health_observer
+{
+	public:
+		virtual ~Health_observer();	//virtual destructor so the right one gets called for derived class
+		virtual void on_health_change(Pokemon & pokemon, int old_health)=0;	//health went from old_health to get_health().
+};
+
 /* This class is the base class in the core hierarchy, and is also 
  * a Abstract Base Class (ABC) with only one pure virtual function -- display().
  */
@@ -30,19 +87,37 @@ class Pokemon
 {
 	public:
 		Pokemon();			//default constructor
+		Pokemon(const Pokemon & source);	//copies everything but the observer.
+		Pokemon & operator=(const Pokemon & source);	//copies everything but the observer, and tells it about the health.
 		int heal();					//heals health by a random amount.
 		int set_name(int type);		//sets the name according the type of pokemon.
+		int set_species(int type, int index);	//sets the name to one of the type's five names.
+		int get_species() const;	//which of its type's five names this is (-1 if none).
+		int get_species_id() const;	//interned name, 0 .. SPECIES_COUNT - 1 in name order (-1 if none).
+		uint32_t get_id() const;	//unique instance id.
+		static int species_id(const string & name);	//interned id of a name, -1 if it isn't a species.
+		static int species_with_prefix(const string & prefix, int & first, int & end);	//ids first .. end - 1 have names starting with prefix (any case); returns how many.
+		static int name_distance(const string & typed, int species_id, int most);	//edits (any case) from typed to the species name, most + 1 if more than most.
+		static const string & species_name(int species_id);	//the name of an interned id ("" if invalid).
+		const Species & get_species_record() const;	//the shared species record.
+		static const Species * find_species(int species_id);	//the shared record of an id, nullptr if invalid.
 		int random_num(int min, int max);	//returns a random number from the given range.
 		int input(int min, int max);		//used for input validation and error checking.
-		int get_health();		//returns health for battle logic.
+		int get_health() const;		//returns health for battle logic.
 		void reduce_health(int damage);	//takes damage for battle logic.
+		void set_health(int new_health);	//sets health directly (replaying logs).
+		void set_observer(Health_observer * to_set);	//who is told about health changes (nullptr: nobody).
 		const string & get_name() const;	//returns name for battle logic.
 		/* VIRTUAL METHODS -- MUST IMPLEMENT IN DERIVED CLASSES */
 		virtual ~Pokemon();	//virtual destructor so the right one gets called for dervied class
 		virtual void display();		//displays the name
-		virtual int attack()=0;		// 1 of 3 common characteristics -- pure virtual function
-		virtual int defend()=0;		// 2 of 3 common characteristics -- pure virtual function
-		virtual int special_ability()=0;			// 3 of 3 common characteristics
+		virtual int attack(Battle_events & events)=0;		// 1 of 3 common characteristics -- pure virtual function
+		virtual int defend(Battle_events & events)=0;		// 2 of 3 common characteristics -- pure virtual function
+		virtual int special_ability(Battle_events & events)=0;			// 3 of 3 common characteristics
+		virtual int get_attack() const=0;	//damage attack() deals, without printing.
+		virtual int get_special() const=0;	//damage special_ability() deals, without printing.
+		virtual int get_defend() const=0;	//damage defend() blocks, without printing.
+		virtual int get_type() const=0;		//FIRE, WATER or GRASS.
 		virtual bool operator <(const Pokemon * op2);	//needed for BST Tree implementation
 		virtual bool operator >(const Pokemon * op2);	//needed for BST Tree implementation
 		virtual bool operator >=(const Pokemon * op2);	//needed for BST Tree implementation
@@ -50,8 +125,12 @@ class Pokemon
 		virtual bool operator ==(const Pokemon * op2);	//needed for BST Tree implementation
 		virtual bool operator !=(const Pokemon * op2);	//needed for BST Tree implementation
 	protected:
-		string name;	//name of the pokemon.
+		const Species * species;	//shared name, type and stats (UNNAMED until named).
 		int health;		// health of the pokemon (from 1-100).
+		uint32_t id;	//unique instance id.
+		Health_observer * observer;	//told about health changes, nullptr if nobody is.
+		void health_changed(int old_health);	//tells the observer, if health did change.
+		static const Species UNNAMED;	//the record of a Pokemon that has no name yet.
 };
 
 /* This class is a specialized version of Pokemon, representing the Fire
@@ -65,22 +144,20 @@ class Fire: public Pokemon
 		Fire();			//default constructor 
 		~Fire();			//destructor
 		void display();		//displays all info.
-		int attack();		// 1 of 3 common characteristics
-		int defend();		// 2 of 3 common characteristics
-		int special_ability();			// 3 of 3 common characteristics
-		int fly();			//special characteristics -- RTTI needed to call
+		int attack(Battle_events & events);		// 1 of 3 common characteristics
+		int defend(Battle_events & events);		// 2 of 3 common characteristics
+		int special_ability(Battle_events & events);			// 3 of 3 common characteristics
+		int fly(Battle_events & events);			//special characteristics -- RTTI needed to call
+		int get_attack() const;		//attack power + burn damage.
+		int get_special() const;	//double the burn damage.
+		int get_defend() const;		//defend power.
+		int get_type() const;		//type code.
 		bool operator <(const Pokemon * op2);	//needed for BST Tree implementation
 		bool operator >(const Pokemon * op2);	//needed for BST Tree implementation
 		bool operator >=(const Pokemon * op2);	//needed for BST Tree implementation
 		bool operator <=(const Pokemon * op2);	//needed for BST Tree implementation
 		bool operator ==(const Pokemon * op2);	//needed for BST Tree implementation
 		bool operator !=(const Pokemon * op2);	//needed for BST Tree implementation
-
-	protected:
-		int attack_power;	//level of damage to other player.
-		int defend_power;	//level of damage to defend w/o affecting health.
-		int fly_power;  	//dodge attacks by flying up.
-		int burn_damage;  	//additional damage by burning.
 };
 
 /* This class is a specialized version of Pokemon, representing the Water
@@ -93,20 +170,19 @@ class Water: public Pokemon
 		Water();			//default constructor
 		~Water();			//destructor
 		void display();		//displays all info
-		int attack();		// 1 of 3 common characteristics
-		int defend();		// 2 of 3 common characteristics
-		int special_ability();			// 3 of 3 common characteristics
+		int attack(Battle_events & events);		// 1 of 3 common characteristics
+		int defend(Battle_events & events);		// 2 of 3 common characteristics
+		int special_ability(Battle_events & events);			// 3 of 3 common characteristics
+		int get_attack() const;		//attack power.
+		int get_special() const;	//splash resistance.
+		int get_defend() const;		//defend power.
+		int get_type() const;		//type code.
 		bool operator <(const Pokemon * op2);	//needed for BST Tree implementation
 		bool operator >(const Pokemon * op2);	//needed for BST Tree implementation
 		bool operator >=(const Pokemon * op2);	//needed for BST Tree implementation
 		bool operator <=(const Pokemon * op2);	//needed for BST Tree implementation
 		bool operator ==(const Pokemon * op2);	//needed for BST Tree implementation
 		bool operator !=(const Pokemon * op2);	//needed for BST Tree implementation
-
-	protected:
-		int attack_power;	//level of damage to other player.
-		int defend_power;	//level of damage to defend w/o affecting health.
-		int splash_resistance;	//reduces burn damage by half.
 };
 
 /* This class is a specialized version of Pokemon, representing the Grass
@@ -119,21 +195,19 @@ class Grass: public Pokemon
 		Grass();			//default constructor
 		~Grass();			//destructor
 		void display();		// displays all info.
-		int attack();		// 1 of 3 common characteristics
-		int defend();		// 2 of 3 common characteristics
-		int special_ability();			// 3 of 3 common characteristics
+		int attack(Battle_events & events);		// 1 of 3 common characteristics
+		int defend(Battle_events & events);		// 2 of 3 common characteristics
+		int special_ability(Battle_events & events);			// 3 of 3 common characteristics
+		int get_attack() const;		//attack power.
+		int get_special() const;	//entangle power.
+		int get_defend() const;		//defend power.
+		int get_type() const;		//type code.
 		bool operator <(const Pokemon * op2);	//needed for BST Tree implementation
 		bool operator >(const Pokemon * op2);	//needed for BST Tree implementation
 		bool operator >=(const Pokemon * op2);	//needed for BST Tree implementation
 		bool operator <=(const Pokemon * op2);	//needed for BST Tree implementation
 		bool operator ==(const Pokemon * op2);	//needed for BST Tree implementation
 		bool operator !=(const Pokemon * op2);	//needed for BST Tree implementation
-
-	protected:
-		int attack_power;	//level of damage to other player.
-		int defend_power;	//level of damage to defend w/o affecting health.
-		int entangle;		//stops opponents from defending.
 };
 
-
-
+#endif
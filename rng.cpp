@@ -0,0 +1,236 @@
+// Author: Pokemon Battle contributors
+// Date: 10-17-2026
+//
+// This file contains the implementation of the RNG class.
+
+/*
+ * Overview:
+ * - The global seed and a "generation" counter are shared atomics. Every thread keeps
+ *   its own engine plus the generation it was seeded at.
+ * - `engine()` only reseeds when the generation has changed (first use, or after
+ *   `set_seed`/`clear_seed`), so the common path is a thread local read and a compare.
+ * - Threads are numbered in the order they first draw a number; the main thread is 0.
+ * - `random_num` checks for a bound `Stream` first, so code that already calls
+ *   `Pokemon::random_num`/`Trainer::random_num` needs no changes to become reproducible
+ *   under a parallel runner.
+ */
+
+#include "rng.h"
+#include <atomic>
+
+static std::atomic<uint64_t> global_seed{0};		//seed set from the command line.
+static std::atomic<bool> seeded{false};			//true once set_seed has been called.
+static std::atomic<unsigned> generation{1};		//bumped every time the seed changes.
+static std::atomic<unsigned> next_thread_index{0};	//hands out thread indices.
+
+//per thread engine and the bookkeeping needed to reseed it.
+struct Thread_engine
+{
+	std::mt19937 gen;		//the engine itself.
+	unsigned generation{0};		//generation the engine was seeded at.
+	unsigned index;			//this thread's index.
+	Thread_engine(): index(next_thread_index.fetch_add(1)) {}
+};
+
+static thread_local Thread_engine local;	//one engine per thread.
+static thread_local Stream * bound_stream = nullptr;	//stream bound by a Stream_scope.
+
+//sets the global seed, every thread reseeds on its next draw.
+void RNG::set_seed(uint64_t seed)
+{
+	global_seed.store(seed);
+	seeded.store(true);
+	generation.fetch_add(1);
+}
+
+//drops the global seed, engines go back to random_device.
+void RNG::clear_seed()
+{
+	seeded.store(false);
+	global_seed.store(0);
+	generation.fetch_add(1);
+}
+
+//returns true if a global seed is in effect.
+bool RNG::is_seeded()
+{
+	return seeded.load();
+}
+
+//returns the global seed.
+uint64_t RNG::get_seed()
+{
+	return global_seed.load();
+}
+
+//returns this thread's engine, seeding it first if needed.
+std::mt19937 & RNG::engine()
+{
+	unsigned current = generation.load(std::memory_order_relaxed);
+	if (local.generation != current)
+	{
+		if (seeded.load())
+		{
+			uint64_t seed = mix(global_seed.load() ^ mix(local.index + 1));
+			std::seed_seq seq{uint32_t(seed), uint32_t(seed >> 32)};
+			local.gen.seed(seq);
+		}
+		else
+		{
+			std::random_device rd;
+			std::seed_seq seq{rd(), rd(), rd(), rd()};
+			local.gen.seed(seq);
+		}
+		local.generation = current;
+	}
+	return local.gen;
+}
+
+//returns a random number from the given range
+int RNG::random_num(int min, int max)
+{
+	if (min > max) {
+		throw "Invalid Range: min should be <= max.";
+	}
+	if (bound_stream)
+		return bound_stream->random_num(min, max);
+	std::uniform_int_distribution<> distrib(min, max);
+	return distrib(engine());
+}
+
+//returns the stream bound to this thread.
+Stream * RNG::current_stream()
+{
+	return bound_stream;
+}
+
+//binds a stream to this thread.
+void RNG::bind(Stream * to_bind)
+{
+	bound_stream = to_bind;
+}
+
+//splitmix64 finalizer.
+uint64_t RNG::mix(uint64_t value)
+{
+	value += 0x9E3779B97F4A7C15ULL;
+	value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+	return value ^ (value >> 31);
+}
+
+
+
+/****** PHILOX IMPLEMENTATION ******/
+
+//one Philox4x32 block: 10 rounds of multiply/xor with a bumped key.
+void Philox::block(const uint32_t counter[4], const uint32_t key[2], uint32_t out[4])
+{
+	const uint32_t M0 = 0xD2511F53, M1 = 0xCD9E8D57;
+	const uint32_t W0 = 0x9E3779B9, W1 = 0xBB67AE85;
+	uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+	uint32_t k0 = key[0], k1 = key[1];
+
+	for (int round = 0; round < 10; ++round)
+	{
+		uint64_t p0 = uint64_t(M0) * c0;
+		uint64_t p1 = uint64_t(M1) * c2;
+		uint32_t n0 = uint32_t(p1 >> 32) ^ c1 ^ k0;
+		uint32_t n2 = uint32_t(p0 >> 32) ^ c3 ^ k1;
+		c0 = n0;
+		c1 = uint32_t(p1);
+		c2 = n2;
+		c3 = uint32_t(p0);
+		k0 += W0;
+		k1 += W1;
+	}
+	out[0] = c0;
+	out[1] = c1;
+	out[2] = c2;
+	out[3] = c3;
+}
+
+
+/****** STREAM IMPLEMENTATION ******/
+
+//stream for one battle of one seed, starting at the given turn.
+Stream::Stream(uint64_t seed, uint64_t battle_id, uint32_t turn)
+	: key{uint32_t(seed), uint32_t(seed >> 32)},
+	  counter{uint32_t(battle_id), uint32_t(battle_id >> 32), turn, 0},
+	  buffer{0, 0, 0, 0}, used(4)
+{}
+
+//stream for one battle under the global seed.
+Stream::Stream(uint64_t battle_id): Stream(RNG::get_seed(), battle_id)
+{}
+
+//jumps to the first block of the given turn.
+void Stream::set_turn(uint32_t turn)
+{
+	counter[2] = turn;
+	counter[3] = 0;
+	used = 4;
+}
+
+//returns the current turn.
+uint32_t Stream::get_turn() const
+{
+	return counter[2];
+}
+
+//returns the battle id.
+uint64_t Stream::get_battle_id() const
+{
+	return uint64_t(counter[0]) | (uint64_t(counter[1]) << 32);
+}
+
+//hands out the buffered block, generating the next block when it runs dry.
+uint32_t Stream::next_u32()
+{
+	if (used == 4)
+	{
+		Philox::block(counter, key, buffer);
+		++counter[3];
+		used = 0;
+	}
+	return buffer[used++];
+}
+
+//unbiased multiply-shift range reduction (Lemire), identical on every platform.
+int Stream::random_num(int min, int max)
+{
+	if (min > max) {
+		throw "Invalid Range: min should be <= max.";
+	}
+	uint64_t range = uint64_t(int64_t(max) - int64_t(min)) + 1;
+	if (range > 0xFFFFFFFFULL)
+		return int(int64_t(min) + next_u32());	//full 32 bit range.
+
+	uint64_t product = uint64_t(next_u32()) * range;
+	uint32_t low = uint32_t(product);
+	if (low < range)
+	{
+		uint32_t threshold = uint32_t(-uint32_t(range)) % uint32_t(range);
+		while (low < threshold)
+		{
+			product = uint64_t(next_u32()) * range;
+			low = uint32_t(product);
+		}
+	}
+	return int(int64_t(min) + int64_t(product >> 32));
+}
+
+
+/****** STREAM_SCOPE IMPLEMENTATION ******/
+
+//binds the stream, remembering what it replaces.
+Stream_scope::Stream_scope(Stream & to_bind): previous(RNG::current_stream())
+{
+	RNG::bind(&to_bind);
+}
+
+//restores the previous binding.
+Stream_scope::~Stream_scope()
+{
+	RNG::bind(previous);
+}
@@ -0,0 +1,97 @@
+// Author: Pokemon Battle contributors
+// Date: 10-17-2026
+//
+// This file contains the class declaration for the random number subsystem used in this project.
+
+/*
+ * Random Number Generation for Pokemon Battle Simulation
+ *
+ * `RNG` owns one `mt19937` engine per thread. Each engine is seeded exactly once (on its
+ * first use) instead of building a `random_device` and a fresh engine on every call.
+ *
+ * - Without a global seed, every thread's engine is seeded from `random_device`.
+ * - With a global seed (`set_seed`, e.g. from `--seed N` on the command line), every
+ *   thread's engine is derived from that seed and the thread's index, so runs can be
+ *   reproduced exactly.
+ *
+ * Per-thread engines are only reproducible if work lands on the same thread every run.
+ * For parallel simulations there are counter-based streams as well:
+ * - `Philox` is the Philox4x32-10 block function: a pure function of (counter, key).
+ * - `Stream` is addressed by (seed, battle id, turn). The same address always gives the
+ *   same numbers, on any thread, in any order.
+ * - `Stream_scope` binds a stream to the current thread. While it is alive every
+ *   `RNG::random_num` call (and so every `Pokemon::random_num`/`Trainer::random_num`)
+ *   draws from that stream instead of the thread's engine.
+ */
+
+#ifndef RNG_H
+#define RNG_H
+
+#include <random>
+#include <cstdint>
+
+class Stream;
+
+/* This class is the shared random number subsystem. All members are static,
+ * the engines themselves live in thread local storage.
+ */
+class RNG
+{
+	public:
+		static void set_seed(uint64_t seed);	//sets the global seed and reseeds every engine on next use.
+		static void clear_seed();	//goes back to seeding from random_device.
+		static bool is_seeded();	//true if a global seed has been set.
+		static uint64_t get_seed();	//returns the global seed (0 if not seeded).
+		static int random_num(int min, int max);	//returns a random number from the given range.
+		static std::mt19937 & engine();	//returns this thread's engine.
+		static Stream * current_stream();	//stream bound to this thread (nullptr if none).
+		static uint64_t mix(uint64_t value);	//splitmix64 finalizer used to derive seeds.
+	private:
+		friend class Stream_scope;
+		static void bind(Stream * to_bind);	//binds a stream to this thread.
+};
+
+/* This class is the Philox4x32-10 counter-based block function. It maps a
+ * 128 bit counter and a 64 bit key to 128 random bits, with no state.
+ */
+class Philox
+{
+	public:
+		static void block(const uint32_t counter[4], const uint32_t key[2], uint32_t out[4]);	//one 10 round block.
+};
+
+/* This class is a random stream addressed by (seed, battle id, turn). Moving
+ * to a turn is O(1), so any battle or turn can be regenerated on its own.
+ */
+class Stream
+{
+	public:
+		Stream(uint64_t seed, uint64_t battle_id, uint32_t turn = 0);	//stream for one battle.
+		explicit Stream(uint64_t battle_id);	//stream for one battle under the global seed.
+		void set_turn(uint32_t turn);	//moves to the start of the given turn.
+		uint32_t get_turn() const;	//returns the current turn.
+		uint64_t get_battle_id() const;	//returns the battle id.
+		uint32_t next_u32();	//returns the next 32 random bits.
+		int random_num(int min, int max);	//returns an unbiased random number from the given range.
+	private:
+		uint32_t key[2];	//the seed.
+		uint32_t counter[4];	//battle id (2 words), turn, block index within the turn.
+		uint32_t buffer[4];	//output of the current block.
+		int used;		//how many words of the buffer have been handed out.
+};
+
+/* This class binds a stream to the current thread for as long as it is alive,
+ * restoring whatever was bound before when it goes away.
+ */
+class Stream_scope
+{
+	public:
+		explicit Stream_scope(Stream & to_bind);	//binds the stream.
+		~Stream_scope();	//restores the previous stream.
+		Stream_scope(const Stream_scope &) = delete;
+		Stream_scope & operator=(const Stream_scope &) = delete;
+	private:
+		Stream * previous;	//what was bound before this scope.
+};
+
+#endif
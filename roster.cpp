@@ -0,0 +1,1964 @@
+// Author: Pokemon Battle contributors
+// Date: 10-17-2026
+//
+// This file contains the implementation for the Roster class (the trainers' B-tree).
+
+/*
+ * Overview:
+ * - Insert splits full nodes on the way down, so it never has to walk back up.
+ * - Remove makes sure every node it descends into has at least ROSTER_DEGREE entries
+ *   (borrowing from a sibling or merging with one), so deleting never underflows.
+ *   An entry removed from an inner node is replaced by the exact last entry of its
+ *   left subtree (or first of its right), so copies sharing an id are never mixed up.
+ * - A name becomes the key range [(species, 0), (species + 1, 0)); the first Pokemon with
+ *   the name is the smallest key in that range.
+ * - Persistence: nodes and pooled Pokemon count their references (a roster's root, a parent's
+ *   child pointer, a node's value). A write makes every node on its path this roster's own
+ *   first (own()), top down: a node counted once is only reachable through this path, so it
+ *   changes in place; any other is copied (its children and Pokemon gain a reference) and
+ *   loses the path's reference. Whatever loses its last reference goes back to the pool there
+ *   and then (unref()), so dropping a snapshot frees exactly what nobody else holds.
+ * - A pooled Pokemon keeps its count in the slot just before it (POKEMON_HEADER), so Pokemon
+ *   doesn't grow. retrieve_for_update() clones a Pokemon counted more than once.
+ * - Rosters sharing a store may run on different threads. The store locks its pools and its
+ *   watches, and counts are atomic. A count of one can't go up behind this roster's back:
+ *   another roster could only add a reference through a node it already holds.
+ * - bulk_load builds each subtree from the fewest children that can hold its entries, spread
+ *   evenly; that keeps every node at least half full, and recursion only goes as deep as the
+ *   tree is tall.
+ * - The index follows the tree: add() and bulk_load() add keys, a removal or a clone looks the
+ *   key (and, if it was its species' first, the next one) up in the tree again. While nobody
+ *   else uses the store, retrieve_for_update() hands out the indexed Pokemon directly: no
+ *   other roster can see it, so nothing has to be copied.
+ * - Aggregates: a write recomputes the subtree count of every node it changed, bottom up
+ *   (insert only bumps them on the way down). Split, merge and borrow keep a subtree's entries,
+ *   so only the nodes whose entries moved are recomputed. Health lives outside the tree: a
+ *   health change checks the Pokemon is in the tree (read only), then moves it in the health
+ *   counts and the health index, so it never copies a node.
+ * - The health index is a list of sorted pages (a B-tree two levels deep), shared with
+ *   snapshots page by page like the hash index. An entry remembers the health it was indexed
+ *   under; a Pokemon changed through another roster sharing it (which that roster hears about,
+ *   not this one) is still found for removal by a scan, and listings check the live health.
+ * - Nodes and Pokemon live in the roster's two pools. Pokemon hold no resources of their own
+ *   (their names and stats live in the shared species records), so remove_all() can reset the
+ *   pools without running a destructor per object.
+ */
+
+#include "data_structures.h"
+#include <algorithm>
+#include <cstddef>
+#include <climits>
+#include <atomic>
+#include <thread>
+
+const size_t POOL_FIRST_SLOTS = 64;		//slots in a pool's first chunk.
+const size_t POOL_MAX_CHUNK_BYTES = 1 << 20;	//chunks stop doubling at about this size.
+const size_t POOL_HEADER = alignof(max_align_t) * ((2 * sizeof(void *) + alignof(max_align_t) - 1) / alignof(max_align_t));	//chunk header, padded.
+const size_t POKEMON_HEADER = sizeof(void *);	//room for the reference count in front of a pooled Pokemon.
+const size_t POKEMON_SLOT = POKEMON_HEADER + max({sizeof(Fire), sizeof(Water), sizeof(Grass)});	//any Pokemon fits.
+const size_t INDEX_FIRST_SLOTS = 16;	//slots in an index's first table.
+const size_t HEALTH_FIRST_RANGE = 128;	//healths health counts cover at first (a power of two above FULL_HEALTH).
+const uint64_t HASH_MULTIPLIER = 0x9E3779B97F4A7C15ULL;	//2^64 / golden ratio, spreads sequential ids.
+
+static_assert(alignof(Roster_node) <= alignof(void *) && alignof(Fire) <= alignof(void *)
+	&& alignof(Water) <= alignof(void *) && alignof(Grass) <= alignof(void *),
+	"pool slots are only pointer aligned");
+static_assert(sizeof(atomic<int>) <= POKEMON_HEADER && alignof(atomic<int>) <= alignof(void *),
+	"a Pokemon's reference count fits in front of it");
+
+//true if the pointer is the only one to its object. use_count() is a relaxed read, so the fence
+//orders what follows after whatever another thread did before it dropped its copy.
+template <typename T>
+static bool sole(const shared_ptr<T> & pointer)
+{
+	if (pointer.use_count() != 1)
+		return false;
+	atomic_thread_fence(memory_order_acquire);
+	return true;
+}
+
+//deep copy with the right derived type.
+Pokemon * clone_pokemon(const Pokemon * source)
+{
+	if (const Fire * fire = dynamic_cast<const Fire *>(source))
+		return new Fire(*fire);
+	if (const Water * water = dynamic_cast<const Water *>(source))
+		return new Water(*water);
+	if (const Grass * grass = dynamic_cast<const Grass *>(source))
+		return new Grass(*grass);
+	return nullptr;
+}
+
+//an empty node, referenced once.
+Roster_node::Roster_node(bool leaf): count(0), leaf(leaf), total(0), refs(1)
+{}
+
+//empty pools sized for nodes and Pokemon.
+Roster_store::Roster_store(): nodes(sizeof(Roster_node)), pokemons(POKEMON_SLOT)
+{}
+
+//reuses the watch of a roster that is gone, else makes one.
+Roster_watch * Roster_store::watch(Roster * roster)
+{
+	lock_guard<mutex> hold(lock);
+	for (unique_ptr<Roster_watch> & kept : watches)
+		if (!kept->roster)
+		{
+			kept->roster = roster;
+			return kept.get();
+		}
+	watches.emplace_back(new Roster_watch(roster));
+	return watches.back().get();
+}
+
+//the roster is going (or moving): its Pokemon tell nobody, and another roster may take the watch.
+void Roster_store::unwatch(Roster_watch * watch)
+{
+	lock_guard<mutex> hold(lock);
+	watch->roster = nullptr;
+}
+
+//a slot from one of the pools.
+void * Roster_store::allocate(Roster_pool & pool)
+{
+	lock_guard<mutex> hold(lock);
+	return pool.allocate();
+}
+
+//gives a slot back to its pool.
+void Roster_store::release(Roster_pool & pool, void * slot)
+{
+	lock_guard<mutex> hold(lock);
+	pool.release(slot);
+}
+
+//every slot of the pool is free again.
+void Roster_store::reset(Roster_pool & pool)
+{
+	lock_guard<mutex> hold(lock);
+	pool.reset();
+}
+
+//chunks held by both pools.
+int Roster_store::chunks()
+{
+	lock_guard<mutex> hold(lock);
+	return nodes.chunks() + pokemons.chunks();
+}
+
+//watches for the roster.
+Roster_watch::Roster_watch(Roster * roster): roster(roster)
+{}
+
+//passes the change on; the roster checks the Pokemon is really its own.
+void Roster_watch::on_health_change(Pokemon & pokemon, int old_health)
+{
+	if (roster)
+		roster->health_changed(pokemon, old_health);
+}
+
+
+/****** HEALTH COUNTS IMPLEMENTATION ******/
+
+//healths 0 .. HEALTH_FIRST_RANGE - 1 to start with.
+Health_counts::Health_counts(): tree(HEALTH_FIRST_RANGE + 1, 0), entries(0)
+{}
+
+//point update; a health past the range doubles it first. Doubling a Fenwick tree of size n only
+//sets tree[2n] (everything so far); the other new cells cover healths nobody has yet.
+void Health_counts::add(int health, int change)
+{
+	health = max(health, 0);
+	size_t range = tree.size() - 1;
+	while (size_t(health) >= range)
+	{
+		tree.resize(2 * range + 1, 0);
+		tree[2 * range] = entries;
+		range *= 2;
+	}
+	for (size_t i = size_t(health) + 1; i <= range; i += i & (~i + 1))
+		tree[i] += change;
+	entries += change;
+}
+
+//prefix sum over healths 0 .. health - 1.
+int Health_counts::count_below(int health) const
+{
+	size_t end = min(size_t(max(health, 0)), tree.size() - 1);
+	int below = 0;
+	for (size_t i = end; i > 0; i -= i & (~i + 1))
+		below += tree[i];
+	return below;
+}
+
+//Pokemon with low <= health <= high.
+int Health_counts::count_range(int low, int high) const
+{
+	if (high < low || high < 0)
+		return 0;
+	int top = int(min(size_t(high), tree.size() - 2));	//no overflow for high = INT_MAX.
+	return count_below(top + 1) - count_below(low);
+}
+
+//the (entries - k + 1)-th smallest health, by binary lifting down the tree.
+int Health_counts::kth_highest(int k) const
+{
+	if (k < 1 || k > entries)
+		return -1;
+	int wanted = entries - k + 1;
+	size_t range = tree.size() - 1;
+	size_t at = 0;
+	for (size_t step = range; step > 0; step /= 2)
+		if (at + step <= range && tree[at + step] < wanted)
+		{
+			at += step;
+			wanted -= tree[at];
+		}
+	return int(at);		//cell at + 1 holds health at.
+}
+
+//Pokemon counted.
+int Health_counts::total() const
+{
+	return entries;
+}
+
+//counts nothing, back to the first range.
+void Health_counts::clear()
+{
+	tree.assign(HEALTH_FIRST_RANGE + 1, 0);
+	entries = 0;
+}
+
+
+/****** ROSTER POOL IMPLEMENTATION ******/
+
+//no chunks until the first allocation; slots are rounded up to whole pointers.
+Roster_pool::Roster_pool(size_t slot_size):
+	slot_size((max(slot_size, sizeof(void *)) + sizeof(void *) - 1) / sizeof(void *) * sizeof(void *)),
+	first(nullptr), current(nullptr), next_slot(nullptr), end(nullptr), free_list(nullptr), chunk_count(0)
+{}
+
+//frees every chunk.
+Roster_pool::~Roster_pool()
+{
+	while (first)
+	{
+		Chunk * next = first->next;
+		::operator delete(first);
+		first = next;
+	}
+}
+
+//the first slot of a chunk, after its header padded to the strictest alignment.
+char * Roster_pool::slots_of(Chunk * chunk)
+{
+	static_assert(sizeof(Chunk) <= POOL_HEADER, "chunk header doesn't fit");
+	return reinterpret_cast<char *>(chunk) + POOL_HEADER;
+}
+
+//a released slot if there is one, else the next unused slot, moving on to a kept or new chunk.
+void * Roster_pool::allocate()
+{
+	if (free_list)
+	{
+		void * slot = free_list;
+		free_list = *static_cast<void **>(slot);
+		return slot;
+	}
+	if (next_slot == end)
+	{
+		if (current && current->next)
+			current = current->next;	//reuse a chunk kept by reset().
+		else
+		{
+			size_t most = max(POOL_FIRST_SLOTS, POOL_MAX_CHUNK_BYTES / slot_size);
+			size_t slots = current ? min(current->slots * 2, most) : POOL_FIRST_SLOTS;
+			Chunk * made = static_cast<Chunk *>(::operator new(POOL_HEADER + slots * slot_size));
+			made->next = nullptr;
+			made->slots = slots;
+			if (current)
+				current->next = made;
+			else
+				first = made;
+			current = made;
+			++chunk_count;
+		}
+		next_slot = slots_of(current);
+		end = next_slot + current->slots * slot_size;
+	}
+	void * slot = next_slot;
+	next_slot += slot_size;
+	return slot;
+}
+
+//pushes the slot on the free list.
+void Roster_pool::release(void * slot)
+{
+	*static_cast<void **>(slot) = free_list;
+	free_list = slot;
+}
+
+//starts carving from the first chunk again.
+void Roster_pool::reset()
+{
+	current = first;
+	next_slot = first ? slots_of(first) : nullptr;
+	end = first ? next_slot + first->slots * slot_size : nullptr;
+	free_list = nullptr;
+}
+
+//chunks allocated so far.
+int Roster_pool::chunks() const
+{
+	return chunk_count;
+}
+
+
+/****** ROSTER INDEX IMPLEMENTATION ******/
+
+//no table until the first key.
+Roster_index::Roster_index(): capacity(0), page_bits(0), used(0), shift(64)
+{
+	fill(firsts, firsts + SPECIES_COUNT, NO_KEY);
+}
+
+//multiplicative (Fibonacci) hashing: the top bits of key * 2^64 / golden ratio.
+size_t Roster_index::home(uint64_t key) const
+{
+	return size_t((key * HASH_MULTIPLIER) >> shift);
+}
+
+//a slot to read.
+const Roster_index::Slot & Roster_index::at(size_t slot) const
+{
+	return pages[slot >> page_bits][slot & ((size_t(1) << page_bits) - 1)];
+}
+
+//a slot to write; a page another index still shares is copied first.
+Roster_index::Slot & Roster_index::writable(size_t slot)
+{
+	Page & page = pages[slot >> page_bits];
+	if (!sole(page))
+	{
+		size_t page_slots = size_t(1) << page_bits;
+		Page made(new Slot[page_slots]);
+		copy(page.get(), page.get() + page_slots, made.get());
+		page = made;
+	}
+	return page[slot & ((size_t(1) << page_bits) - 1)];
+}
+
+//probes from the key's home slot to the key or the first empty slot (the table is never full).
+size_t Roster_index::slot_of(uint64_t key) const
+{
+	size_t mask = capacity - 1;
+	size_t slot = home(key);
+	while (at(slot).key != key && at(slot).key != NO_KEY)
+		slot = (slot + 1) & mask;
+	return slot;
+}
+
+//the Pokemon under the key.
+Pokemon * Roster_index::find(uint64_t key) const
+{
+	if (capacity == 0)
+		return nullptr;
+	const Slot & slot = at(slot_of(key));
+	return slot.key == key ? slot.pokemon : nullptr;
+}
+
+//smallest key of the species.
+uint64_t Roster_index::first_of(int species_id) const
+{
+	return species_id >= 0 && species_id < SPECIES_COUNT ? firsts[species_id] : NO_KEY;
+}
+
+//adds the key if it is new, and lowers its species' first key.
+void Roster_index::add(uint64_t key, Pokemon * pokemon)
+{
+	reserve(used + 1);
+	size_t slot = slot_of(key);
+	if (at(slot).key == NO_KEY)
+	{
+		writable(slot) = Slot{key, pokemon};
+		++used;
+	}
+	int species = int(key >> 32) - 1;
+	if (species >= 0 && species < SPECIES_COUNT && key < firsts[species])
+		firsts[species] = key;
+}
+
+//adds the key or points it at another Pokemon.
+void Roster_index::put(uint64_t key, Pokemon * pokemon)
+{
+	reserve(used + 1);
+	size_t slot = slot_of(key);
+	if (at(slot).key == NO_KEY)
+		++used;
+	writable(slot) = Slot{key, pokemon};
+}
+
+//empties the key's slot, then moves back every later entry of the run that probed past it.
+void Roster_index::erase(uint64_t key)
+{
+	if (capacity == 0)
+		return;
+	size_t mask = capacity - 1;
+	size_t hole = slot_of(key);
+	if (at(hole).key != key)
+		return;
+	for (size_t next = (hole + 1) & mask; at(next).key != NO_KEY; next = (next + 1) & mask)
+	{
+		//an entry may fill the hole only if its home isn't between the hole and where it is.
+		if (((next - home(at(next).key)) & mask) >= ((next - hole) & mask))
+		{
+			writable(hole) = at(next);
+			hole = next;
+		}
+	}
+	writable(hole).key = NO_KEY;
+	--used;
+}
+
+//sets the smallest key of a species.
+void Roster_index::set_first(int species_id, uint64_t key)
+{
+	if (species_id >= 0 && species_id < SPECIES_COUNT)
+		firsts[species_id] = key;
+}
+
+//doubles the table until count keys fill at most half of it.
+void Roster_index::reserve(size_t count)
+{
+	size_t wanted = max(capacity, INDEX_FIRST_SLOTS);
+	while (wanted < 2 * count)
+		wanted *= 2;
+	if (wanted != capacity)
+		rehash(wanted);
+}
+
+//lets go of the table, so clearing doesn't cost a pass over it.
+void Roster_index::clear()
+{
+	vector<Page>().swap(pages);
+	capacity = 0;
+	page_bits = 0;
+	used = 0;
+	shift = 64;
+	fill(firsts, firsts + SPECIES_COUNT, NO_KEY);
+}
+
+//keys in the index.
+int Roster_index::size() const
+{
+	return int(used);
+}
+
+//reinserts every key into count (a power of two) empty slots, in new pages of up to
+//2^INDEX_PAGE_BITS slots.
+void Roster_index::rehash(size_t count)
+{
+	vector<Page> old;
+	old.swap(pages);
+	size_t old_slots = capacity;
+	int old_bits = page_bits;
+
+	capacity = count;
+	shift = 64;
+	while ((size_t(1) << (64 - shift)) < count)
+		--shift;
+	page_bits = min(64 - shift, INDEX_PAGE_BITS);
+	size_t page_slots = size_t(1) << page_bits;
+	for (size_t i = 0; i < count / page_slots; ++i)
+	{
+		pages.emplace_back(new Slot[page_slots]);
+		fill(pages.back().get(), pages.back().get() + page_slots, Slot{NO_KEY, nullptr});
+	}
+	for (size_t i = 0; i < old_slots; ++i)
+	{
+		const Slot & slot = old[i >> old_bits][i & ((size_t(1) << old_bits) - 1)];
+		if (slot.key != NO_KEY)
+			writable(slot_of(slot.key)) = slot;
+	}
+}
+
+
+/****** HEALTH INDEX IMPLEMENTATION ******/
+
+//(health, key) order; entries equal in both may sit in any order.
+static bool health_order(const Health_index::Entry & entry, const Health_index::Entry & other)
+{
+	return entry.health < other.health || (entry.health == other.health && entry.key < other.key);
+}
+
+//no pages yet.
+Health_index::Health_index(): used(0)
+{}
+
+//binary search on the last entry of every page.
+size_t Health_index::page_of(int health, uint64_t key) const
+{
+	return size_t(lower_bound(lasts.begin(), lasts.end(), Entry{health, key, nullptr}, health_order) - lasts.begin());
+}
+
+//a page to write; one another index still shares is copied first.
+vector<Health_index::Entry> & Health_index::writable(size_t page)
+{
+	if (!sole(pages[page]))
+		pages[page] = make_shared<vector<Entry>>(*pages[page]);
+	return *pages[page];
+}
+
+//looks through the entries equal to (health, key) for the Pokemon. If it isn't there, its
+//health changed without this index hearing of it (through another roster sharing it), so
+//every entry is looked at.
+int Health_index::find(int health, uint64_t key, const Pokemon * pokemon, size_t & page, size_t & at) const
+{
+	Entry probe{health, key, nullptr};
+	page = page_of(health, key);
+	at = page < pages.size() ? size_t(lower_bound(pages[page]->begin(), pages[page]->end(), probe, health_order) - pages[page]->begin()) : 0;
+	for (; page < pages.size(); ++page, at = 0)
+	{
+		const vector<Entry> & entries = *pages[page];
+		for (; at < entries.size() && !health_order(probe, entries[at]); ++at)
+			if (entries[at].pokemon == pokemon)
+				return 1;
+		if (at < entries.size())
+			break;
+	}
+	for (page = 0; page < pages.size(); ++page)
+		for (at = 0; at < pages[page]->size(); ++at)
+			if ((*pages[page])[at].pokemon == pokemon)
+				return 1;
+	return 0;
+}
+
+//into the page that should hold it, after the entries equal to it there.
+void Health_index::add(int health, uint64_t key, Pokemon * pokemon)
+{
+	Entry made{health, key, pokemon};
+	if (pages.empty())
+	{
+		pages.push_back(make_shared<vector<Entry>>(1, made));
+		lasts.push_back(made);
+		++used;
+		return;
+	}
+	size_t page = min(page_of(health, key), pages.size() - 1);
+	vector<Entry> & entries = writable(page);
+	entries.insert(upper_bound(entries.begin(), entries.end(), made, health_order), made);
+	++used;
+	settle(page);
+}
+
+//drops exactly that entry.
+int Health_index::erase(int health, uint64_t key, const Pokemon * pokemon)
+{
+	size_t page = 0;
+	size_t at = 0;
+	if (!find(health, key, pokemon, page, at))
+		return 0;
+	vector<Entry> & entries = writable(page);
+	entries.erase(entries.begin() + at);
+	--used;
+	settle(page);
+	return 1;
+}
+
+//same place, another Pokemon (a clone of it).
+int Health_index::replace(int health, uint64_t key, const Pokemon * from, Pokemon * to)
+{
+	size_t page = 0;
+	size_t at = 0;
+	if (!find(health, key, from, page, at))
+		return 0;
+	writable(page)[at].pokemon = to;
+	return 1;
+}
+
+//merges the sorted batch with every entry and cuts the result into pages three quarters full,
+//so the next few adds don't split them.
+void Health_index::merge(vector<Entry> & batch)
+{
+	sort(batch.begin(), batch.end(), health_order);
+	vector<Entry> old;
+	old.reserve(used);
+	for (const Page & page : pages)
+		old.insert(old.end(), page->begin(), page->end());
+	vector<Entry> all(old.size() + batch.size());
+	std::merge(old.begin(), old.end(), batch.begin(), batch.end(), all.begin(), health_order);
+
+	size_t page_entries = HEALTH_PAGE_ENTRIES * 3 / 4;
+	pages.clear();
+	lasts.clear();
+	for (size_t first = 0; first < all.size(); first += page_entries)
+	{
+		size_t end = min(first + page_entries, all.size());
+		pages.push_back(make_shared<vector<Entry>>(all.begin() + first, all.begin() + end));
+		lasts.push_back(all[end - 1]);
+	}
+	used = all.size();
+}
+
+//from the first entry with at least the low health; an entry whose Pokemon has since left the
+//range (see find) is skipped.
+int Health_index::walk(int low, int high, int limit, vector<Pokemon *> & out) const
+{
+	Entry probe{low, 0, nullptr};
+	int added = 0;
+	for (size_t page = page_of(low, 0); page < pages.size(); ++page)
+	{
+		const vector<Entry> & entries = *pages[page];
+		for (auto entry = lower_bound(entries.begin(), entries.end(), probe, health_order); entry != entries.end(); ++entry)
+		{
+			if (entry->health > high || added == limit)
+				return added;
+			int health = entry->pokemon->get_health();
+			if (health < low || health > high)
+				continue;
+			out.push_back(entry->pokemon);
+			++added;
+		}
+	}
+	return added;
+}
+
+//keeps pages between a few entries and HEALTH_PAGE_ENTRIES after a write to one: splits it in
+//half when it overflowed, drops it when empty, and joins it to a neighbour when both fit in
+//half a page. The last entries follow.
+void Health_index::settle(size_t page)
+{
+	vector<Entry> & entries = *pages[page];
+	size_t half = HEALTH_PAGE_ENTRIES / 2;
+	if (entries.size() > HEALTH_PAGE_ENTRIES)
+	{
+		Page upper = make_shared<vector<Entry>>(entries.begin() + entries.size() / 2, entries.end());
+		entries.resize(entries.size() / 2);
+		lasts[page] = entries.back();
+		lasts.insert(lasts.begin() + page + 1, upper->back());
+		pages.insert(pages.begin() + page + 1, upper);
+	}
+	else if (entries.empty())
+	{
+		lasts.erase(lasts.begin() + page);
+		pages.erase(pages.begin() + page);
+	}
+	else if (page + 1 < pages.size() && entries.size() + pages[page + 1]->size() <= half)
+	{
+		entries.insert(entries.end(), pages[page + 1]->begin(), pages[page + 1]->end());
+		lasts.erase(lasts.begin() + page);	//the next page's last is the joined page's.
+		pages.erase(pages.begin() + page + 1);
+	}
+	else if (page > 0 && entries.size() + pages[page - 1]->size() <= half)
+	{
+		vector<Entry> & previous = writable(page - 1);
+		previous.insert(previous.end(), entries.begin(), entries.end());
+		lasts.erase(lasts.begin() + page - 1);	//this page's last is the joined page's.
+		pages.erase(pages.begin() + page);
+	}
+	else
+		lasts[page] = entries.back();
+}
+
+//lets go of every page.
+void Health_index::clear()
+{
+	vector<Page>().swap(pages);
+	vector<Entry>().swap(lasts);
+	used = 0;
+}
+
+//entries in the index.
+int Health_index::size() const
+{
+	return int(used);
+}
+
+
+/****** ROSTER ITERATOR IMPLEMENTATION ******/
+
+//past the end of an empty roster.
+Roster::iterator::iterator(): root(nullptr), depth(0)
+{}
+
+//end() of the tree.
+Roster::iterator::iterator(const Roster_node * root): root(root), depth(0)
+{}
+
+//the Pokemon at the last step.
+Roster::iterator::reference Roster::iterator::operator*() const
+{
+	const Step & here = path[depth - 1];
+	return here.node->values[here.index];
+}
+
+//pushes the leftmost path of a subtree.
+void Roster::iterator::descend_first(const Roster_node * node)
+{
+	while (true)
+	{
+		path[depth++] = {node, 0};
+		if (node->leaf)
+			return;
+		node = node->children[0];
+	}
+}
+
+//pushes the rightmost path of a subtree.
+void Roster::iterator::descend_last(const Roster_node * node)
+{
+	while (!node->leaf)
+	{
+		path[depth++] = {node, node->count};
+		node = node->children[node->count];
+	}
+	path[depth++] = {node, node->count - 1};
+}
+
+//the first entry of the right subtree, else the next entry in this leaf, else the first
+//ancestor entry we came up to from its left.
+Roster::iterator & Roster::iterator::operator++()
+{
+	Step & here = path[depth - 1];
+	if (!here.node->leaf)
+	{
+		++here.index;
+		descend_first(here.node->children[here.index]);
+		return *this;
+	}
+	if (++here.index < here.node->count)
+		return *this;
+	--depth;
+	while (depth > 0 && path[depth - 1].index >= path[depth - 1].node->count)
+		--depth;
+	return *this;
+}
+
+Roster::iterator Roster::iterator::operator++(int)
+{
+	iterator before = *this;
+	++*this;
+	return before;
+}
+
+//the last entry of the left subtree, else the previous entry in this leaf, else the first
+//ancestor entry we came up to from its right. From end() it is the last entry.
+Roster::iterator & Roster::iterator::operator--()
+{
+	if (depth == 0)
+	{
+		if (root)
+			descend_last(root);
+		return *this;
+	}
+	Step & here = path[depth - 1];
+	if (!here.node->leaf)
+	{
+		descend_last(here.node->children[here.index]);
+		return *this;
+	}
+	if (here.index > 0)
+	{
+		--here.index;
+		return *this;
+	}
+	--depth;
+	while (depth > 0 && path[depth - 1].index == 0)
+		--depth;
+	if (depth > 0)
+		--path[depth - 1].index;
+	return *this;
+}
+
+Roster::iterator Roster::iterator::operator--(int)
+{
+	iterator before = *this;
+	--*this;
+	return before;
+}
+
+//same entry (or both at the end).
+bool Roster::iterator::operator==(const iterator & other) const
+{
+	if (depth == 0 || other.depth == 0)
+		return depth == other.depth;
+	return path[depth - 1].node == other.path[other.depth - 1].node
+		&& path[depth - 1].index == other.path[other.depth - 1].index;
+}
+
+bool Roster::iterator::operator!=(const iterator & other) const
+{
+	return !(*this == other);
+}
+
+
+/****** ROSTER IMPLEMENTATION ******/
+
+//empty roster with a store, indexes and health counts of its own.
+Roster::Roster(): root(nullptr), entries(0), store(make_shared<Roster_store>()),
+	hash_index(make_shared<Roster_index>()), health_counts(make_shared<Health_counts>()),
+	health_index(make_shared<Health_index>()), watch(store->watch(this))
+{
+	fill(species_counts, species_counts + SPECIES_COUNT, 0);
+}
+
+//gives back what only this roster holds; the store frees everything else once no roster
+//shares it. The watch stays in the store, telling nobody.
+Roster::~Roster()
+{
+	store->unwatch(watch);
+	if (root && !sole_user())
+		unref(root);
+}
+
+//shares the whole tree, the indexes and the counts. The root gains a reference, so neither side
+//can change a shared node in place.
+Roster::Roster(const Roster & source): root(source.root), entries(source.entries), store(source.store),
+	hash_index(source.hash_index), health_counts(source.health_counts), health_index(source.health_index),
+	watch(store->watch(this))
+{
+	if (root)
+		root->refs.fetch_add(1, memory_order_relaxed);
+	copy(source.species_counts, source.species_counts + SPECIES_COUNT, species_counts);
+}
+
+//shares the whole tree, like the copy constructor. The new root gains its reference before the
+//old tree lets go, in case they are the same.
+Roster & Roster::operator=(const Roster & source)
+{
+	if (this != &source)
+	{
+		Roster_node * shared = source.root;
+		if (shared)
+			shared->refs.fetch_add(1, memory_order_relaxed);
+		release_tree();
+		root = shared;
+		entries = source.entries;
+		move_store(source.store);
+		hash_index = source.hash_index;
+		health_counts = source.health_counts;
+		health_index = source.health_index;
+		copy(source.species_counts, source.species_counts + SPECIES_COUNT, species_counts);
+	}
+	return *this;
+}
+
+//leaves the old store's watch for another roster and takes one in the new store.
+void Roster::move_store(shared_ptr<Roster_store> to)
+{
+	store->unwatch(watch);
+	store = to;
+	watch = store->watch(this);
+}
+
+//an O(1) copy to roll back to or experiment on.
+Roster Roster::snapshot() const
+{
+	return *this;
+}
+
+//no other roster shares the store, so every node and Pokemon in it is this roster's alone.
+bool Roster::sole_user() const
+{
+	return sole(store);
+}
+
+//the count lives in the pool slot just before the Pokemon.
+atomic<int> & Roster::refs_of(const Pokemon * pokemon)
+{
+	return *reinterpret_cast<atomic<int> *>(reinterpret_cast<char *>(const_cast<Pokemon *>(pokemon)) - POKEMON_HEADER);
+}
+
+//a pool slot with its count set to one (the reference the Pokemon will be linked with).
+void * Roster::pokemon_slot()
+{
+	char * slot = static_cast<char *>(store->allocate(store->pokemons));
+	new (slot) atomic<int>(1);
+	return slot + POKEMON_HEADER;
+}
+
+//packs (species + 1, id) so unnamed Pokemon (species -1) sort first.
+uint64_t Roster::make_key(int species_id, uint32_t id)
+{
+	return (uint64_t(uint32_t(species_id + 1)) << 32) | id;
+}
+
+//the key a Pokemon is stored under.
+uint64_t Roster::key_of(const Pokemon * pokemon)
+{
+	return make_key(pokemon->get_species_id(), pokemon->get_id());
+}
+
+//first entry with a key >= key (binary search over the node's key array).
+int Roster::lower_bound(const Roster_node * node, uint64_t key)
+{
+	int low = 0, high = node->count;
+	while (low < high)
+	{
+		int middle = (low + high) / 2;
+		if (node->keys[middle] < key)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+	return low;
+}
+
+//first entry with a key > key.
+int Roster::upper_bound(const Roster_node * node, uint64_t key)
+{
+	int low = 0, high = node->count;
+	while (low < high)
+	{
+		int middle = (low + high) / 2;
+		if (key < node->keys[middle])
+			high = middle;
+		else
+			low = middle + 1;
+	}
+	return low;
+}
+
+//splits the full child at index around its middle entry, which moves up into parent.
+void Roster::split_child(Roster_node * parent, int index)
+{
+	Roster_node * full = parent->children[index];
+	Roster_node * right = new_node(full->leaf);
+	const int t = ROSTER_DEGREE;
+
+	right->count = t - 1;
+	for (int i = 0; i < t - 1; ++i)
+	{
+		right->keys[i] = full->keys[i + t];
+		right->values[i] = full->values[i + t];
+	}
+	if (!full->leaf)
+		for (int i = 0; i < t; ++i)
+			right->children[i] = full->children[i + t];
+	full->count = t - 1;
+
+	for (int i = parent->count; i > index; --i)
+	{
+		parent->keys[i] = parent->keys[i - 1];
+		parent->values[i] = parent->values[i - 1];
+		parent->children[i + 1] = parent->children[i];
+	}
+	parent->keys[index] = full->keys[t - 1];
+	parent->values[index] = full->values[t - 1];
+	parent->children[index + 1] = right;
+	++parent->count;
+	pull(full);	//the parent's subtree keeps the same entries.
+	pull(right);
+}
+
+//an empty node from the pool, owned by this roster.
+Roster_node * Roster::new_node(bool leaf)
+{
+	return new (store->allocate(store->nodes)) Roster_node(leaf);
+}
+
+//gives back a node of this roster's own whose entries and children have moved elsewhere.
+void Roster::delete_node(Roster_node * node)
+{
+	store->release(store->nodes, node);
+}
+
+//the node if the caller's path holds its only reference (then nobody else can reach it); else
+//a copy, whose children and Pokemon gain a reference, that the caller links in its place. The
+//node loses the path's reference.
+Roster_node * Roster::own(Roster_node * node)
+{
+	if (node->refs.load(memory_order_acquire) == 1)
+		return node;
+	Roster_node * made = new_node(node->leaf);
+	made->count = node->count;
+	made->total = node->total;
+	for (int i = 0; i < node->count; ++i)
+	{
+		made->keys[i] = node->keys[i];
+		made->values[i] = node->values[i];
+		refs_of(made->values[i]).fetch_add(1, memory_order_relaxed);
+	}
+	if (!node->leaf)
+		for (int i = 0; i <= node->count; ++i)
+		{
+			made->children[i] = node->children[i];
+			made->children[i]->refs.fetch_add(1, memory_order_relaxed);
+		}
+	unref(node);	//another roster may have let go meanwhile: then this frees it.
+	return made;
+}
+
+//the last reference frees the node after dropping the references it holds (the recursion only
+//goes as deep as the tree is tall).
+void Roster::unref(Roster_node * node)
+{
+	if (node->refs.fetch_sub(1, memory_order_acq_rel) != 1)
+		return;
+	for (int i = 0; i < node->count; ++i)
+		unref_pokemon(node->values[i]);
+	if (!node->leaf)
+		for (int i = 0; i <= node->count; ++i)
+			unref(node->children[i]);
+	delete_node(node);
+}
+
+//the last reference destroys the Pokemon and gives its slot back.
+void Roster::unref_pokemon(Pokemon * pokemon)
+{
+	if (refs_of(pokemon).fetch_sub(1, memory_order_acq_rel) != 1)
+		return;
+	pokemon->~Pokemon();
+	store->release(store->pokemons, reinterpret_cast<char *>(pokemon) - POKEMON_HEADER);
+}
+
+//with the store to itself the roster holds every reference, so resetting the pools frees it all
+//in O(1); otherwise it gives back what only it held.
+void Roster::release_tree()
+{
+	if (sole_user())
+	{
+		store->reset(store->nodes);
+		store->reset(store->pokemons);
+	}
+	else if (root)
+		unref(root);
+	root = nullptr;
+}
+
+//the index, copied first if another roster shares it; nullptr when the roster has none.
+Roster_index * Roster::index_for_write()
+{
+	if (hash_index && !sole(hash_index))
+		hash_index = make_shared<Roster_index>(*hash_index);
+	return hash_index.get();
+}
+
+//the health counts, copied first if another roster shares them (they are small).
+Health_counts * Roster::counts_for_write()
+{
+	if (!sole(health_counts))
+		health_counts = make_shared<Health_counts>(*health_counts);
+	return health_counts.get();
+}
+
+//the health index, copied first if another roster shares it; the copy shares the pages.
+Health_index * Roster::health_index_for_write()
+{
+	if (!sole(health_index))
+		health_index = make_shared<Health_index>(*health_index);
+	return health_index.get();
+}
+
+//a Pokemon just linked in: this roster hears about its health from now on, and counts it.
+void Roster::adopt(Pokemon * pokemon)
+{
+	pokemon->set_observer(watch);
+	counts_for_write()->add(pokemon->get_health(), 1);
+	if (pokemon->get_species_id() >= 0)
+		++species_counts[pokemon->get_species_id()];
+}
+
+//after an entry under the key left the tree: points the key at the next copy with the same
+//key, or drops it, and moves its species' first key on if it was that.
+void Roster::reindex(uint64_t key)
+{
+	Roster_index * table = index_for_write();
+	if (!table)
+		return;
+	int at = 0;
+	const Roster_node * node = first_at_least(key, at);
+	if (node && node->keys[at] == key)
+	{
+		table->put(key, node->values[at]);
+		return;
+	}
+	table->erase(key);
+	int species = int(key >> 32) - 1;
+	if (table->first_of(species) == key)
+		table->set_first(species, node && node->keys[at] < make_key(species + 1, 0) ? node->keys[at] : NO_KEY);
+}
+
+//copies a Pokemon into the pool with the right derived type.
+Pokemon * Roster::clone(const Pokemon * source)
+{
+	if (const Fire * fire = dynamic_cast<const Fire *>(source))
+		return new (pokemon_slot()) Fire(*fire);
+	if (const Water * water = dynamic_cast<const Water *>(source))
+		return new (pokemon_slot()) Water(*water);
+	if (const Grass * grass = dynamic_cast<const Grass *>(source))
+		return new (pokemon_slot()) Grass(*grass);
+	return nullptr;
+}
+
+//moves the Pokemon into the pool (same name, health and id) and deletes the heap copy.
+int Roster::insert(Pokemon * to_add)
+{
+	if (!to_add)
+		return 0;
+	Pokemon * made = clone(to_add);
+	delete to_add;
+	return made ? add(made) : 0;
+}
+
+//a new random Pokemon of the type, made directly in the pool.
+Pokemon * Roster::create(int type)
+{
+	Pokemon * made = make(type);
+	if (made)
+		add(made);
+	return made;
+}
+
+//a new random Pokemon in the pool that isn't in the tree yet (remove_all frees it either way).
+Pokemon * Roster::make(int type)
+{
+	if (type == FIRE)
+		return new (pokemon_slot()) Fire();
+	if (type == WATER)
+		return new (pokemon_slot()) Water();
+	if (type == GRASS)
+		return new (pokemon_slot()) Grass();
+	return nullptr;
+}
+
+//sorts entries by key. The species is the high half of the key, so a stable counting sort
+//on it does most of the work in O(n); ids only need sorting where a species' run isn't
+//already in order (a batch made in one go is), and those runs are sorted on threads threads.
+static void sort_entries(vector<pair<uint64_t, Pokemon *>> & sorted, int threads)
+{
+	const int BUCKETS = SPECIES_COUNT + 1;	//unnamed Pokemon (species -1) come first.
+	size_t starts[BUCKETS + 1] = {};
+	for (const pair<uint64_t, Pokemon *> & entry : sorted)
+		++starts[(entry.first >> 32) + 1];
+	for (int i = 1; i <= BUCKETS; ++i)
+		starts[i] += starts[i - 1];
+
+	vector<pair<uint64_t, Pokemon *>> by_species(sorted.size());
+	size_t next[BUCKETS];
+	copy(starts, starts + BUCKETS, next);
+	for (const pair<uint64_t, Pokemon *> & entry : sorted)
+		by_species[next[entry.first >> 32]++] = entry;
+	sorted.swap(by_species);
+
+	vector<int> unsorted;
+	for (int i = 0; i < BUCKETS; ++i)
+		if (!is_sorted(sorted.begin() + starts[i], sorted.begin() + starts[i + 1]))
+			unsorted.push_back(i);
+	auto sort_runs = [&sorted, &starts, &unsorted](size_t first, size_t step)
+	{
+		for (size_t i = first; i < unsorted.size(); i += step)
+			sort(sorted.begin() + starts[unsorted[i]], sorted.begin() + starts[unsorted[i] + 1]);
+	};
+	size_t workers = min(size_t(max(threads, 1)), unsorted.size());
+	vector<thread> helpers;
+	for (size_t i = 1; i < workers; ++i)
+		helpers.emplace_back(sort_runs, i, workers);
+	sort_runs(0, max<size_t>(workers, 1));
+	for (thread & helper : helpers)
+		helper.join();
+}
+
+//most entries a subtree of the height can hold: 16^height - 1.
+static size_t capacity(int height)
+{
+	size_t most = 1;
+	for (int i = 0; i < height; ++i)
+		most *= ROSTER_MAX_KEYS + 1;
+	return most - 1;
+}
+
+//links the batch: sorted once, merged with what's there and rebuilt bottom up, balanced.
+int Roster::bulk_load(const vector<Pokemon *> & batch, int threads)
+{
+	vector<pair<uint64_t, Pokemon *>> sorted;
+	vector<Health_index::Entry> by_health;
+	sorted.reserve(batch.size());
+	by_health.reserve(batch.size());
+	for (Pokemon * pokemon : batch)
+		if (pokemon)
+		{
+			sorted.push_back({key_of(pokemon), pokemon});
+			by_health.push_back({pokemon->get_health(), sorted.back().first, pokemon});
+			adopt(pokemon);
+		}
+	int added = int(sorted.size());
+	if (added == 0)
+		return 0;
+	sort_entries(sorted, threads);
+	health_index_for_write()->merge(by_health);
+	if (Roster_index * table = index_for_write())
+	{
+		//equal keys already there stay first, as they do in the tree.
+		table->reserve(size_t(table->size()) + sorted.size());
+		for (const pair<uint64_t, Pokemon *> & entry : sorted)
+			table->add(entry.first, entry.second);
+	}
+
+	if (root)
+	{
+		bool alone = sole_user();
+		vector<pair<uint64_t, Pokemon *>> merged;
+		merged.reserve(size_t(entries) + sorted.size());
+		size_t next = 0;
+		for (Pokemon * pokemon : *this)
+		{
+			uint64_t key = key_of(pokemon);
+			while (next < sorted.size() && sorted[next].first < key)
+				merged.push_back(sorted[next++]);
+			merged.push_back({key, pokemon});
+			if (!alone)
+				refs_of(pokemon).fetch_add(1, memory_order_relaxed);	//the new tree holds it as well.
+		}
+		merged.insert(merged.end(), sorted.begin() + next, sorted.end());
+		sorted.swap(merged);
+		if (alone)
+			store->reset(store->nodes);	//nobody else sees the old nodes: reuse the slots, keep the Pokemon.
+		else
+			unref(root);
+	}
+
+	int height = 1;
+	while (capacity(height) < sorted.size())
+		++height;
+	root = build(sorted.data(), sorted.size(), height);
+	entries = int(sorted.size());
+	return added;
+}
+
+//a subtree of the given height over count sorted entries: the fewest children that can
+//hold them, with the entries spread evenly between them, so every node is at least half full.
+Roster_node * Roster::build(const pair<uint64_t, Pokemon *> * sorted, size_t count, int height)
+{
+	Roster_node * node = new_node(height == 1);
+	if (height == 1)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			node->keys[i] = sorted[i].first;
+			node->values[i] = sorted[i].second;
+		}
+		node->count = int(count);
+		pull(node);
+		return node;
+	}
+
+	size_t below = capacity(height - 1);
+	size_t children = (count + below + 1) / (below + 1);	//ceil((count + 1) / (below + 1)).
+	size_t spread = count - (children - 1);
+	size_t at = 0;
+	for (size_t child = 0; child < children; ++child)
+	{
+		size_t share = spread / children + (child < spread % children ? 1 : 0);
+		node->children[child] = build(sorted + at, share, height - 1);
+		at += share;
+		if (child + 1 < children)
+		{
+			node->keys[child] = sorted[at].first;
+			node->values[child] = sorted[at].second;
+			++at;
+		}
+	}
+	node->count = int(children - 1);
+	pull(node);
+	return node;
+}
+
+//links a pooled Pokemon in; equal names go after the ones already there.
+int Roster::add(Pokemon * made)
+{
+	uint64_t key = key_of(made);
+	root = root ? own(root) : new_node(true);
+	if (root->count == ROSTER_MAX_KEYS)
+	{
+		Roster_node * grown = new_node(false);
+		grown->children[0] = root;
+		root = grown;
+		split_child(root, 0);
+		pull(root);
+	}
+	++root->total;
+
+	Roster_node * node = root;
+	while (!node->leaf)
+	{
+		int index = upper_bound(node, key);
+		node->children[index] = own(node->children[index]);
+		if (node->children[index]->count == ROSTER_MAX_KEYS)
+		{
+			split_child(node, index);
+			if (!(key < node->keys[index]))
+				++index;
+		}
+		node = node->children[index];
+		++node->total;
+	}
+
+	int index = upper_bound(node, key);
+	for (int i = node->count; i > index; --i)
+	{
+		node->keys[i] = node->keys[i - 1];
+		node->values[i] = node->values[i - 1];
+	}
+	node->keys[index] = key;
+	node->values[index] = made;
+	++node->count;
+	++entries;
+	if (Roster_index * table = index_for_write())
+		table->add(key, made);
+	health_index_for_write()->add(made->get_health(), key, made);
+	adopt(made);
+	return 1;
+}
+
+//in name order.
+int Roster::display_all() const
+{
+	if (!root)
+	{
+		cout << "Tree is empty." << endl;
+		return 0;
+	}
+	int shown = 0;
+	for (Pokemon * pokemon : *this)
+	{
+		cout << "\n===================\n";
+		pokemon->display();
+		cout << "\n===================\n";
+		++shown;
+	}
+	return shown;
+}
+
+//deletes every Pokemon by resetting both pools; while snapshots still share the store, gives
+//back what only this roster held and moves to a new store. Returns 1 if there were any.
+int Roster::remove_all()
+{
+	int had = root != nullptr;
+	bool shared = !sole_user();
+	release_tree();
+	entries = 0;
+	if (shared)
+		move_store(make_shared<Roster_store>());
+	if (hash_index && sole(hash_index))
+		hash_index->clear();
+	else if (hash_index)
+		hash_index = make_shared<Roster_index>();
+	if (sole(health_counts))
+		health_counts->clear();
+	else
+		health_counts = make_shared<Health_counts>();
+	if (sole(health_index))
+		health_index->clear();
+	else
+		health_index = make_shared<Health_index>();
+	fill(species_counts, species_counts + SPECIES_COUNT, 0);
+	return had;
+}
+
+//turning the index on builds it from the tree in O(n); turning it off frees it.
+int Roster::set_indexed(bool on)
+{
+	if (on == is_indexed())
+		return 0;
+	if (!on)
+	{
+		hash_index.reset();
+		return 1;
+	}
+	hash_index = make_shared<Roster_index>();
+	hash_index->reserve(size_t(entries));
+	for (Pokemon * pokemon : *this)
+		hash_index->add(key_of(pokemon), pokemon);
+	return 1;
+}
+
+//true while lookups go through the hash index.
+bool Roster::is_indexed() const
+{
+	return hash_index != nullptr;
+}
+
+//chunks held by the node and Pokemon pools.
+int Roster::allocated_chunks() const
+{
+	return store->chunks();
+}
+
+//node and index of the smallest entry >= key, nullptr if there is none.
+const Roster_node * Roster::first_at_least(uint64_t key, int & index) const
+{
+	const Roster_node * best = nullptr;
+	const Roster_node * node = root;
+	while (node)
+	{
+		int at = lower_bound(node, key);
+		if (at < node->count)
+		{
+			best = node;	//anything smaller but still >= key can only be to the left.
+			index = at;
+		}
+		node = node->leaf ? nullptr : node->children[at];
+	}
+	return best;
+}
+
+//first Pokemon with the name: the smallest key of its species.
+int Roster::retrieve(const string & name_to_find, Pokemon *& found) const
+{
+	found = nullptr;
+	int species = Pokemon::species_id(name_to_find);
+	if (species < 0)
+		return 0;
+	if (hash_index)
+	{
+		uint64_t first = hash_index->first_of(species);
+		found = first == NO_KEY ? nullptr : hash_index->find(first);
+		return found != nullptr;
+	}
+	int index = 0;
+	const Roster_node * node = first_at_least(make_key(species, 0), index);
+	if (node && node->keys[index] < make_key(species + 1, 0))
+		found = node->values[index];
+	return found != nullptr;
+}
+
+//exactly the Pokemon with that species and instance id.
+int Roster::retrieve(int species_id, uint32_t id, Pokemon *& found) const
+{
+	found = nullptr;
+	uint64_t key = make_key(species_id, id);
+	if (hash_index)
+	{
+		found = hash_index->find(key);
+		return found != nullptr;
+	}
+	int index = 0;
+	const Roster_node * node = first_at_least(key, index);
+	if (node && node->keys[index] == key)
+		found = node->values[index];
+	return found != nullptr;
+}
+
+//the first Pokemon with the name, cloned first if another roster shares it.
+int Roster::retrieve_for_update(const string & name_to_find, Pokemon *& found)
+{
+	if (!retrieve(name_to_find, found))
+		return 0;
+	return retrieve_for_update(found->get_species_id(), found->get_id(), found);
+}
+
+//exactly that Pokemon, on a path of nodes this roster owns, cloned first if it is shared.
+int Roster::retrieve_for_update(int species_id, uint32_t id, Pokemon *& found)
+{
+	if (!retrieve(species_id, id, found))
+		return 0;	//checked first, so a miss copies nothing.
+	if (hash_index && sole_user())
+	{
+		found->set_observer(watch);	//no other roster can see it: change it in place.
+		return 1;
+	}
+	uint64_t key = make_key(species_id, id);
+	root = own(root);
+	Roster_node * node = root;
+	int index = lower_bound(node, key);
+	while (index == node->count || node->keys[index] != key)
+	{
+		node = node->children[index] = own(node->children[index]);
+		index = lower_bound(node, key);
+	}
+	Pokemon * stored = node->values[index];
+	if (refs_of(stored).load(memory_order_acquire) != 1)
+	{
+		node->values[index] = clone(stored);	//other nodes (so other rosters) hold it too.
+		Roster_index * table = index_for_write();
+		if (table && table->find(key) == stored)	//not a later copy under the same key.
+			table->put(key, node->values[index]);
+		health_index_for_write()->replace(stored->get_health(), key, stored, node->values[index]);
+		unref_pokemon(stored);
+	}
+	found = node->values[index];
+	found->set_observer(watch);
+	return 1;
+}
+
+//the Pokemon's health changed: if it is still in the tree (the iterator finds the exact entry
+//among copies sharing its key), move it in the health counts and the health index.
+void Roster::health_changed(Pokemon & pokemon, int old_health)
+{
+	uint64_t key = key_of(&pokemon);
+	iterator it = seek(key);
+	while (it != end() && *it != &pokemon && key_of(*it) == key)
+		++it;
+	if (it == end() || *it != &pokemon)
+		return;		//not in this roster (any more).
+	int health = pokemon.get_health();
+	Health_counts * counts = counts_for_write();
+	counts->add(old_health, -1);
+	counts->add(health, 1);
+	Health_index * index = health_index_for_write();
+	index->erase(old_health, key, &pokemon);
+	index->add(health, key, &pokemon);
+}
+
+//the k-th entry in key order, steering by subtree counts.
+Pokemon * Roster::select(int k) const
+{
+	if (k < 0 || k >= entries)
+		return nullptr;
+	const Roster_node * node = root;
+	while (true)
+	{
+		if (node->leaf)
+			return node->values[k];
+		int i = 0;
+		while (k >= node->children[i]->total)
+		{
+			k -= node->children[i]->total;
+			if (k == 0)
+				return node->values[i];
+			--k;
+			++i;
+		}
+		node = node->children[i];
+	}
+}
+
+//entries with a smaller key: the ones left of the search path, counted by subtree.
+int Roster::rank(int species_id, uint32_t id) const
+{
+	uint64_t key = make_key(species_id, id);
+	int before = 0;
+	for (const Roster_node * node = root; node; )
+	{
+		int index = lower_bound(node, key);
+		before += index;
+		if (node->leaf)
+			break;
+		for (int i = 0; i < index; ++i)
+			before += node->children[i]->total;
+		node = node->children[index];
+	}
+	return before;
+}
+
+//from the health counts.
+int Roster::count_health(int low, int high) const
+{
+	return health_counts->count_range(low, high);
+}
+
+//from the health counts.
+int Roster::health_rank(const Pokemon * pokemon) const
+{
+	return pokemon->get_health() == INT_MAX ? 0 : health_counts->count_range(pokemon->get_health() + 1, INT_MAX);
+}
+
+//the health comes from the counts; the first Pokemon in name order with it from the index.
+Pokemon * Roster::kth_healthiest(int k) const
+{
+	int health = health_counts->kth_highest(k);
+	if (health < 0)
+		return nullptr;
+	vector<Pokemon *> found;
+	health_index->walk(health, health, 1, found);
+	return found.empty() ? nullptr : found[0];
+}
+
+//from the health index.
+int Roster::retrieve_health_range(int low, int high, vector<Pokemon *> & out) const
+{
+	return health_index->walk(low, high, INT_MAX, out);
+}
+
+//every Pokemon of every species whose attack is in range; a species' attack is fixed, so
+//one Pokemon per species decides it.
+int Roster::retrieve_attack_range(int low, int high, vector<Pokemon *> & out) const
+{
+	int added = 0;
+	for (int species = 0; species < SPECIES_COUNT; ++species)
+	{
+		Pokemon * first = nullptr;
+		const string & name = Pokemon::species_name(species);
+		if (retrieve(name, first) && first->get_attack() >= low && first->get_attack() <= high)
+			added += retrieve_all(name, out);
+	}
+	return added;
+}
+
+//the species of the type with the highest attack that has a Pokemon here (the first one).
+Pokemon * Roster::strongest_attacker(int type) const
+{
+	Pokemon * strongest = nullptr;
+	for (int species = 0; species < SPECIES_COUNT; ++species)
+	{
+		Pokemon * first = nullptr;
+		if (Pokemon::find_species(species)->type == type && retrieve(Pokemon::species_name(species), first)
+			&& (!strongest || first->get_attack() > strongest->get_attack()))
+			strongest = first;
+	}
+	return strongest;
+}
+
+//Pokemon of that species.
+int Roster::count_species(int species_id) const
+{
+	return species_id >= 0 && species_id < SPECIES_COUNT ? species_counts[species_id] : 0;
+}
+
+//the run of species ids the prefix covers, less the ones not on the roster.
+int Roster::complete(const string & prefix, vector<int> & out) const
+{
+	int first = 0, end = 0;
+	Pokemon::species_with_prefix(prefix, first, end);
+	int added = 0;
+	for (int species = first; species < end; ++species)
+		if (species_counts[species] > 0)
+		{
+			out.push_back(species);
+			++added;
+		}
+	return added;
+}
+
+//every species on the roster within most edits, by distance and then by name.
+int Roster::suggest(const string & typed, int most, vector<int> & out) const
+{
+	vector<pair<int, int>> close;	//(distance, species id).
+	for (int species = 0; species < SPECIES_COUNT; ++species)
+		if (species_counts[species] > 0)
+		{
+			int distance = Pokemon::name_distance(typed, species, most);
+			if (distance <= most)
+				close.push_back({distance, species});
+		}
+	sort(close.begin(), close.end());
+	for (const pair<int, int> & found : close)
+		out.push_back(found.second);
+	return int(close.size());
+}
+
+//every Pokemon with the name, oldest first.
+int Roster::retrieve_all(const string & name_to_find, vector<Pokemon *> & out) const
+{
+	int species = Pokemon::species_id(name_to_find);
+	if (species < 0 || !root)
+		return 0;
+	uint64_t high = make_key(species + 1, 0);
+	int added = 0;
+	for (iterator it = seek(make_key(species, 0)); it != end() && key_of(*it) < high; ++it)
+	{
+		out.push_back(*it);
+		++added;
+	}
+	return added;
+}
+
+//appends every Pokemon in order.
+int Roster::collect(vector<Pokemon *> & out) const
+{
+	int added = 0;
+	for (Pokemon * pokemon : *this)
+	{
+		out.push_back(pokemon);
+		++added;
+	}
+	return added;
+}
+
+//the first Pokemon in key order.
+Roster::iterator Roster::begin() const
+{
+	iterator first(root);
+	if (root)
+		first.descend_first(root);
+	return first;
+}
+
+//past the last Pokemon.
+Roster::iterator Roster::end() const
+{
+	return iterator(root);
+}
+
+//the last Pokemon.
+Roster::reverse_iterator Roster::rbegin() const
+{
+	return reverse_iterator(end());
+}
+
+//before the first Pokemon.
+Roster::reverse_iterator Roster::rend() const
+{
+	return reverse_iterator(begin());
+}
+
+//the smallest entry >= key: descend by lower bound, then climb out of a leaf that has none.
+Roster::iterator Roster::seek(uint64_t key) const
+{
+	iterator found(root);
+	for (const Roster_node * node = root; node; node = node->leaf ? nullptr : node->children[found.path[found.depth - 1].index])
+		found.path[found.depth++] = {node, lower_bound(node, key)};
+	while (found.depth > 0 && found.path[found.depth - 1].index >= found.path[found.depth - 1].node->count)
+		--found.depth;
+	return found;
+}
+
+//Pokemon in the roster.
+int Roster::size() const
+{
+	return entries;
+}
+
+//levels in the tree.
+int Roster::height() const
+{
+	int levels = 0;
+	for (const Roster_node * node = root; node; node = node->leaf ? nullptr : node->children[0])
+		++levels;
+	return levels;
+}
+
+//subtree count from the node's own entries and its children's counts.
+void Roster::pull(Roster_node * node)
+{
+	node->total = node->count;
+	if (!node->leaf)
+		for (int i = 0; i <= node->count; ++i)
+			node->total += node->children[i]->total;
+}
+
+//deepest first, so every node sees its children's new aggregates.
+void Roster::pull_path(Roster_node ** path, int depth)
+{
+	for (int i = depth - 1; i >= 0; --i)
+		pull(path[i]);
+}
+
+//joins children index and index + 1 around the parent's entry index (into an owned left child).
+void Roster::merge_children(Roster_node * parent, int index)
+{
+	Roster_node * left = parent->children[index] = own(parent->children[index]);
+	Roster_node * right = parent->children[index + 1] = own(parent->children[index + 1]);	//its references move to left.
+	left->keys[left->count] = parent->keys[index];
+	left->values[left->count] = parent->values[index];
+	for (int i = 0; i < right->count; ++i)
+	{
+		left->keys[left->count + 1 + i] = right->keys[i];
+		left->values[left->count + 1 + i] = right->values[i];
+	}
+	if (!left->leaf)
+		for (int i = 0; i <= right->count; ++i)
+			left->children[left->count + 1 + i] = right->children[i];
+	left->count += right->count + 1;
+
+	for (int i = index; i < parent->count - 1; ++i)
+	{
+		parent->keys[i] = parent->keys[i + 1];
+		parent->values[i] = parent->values[i + 1];
+		parent->children[i + 1] = parent->children[i + 2];
+	}
+	--parent->count;
+	delete_node(right);
+	pull(left);
+}
+
+//makes sure the child at index is owned and has at least ROSTER_DEGREE entries, returns
+//where it is now.
+int Roster::fill_child(Roster_node * parent, int index)
+{
+	Roster_node * child = parent->children[index] = own(parent->children[index]);
+	if (child->count >= ROSTER_DEGREE)
+		return index;
+
+	if (index > 0 && parent->children[index - 1]->count >= ROSTER_DEGREE)
+	{
+		//borrow through the parent from the left sibling.
+		Roster_node * left = parent->children[index - 1] = own(parent->children[index - 1]);
+		for (int i = child->count; i > 0; --i)
+		{
+			child->keys[i] = child->keys[i - 1];
+			child->values[i] = child->values[i - 1];
+		}
+		if (!child->leaf)
+			for (int i = child->count + 1; i > 0; --i)
+				child->children[i] = child->children[i - 1];
+		child->keys[0] = parent->keys[index - 1];
+		child->values[0] = parent->values[index - 1];
+		if (!child->leaf)
+			child->children[0] = left->children[left->count];
+		parent->keys[index - 1] = left->keys[left->count - 1];
+		parent->values[index - 1] = left->values[left->count - 1];
+		--left->count;
+		++child->count;
+		pull(left);
+		pull(child);
+		return index;
+	}
+	if (index < parent->count && parent->children[index + 1]->count >= ROSTER_DEGREE)
+	{
+		//borrow through the parent from the right sibling.
+		Roster_node * right = parent->children[index + 1] = own(parent->children[index + 1]);
+		child->keys[child->count] = parent->keys[index];
+		child->values[child->count] = parent->values[index];
+		if (!child->leaf)
+			child->children[child->count + 1] = right->children[0];
+		++child->count;
+		parent->keys[index] = right->keys[0];
+		parent->values[index] = right->values[0];
+		for (int i = 0; i < right->count - 1; ++i)
+		{
+			right->keys[i] = right->keys[i + 1];
+			right->values[i] = right->values[i + 1];
+		}
+		if (!right->leaf)
+			for (int i = 0; i < right->count; ++i)
+				right->children[i] = right->children[i + 1];
+		--right->count;
+		pull(right);
+		pull(child);
+		return index;
+	}
+	if (index < parent->count)
+	{
+		merge_children(parent, index);
+		return index;
+	}
+	merge_children(parent, index - 1);
+	return index - 1;
+}
+
+//drops an empty inner root (after a merge took its last entry).
+void Roster::shrink_root()
+{
+	if (root && root->count == 0)
+	{
+		Roster_node * old = root;
+		root = root->leaf ? nullptr : root->children[0];
+		delete_node(old);
+	}
+}
+
+//unlinks the last entry of a subtree whose owned root has at least ROSTER_DEGREE entries.
+Pokemon * Roster::remove_max(Roster_node * node, Roster_node ** path, int & depth)
+{
+	path[depth++] = node;
+	while (!node->leaf)
+		path[depth++] = node = node->children[fill_child(node, node->count)];
+	--node->count;
+	return node->values[node->count];
+}
+
+//unlinks the first entry of a subtree whose owned root has at least ROSTER_DEGREE entries.
+Pokemon * Roster::remove_min(Roster_node * node, Roster_node ** path, int & depth)
+{
+	path[depth++] = node;
+	while (!node->leaf)
+		path[depth++] = node = node->children[fill_child(node, 0)];
+	Pokemon * first = node->values[0];
+	for (int i = 0; i < node->count - 1; ++i)
+	{
+		node->keys[i] = node->keys[i + 1];
+		node->values[i] = node->values[i + 1];
+	}
+	--node->count;
+	return first;
+}
+
+//deletes the first Pokemon with the name.
+int Roster::remove_specific(const string & name_to_remove)
+{
+	Pokemon * first = nullptr;
+	if (!retrieve(name_to_remove, first))
+		return 0;
+	return remove_key(key_of(first));
+}
+
+//deletes exactly that Pokemon.
+int Roster::remove_specific(int species_id, uint32_t id)
+{
+	return remove_key(make_key(species_id, id));
+}
+
+//deletes one Pokemon stored under the key.
+int Roster::remove_key(uint64_t key)
+{
+	int at = 0;
+	const Roster_node * found = first_at_least(key, at);
+	if (!found || found->keys[at] != key)
+		return 0;	//checked first, so a miss copies nothing.
+	root = own(root);
+	Roster_node * node = root;
+	Pokemon * removed = nullptr;
+	Roster_node * path[ROSTER_MAX_HEIGHT];	//every node changed below the root, to recompute.
+	int depth = 0;
+	while (node && !removed)
+	{
+		path[depth++] = node;
+		int index = lower_bound(node, key);
+		bool here = index < node->count && node->keys[index] == key;
+		if (here && node->leaf)
+		{
+			removed = node->values[index];
+			for (int i = index; i < node->count - 1; ++i)
+			{
+				node->keys[i] = node->keys[i + 1];
+				node->values[i] = node->values[i + 1];
+			}
+			--node->count;
+		}
+		else if (here)
+		{
+			Roster_node * left = node->children[index];
+			Roster_node * right = node->children[index + 1];
+			if (left->count >= ROSTER_DEGREE || right->count >= ROSTER_DEGREE)
+			{
+				//replace the entry with its neighbour from the bigger side.
+				removed = node->values[index];
+				bool from_left = left->count >= ROSTER_DEGREE;
+				Pokemon * neighbour = from_left ? remove_max(node->children[index] = own(left), path, depth)
+					: remove_min(node->children[index + 1] = own(right), path, depth);
+				node->keys[index] = key_of(neighbour);
+				node->values[index] = neighbour;
+			}
+			else
+			{
+				merge_children(node, index);	//the entry moves down into the merged child.
+				Roster_node * merged = node->children[index];
+				if (node == root)
+					shrink_root();
+				if (node != root && depth == 1)
+					depth = 0;	//it was the root, and shrink_root() freed it.
+				node = merged;
+			}
+		}
+		else if (node->leaf)
+			node = nullptr;	//no such name.
+		else
+		{
+			int child = fill_child(node, index);
+			Roster_node * next = node->children[child];
+			if (node == root)
+				shrink_root();
+			if (node != root && depth == 1)
+				depth = 0;	//it was the root, and shrink_root() freed it.
+			node = next;
+		}
+	}
+	pull_path(path, depth);
+	shrink_root();
+	if (!removed)
+		return 0;
+	counts_for_write()->add(removed->get_health(), -1);
+	health_index_for_write()->erase(removed->get_health(), key_of(removed), removed);
+	if (removed->get_species_id() >= 0)
+		--species_counts[removed->get_species_id()];
+	unref_pokemon(removed);
+	--entries;
+	if (entries == 0)
+		remove_all();
+	else
+		reindex(key);
+	return 1;
+}
@@ -0,0 +1,465 @@
+// Author: Pokemon Battle contributors
+// Date: 10-17-2026
+//
+// This file contains the implementation of the Session and Battle_server classes.
+
+/*
+ * Overview:
+ * - Every loop thread has its own epoll set holding the shared listening socket (with
+ *   EPOLLEXCLUSIVE, so only one thread wakes per connection) and the sessions it accepted.
+ * - A readable session reads at most READ_BUDGET bytes per wakeup (epoll is level triggered,
+ *   so the rest wakes it again after the other sessions had their turn), handles each
+ *   complete 4 byte request, then writes as much of its output as the socket takes.
+ *   Leftover output turns on EPOLLOUT until it drains. Nothing ever blocks.
+ * - A client that sends faster than it reads would grow its output without limit. Once its
+ *   unsent output passes OUTPUT_HIGH_WATER the session stops reading and answering; it goes
+ *   on once the output is down to OUTPUT_LOW_WATER.
+ * - Sessions use the quiet battle engine one action at a time, so a request never waits
+ *   for the other player.
+ * - Loops wake up at least every 100 ms to notice stop().
+ */
+
+#include "server.h"
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <thread>
+#include <unordered_map>
+#endif
+
+static const size_t READ_BUDGET = 16384;	//bytes read from one session per wakeup.
+static const size_t OUTPUT_HIGH_WATER = 65536;	//unsent bytes at which a session stops reading...
+static const size_t OUTPUT_LOW_WATER = 16384;	//...until its output is down to this.
+
+//appends a 16 bit little endian number.
+static void put_u16(vector<uint8_t> & out, int value)
+{
+	if (value < 0) value = 0;
+	if (value > 0xFFFF) value = 0xFFFF;
+	out.push_back(uint8_t(value & 0xFF));
+	out.push_back(uint8_t(value >> 8));
+}
+
+
+/****** SESSION IMPLEMENTATION ******/
+
+//a new match on the given socket, no teams yet.
+Session::Session(int fd): written(0), paused(false), watched(0), fd(fd), has_teams(false), wins{0, 0}
+{
+	string name = "Trainer 1";
+	trainers[0].set_name(name);
+	name = "Trainer 2";
+	trainers[1].set_name(name);
+	trainers[0].set_quiet(true);
+	trainers[1].set_quiet(true);
+}
+
+//closes the socket.
+Session::~Session()
+{
+#ifdef __linux__
+	if (fd >= 0)
+		close(fd);
+#endif
+}
+
+//the socket.
+int Session::get_fd() const
+{
+	return fd;
+}
+
+//handles one request and appends its response, returns 0 once the session should close.
+int Session::handle(const uint8_t request[REQUEST_SIZE], vector<uint8_t> & response)
+{
+	size_t start = response.size();
+	response.push_back(0);	//length, filled in at the end.
+	response.push_back(STATUS_OK);
+	int keep_open = 1;
+
+	uint8_t op = request[0];
+	if (op == OP_HELLO)
+	{
+		int size = request[1];
+		if (size < 1 || size > MAX_TEAM_SIZE)
+			response[start + 1] = STATUS_BAD_REQUEST;
+		else if (battle && !battle->finished())
+			response[start + 1] = STATUS_BATTLE_RUNNING;
+		else
+		{
+			battle.reset();	//its Pokemon are about to be replaced.
+			for (Trainer & trainer : trainers)
+			{
+				trainer.remove_all_pokemon();
+				trainer.build_team(size);
+			}
+			has_teams = true;
+			response.push_back(uint8_t(size));
+			response.push_back(uint8_t(size));
+		}
+	}
+	else if (op == OP_TEAM)
+	{
+		if (request[1] < 1 || request[1] > 2)
+			response[start + 1] = STATUS_BAD_REQUEST;
+		else if (!has_teams)
+			response[start + 1] = STATUS_NO_TEAM;
+		else
+		{
+			vector<Pokemon *> team;
+			trainers[request[1] - 1].get_team(team);
+			response.push_back(uint8_t(team.size()));
+			for (Pokemon * pokemon : team)
+			{
+				response.push_back(uint8_t(pokemon->get_type()));
+				response.push_back(uint8_t(pokemon->get_species()));
+				put_u16(response, pokemon->get_health());
+			}
+		}
+	}
+	else if (op == OP_START)
+	{
+		vector<Pokemon *> first_team, second_team;
+		trainers[0].get_team(first_team);
+		trainers[1].get_team(second_team);
+		if (!has_teams)
+			response[start + 1] = STATUS_NO_TEAM;
+		else if (battle && !battle->finished())
+			response[start + 1] = STATUS_BATTLE_RUNNING;
+		else if (request[1] >= first_team.size() || request[2] >= second_team.size())
+			response[start + 1] = STATUS_BAD_INDEX;
+		else
+		{
+			Pokemon * first = first_team[request[1]], * second = second_team[request[2]];
+			first = trainers[0].get_pokemon_for_update(first->get_species_id(), first->get_id());
+			second = trainers[1].get_pokemon_for_update(second->get_species_id(), second->get_id());
+			battle.reset(new Battle_engine(first, second));
+			battle_state(response);
+		}
+	}
+	else if (op == OP_MOVE)
+	{
+		if (request[1] != ATTACK && request[1] != SPECIAL)
+			response[start + 1] = STATUS_BAD_REQUEST;
+		else if (!battle || battle->finished())
+			response[start + 1] = STATUS_NO_BATTLE;
+		else
+		{
+			int winner = battle->act(request[1]);
+			if (winner == 1 || winner == 2)
+				++wins[winner - 1];
+			battle_state(response);
+		}
+	}
+	else if (op == OP_SCORE)
+	{
+		put_u16(response, wins[0]);
+		put_u16(response, wins[1]);
+	}
+	else if (op == OP_CLEAR)
+	{
+		if (request[1] < 1 || request[1] > 2)
+			response[start + 1] = STATUS_BAD_REQUEST;
+		else if (battle && !battle->finished())
+			response[start + 1] = STATUS_BATTLE_RUNNING;
+		else
+		{
+			battle.reset();
+			trainers[request[1] - 1].remove_all_pokemon();
+		}
+	}
+	else if (op == OP_QUIT)
+		keep_open = 0;
+	else
+		response[start + 1] = STATUS_BAD_REQUEST;
+
+	response[start] = uint8_t(response.size() - start - 1);
+	return keep_open;
+}
+
+//winner, side to move and both healths.
+void Session::battle_state(vector<uint8_t> & response) const
+{
+	response.push_back(uint8_t(battle->get_result().winner < 0 ? 0 : battle->get_result().winner));
+	response.push_back(uint8_t(battle->side_to_move()));
+	put_u16(response, battle->get_first()->get_health());
+	put_u16(response, battle->get_second()->get_health());
+}
+
+
+/****** BATTLE_SERVER IMPLEMENTATION ******/
+
+//remembers where to listen, nothing is opened until run().
+Battle_server::Battle_server(const string & address, int threads)
+	: address(address), threads(threads > 0 ? threads : 1), listener(-1),
+	  running(false), sessions(0), requests(0)
+{}
+
+//closes the listening socket.
+Battle_server::~Battle_server()
+{
+#ifdef __linux__
+	if (listener >= 0)
+		close(listener);
+	if (address.compare(0, 4, "tcp:") != 0)
+		unlink(address.c_str());
+#endif
+}
+
+//asks every loop to finish.
+void Battle_server::stop()
+{
+	running.store(false);
+}
+
+//connections accepted so far.
+long long Battle_server::sessions_served() const
+{
+	return sessions.load();
+}
+
+//requests handled so far.
+long long Battle_server::requests_served() const
+{
+	return requests.load();
+}
+
+#ifdef __linux__
+
+//binds the Unix socket path (or loopback TCP port) and starts listening.
+int Battle_server::open_listener()
+{
+	if (address.compare(0, 4, "tcp:") == 0)
+	{
+		listener = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+		if (listener < 0)
+			return -1;
+		int on = 1;
+		setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+		sockaddr_in where{};
+		where.sin_family = AF_INET;
+		where.sin_port = htons(uint16_t(stoi(address.substr(4))));
+		where.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		if (bind(listener, (sockaddr *)&where, sizeof(where)) < 0)
+			return -1;
+	}
+	else
+	{
+		listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+		if (listener < 0)
+			return -1;
+		sockaddr_un where{};
+		where.sun_family = AF_UNIX;
+		if (address.size() >= sizeof(where.sun_path))
+			return -1;
+		strncpy(where.sun_path, address.c_str(), sizeof(where.sun_path) - 1);
+		unlink(address.c_str());
+		if (bind(listener, (sockaddr *)&where, sizeof(where)) < 0)
+			return -1;
+	}
+	return listen(listener, 4096);
+}
+
+//starts the loops and waits for them to finish.
+int Battle_server::run()
+{
+	if (open_listener() < 0)
+	{
+		cerr << "Error: cannot listen on " << address << ": " << strerror(errno) << endl;
+		return -1;
+	}
+	running.store(true);
+	vector<thread> pool;
+	for (int i = 1; i < threads; ++i)
+		pool.emplace_back(&Battle_server::loop, this);
+	loop();
+	for (thread & t : pool)
+		t.join();
+	return 0;
+}
+
+//one event loop: accepts, reads, handles and writes until stop().
+void Battle_server::loop()
+{
+	int poller = epoll_create1(EPOLL_CLOEXEC);
+	if (poller < 0)
+		return;
+	epoll_event listen_event{};
+	listen_event.events = EPOLLIN | EPOLLEXCLUSIVE;
+	listen_event.data.ptr = nullptr;	//nullptr marks the listener.
+	epoll_ctl(poller, EPOLL_CTL_ADD, listener, &listen_event);
+
+	unordered_map<Session *, unique_ptr<Session>> owned;	//sessions on this thread.
+	vector<epoll_event> ready(256);
+	uint8_t chunk[4096];
+
+	//writes what the socket takes; false if the connection failed.
+	auto flush = [&](Session * session) -> bool
+	{
+		while (session->written < session->output.size())
+		{
+			ssize_t sent = send(session->get_fd(), session->output.data() + session->written,
+				session->output.size() - session->written, MSG_NOSIGNAL);
+			if (sent < 0)
+			{
+				if (errno == EAGAIN || errno == EWOULDBLOCK)
+					break;
+				return false;
+			}
+			session->written += size_t(sent);
+		}
+		if (session->written == session->output.size())
+		{
+			session->output.clear();
+			session->written = 0;
+		}
+		return true;
+	};
+
+	//watches for input unless the session is paused, and for EPOLLOUT while output is left.
+	auto watch = [&](Session * session)
+	{
+		size_t backlog = session->output.size() - session->written;
+		if (backlog > OUTPUT_HIGH_WATER)
+			session->paused = true;
+		else if (backlog <= OUTPUT_LOW_WATER)
+			session->paused = false;
+		uint32_t wanted = (session->paused ? 0 : EPOLLIN | EPOLLRDHUP) | (backlog ? EPOLLOUT : 0);
+		if (wanted == session->watched)
+			return;
+		epoll_event event{};
+		event.events = wanted;
+		event.data.ptr = session;
+		epoll_ctl(poller, EPOLL_CTL_MOD, session->get_fd(), &event);
+		session->watched = wanted;
+	};
+
+	//reads up to READ_BUDGET bytes; false once the connection is closed or failed.
+	auto receive = [&](Session * session) -> bool
+	{
+		size_t budget = READ_BUDGET;
+		while (budget > 0)
+		{
+			ssize_t got = recv(session->get_fd(), chunk, budget < sizeof(chunk) ? budget : sizeof(chunk), 0);
+			if (got > 0)
+			{
+				session->input.insert(session->input.end(), chunk, chunk + got);
+				budget -= size_t(got);
+				continue;
+			}
+			return got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+		}
+		return true;
+	};
+
+	//handles whole requests until they run out or the unsent output passes the high-water
+	//mark; false once the session should close.
+	auto answer = [&](Session * session) -> bool
+	{
+		size_t used = 0;
+		long long handled = 0;
+		bool open = true;
+		while (session->input.size() - used >= size_t(REQUEST_SIZE)
+			&& session->output.size() - session->written <= OUTPUT_HIGH_WATER)
+		{
+			++handled;
+			if (!session->handle(session->input.data() + used, session->output))
+			{
+				used = session->input.size();
+				open = false;
+				break;
+			}
+			used += REQUEST_SIZE;
+		}
+		session->input.erase(session->input.begin(), session->input.begin() + long(used));
+		requests.fetch_add(handled, memory_order_relaxed);
+		return open;
+	};
+
+	auto drop = [&](Session * session)
+	{
+		epoll_ctl(poller, EPOLL_CTL_DEL, session->get_fd(), nullptr);
+		owned.erase(session);
+	};
+
+	while (running.load())
+	{
+		int count = epoll_wait(poller, ready.data(), int(ready.size()), 100);
+		for (int i = 0; i < count; ++i)
+		{
+			Session * session = (Session *)ready[i].data.ptr;
+			if (!session)
+			{
+				//accept everything that is waiting.
+				while (true)
+				{
+					int fd = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+					if (fd < 0)
+						break;
+					int on = 1;
+					setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));	//fails harmlessly on Unix sockets.
+					Session * made = new Session(fd);
+					owned[made].reset(made);
+					epoll_event event{};
+					event.events = EPOLLIN | EPOLLRDHUP;
+					event.data.ptr = made;
+					epoll_ctl(poller, EPOLL_CTL_ADD, fd, &event);
+					made->watched = event.events;
+					sessions.fetch_add(1, memory_order_relaxed);
+				}
+				continue;
+			}
+
+			//resume the session: read its share, then answer and write in turns until the
+			//whole requests run out or its client stops reading.
+			bool keep = true;
+			if (!session->paused && (ready[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)))
+				keep = receive(session);
+			else if (ready[i].events & (EPOLLHUP | EPOLLERR))
+				keep = false;	//gone while paused.
+			bool more = true;
+			while (more)
+			{
+				bool open = answer(session);
+				keep = flush(session) && open && keep;
+				more = keep && session->input.size() >= size_t(REQUEST_SIZE)
+					&& session->output.size() - session->written <= OUTPUT_HIGH_WATER;
+			}
+			if (keep)
+				watch(session);
+			else
+				drop(session);
+		}
+	}
+	close(poller);
+}
+
+#else
+
+//epoll is Linux only.
+int Battle_server::open_listener()
+{
+	return -1;
+}
+
+//epoll is Linux only.
+int Battle_server::run()
+{
+	cerr << "Error: the battle server needs Linux (epoll)." << endl;
+	return -1;
+}
+
+//epoll is Linux only.
+void Battle_server::loop()
+{}
+
+#endif
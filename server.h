@@ -0,0 +1,102 @@
+// Author: Pokemon Battle contributors
+// Date: 10-17-2026
+//
+// This file contains the wire protocol and the class declarations for the battle server.
+
+/*
+ * Battle Server for Pokemon Battle Simulation
+ *
+ * `Battle_server` serves many stadium matches from one process. It listens on a Unix domain
+ * socket (or on loopback TCP with an address of the form "tcp:PORT") and runs one epoll
+ * event loop per thread. Every connection is a `Session`: two trainers, their score and the
+ * battle in progress. Sessions are resumable state machines -- when their socket is readable
+ * they take a bounded share of input, answer the complete requests, queue the responses and
+ * yield -- so one thread can carry thousands of matches and no client can starve the rest.
+ * A client that doesn't read its responses is paused until it does. A session lives on the
+ * thread that accepted it; threads share nothing but the listening socket.
+ *
+ * Protocol (every request is exactly 4 bytes: op, a, b, c):
+ *   HELLO  a = team size	new teams for both trainers		-> size 1, size 2
+ *   TEAM   a = trainer		list a team				-> count, (type, species, health lo, health hi) x count
+ *   START  a, b = indices	battle trainer 1's a against trainer 2's b	-> BATTLE_STATE
+ *   MOVE   a = action		the side to move attacks (1) or uses its special ability (2)	-> BATTLE_STATE
+ *   SCORE			current score				-> wins 1 lo, hi, wins 2 lo, hi
+ *   CLEAR  a = trainer		remove a whole team			-> (nothing)
+ *   QUIT			close the session			-> (nothing)
+ * BATTLE_STATE is: winner (0 while running), side to move, health 1 lo, hi, health 2 lo, hi.
+ * Every response is: length (bytes that follow), status, payload.
+ *
+ * The server needs Linux (epoll). On other systems `run` reports that it is unsupported.
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "battle.h"
+#include <atomic>
+
+/* Request op codes. */
+const uint8_t OP_HELLO = 1;
+const uint8_t OP_TEAM = 2;
+const uint8_t OP_START = 3;
+const uint8_t OP_MOVE = 4;
+const uint8_t OP_SCORE = 5;
+const uint8_t OP_CLEAR = 6;
+const uint8_t OP_QUIT = 7;
+
+/* Response status codes. */
+const uint8_t STATUS_OK = 0;
+const uint8_t STATUS_BAD_REQUEST = 1;
+const uint8_t STATUS_NO_TEAM = 2;
+const uint8_t STATUS_NO_BATTLE = 3;
+const uint8_t STATUS_BAD_INDEX = 4;
+const uint8_t STATUS_BATTLE_RUNNING = 5;
+
+const int REQUEST_SIZE = 4;	//bytes in every request.
+const int MAX_TEAM_SIZE = 50;	//same limit as the menu.
+
+/* This class is one connected match: two trainers, their score and the battle in progress. */
+class Session
+{
+	public:
+		Session(int fd);	//takes ownership of the socket.
+		~Session();		//closes the socket.
+		int handle(const uint8_t request[REQUEST_SIZE], vector<uint8_t> & response);	//one request, 0 once the session should close.
+		int get_fd() const;	//the socket.
+
+		vector<uint8_t> input;	//bytes read but not yet answered.
+		vector<uint8_t> output;	//responses not yet written.
+		size_t written;		//how much of output has been written.
+		bool paused;		//not read or answered while too much output is unsent.
+		uint32_t watched;	//epoll events registered for the socket.
+	private:
+		int fd;			//the socket.
+		Trainer trainers[2];	//the two trainers.
+		bool has_teams;		//true after HELLO.
+		int wins[2];		//battles won by each trainer.
+		unique_ptr<Battle_engine> battle;	//the battle in progress.
+		void battle_state(vector<uint8_t> & response) const;	//appends BATTLE_STATE.
+};
+
+/* This class accepts connections and runs sessions on a few event loop threads. */
+class Battle_server
+{
+	public:
+		Battle_server(const string & address, int threads = 1);	//"path" or "tcp:PORT".
+		~Battle_server();	//closes the listening socket.
+		int run();		//serves until stop(), returns 0 on a clean shutdown, -1 on error.
+		void stop();		//asks every loop to finish (safe from a signal handler).
+		long long sessions_served() const;	//connections accepted so far.
+		long long requests_served() const;	//requests handled so far.
+	private:
+		string address;		//where to listen.
+		int threads;		//event loop threads.
+		int listener;		//listening socket.
+		atomic<bool> running;	//cleared by stop().
+		atomic<long long> sessions;	//connections accepted.
+		atomic<long long> requests;	//requests handled.
+		int open_listener();	//binds and listens.
+		void loop();		//one event loop thread.
+};
+
+#endif
@@ -0,0 +1,295 @@
+// Author: Pokemon Battle contributors
+// Date: 10-17-2026
+//
+// This file contains the implementation of the Tournament class and its work-stealing pool.
+
+/*
+ * Overview:
+ * - A `Task` is a range of matchups of one stadium. Matchup `k` of a stadium pairs
+ *   Pokemon `k / M` of trainer 1 with Pokemon `k % M` of trainer 2.
+ * - Each worker owns a `Work_queue`. It takes tasks from the back and, while a task is
+ *   bigger than `GRAIN`, pushes the upper half back for thieves to find. Idle workers
+ *   steal from the front of other queues (oldest, biggest tasks first).
+ * - Tasks are never created after the pool starts except by splitting, so a worker
+ *   that finds every queue empty can stop.
+ */
+
+#include "tournament.h"
+#include "battle_log.h"
+#include <thread>
+#include <mutex>
+#include <deque>
+#include <chrono>
+
+static const long long GRAIN = 256;	//smallest range worth splitting.
+
+//range of matchups of one stadium.
+struct Task
+{
+	size_t stadium;		//index into the roster pairs.
+	long long begin;	//first matchup.
+	long long end;		//one past the last matchup.
+};
+
+//one worker's deque; padded so neighbouring queues don't share a cache line.
+struct alignas(64) Work_queue
+{
+	mutex lock;		//guards tasks.
+	deque<Task> tasks;	//owner uses the back, thieves use the front.
+};
+
+//one worker's private results.
+struct alignas(64) Worker_tally
+{
+	vector<Tally> stadiums;	//one tally per stadium.
+	vector<uint8_t> log;	//encoded battle records, if logging.
+};
+
+//plays one battle on copies of the two Pokemon, so the rosters are never written.
+template <typename A, typename B>
+static Battle_result play_copies(const A & first, const B & second, Policy & first_policy, Policy & second_policy,
+	Log_record * record)
+{
+	A first_copy(first);
+	B second_copy(second);
+	if (record)
+		return Battle_log::play(&first_copy, &second_copy, first_policy, second_policy, *record);
+	Battle_engine engine(&first_copy, &second_copy);
+	return engine.run(first_policy, second_policy);
+}
+
+//resolves the second Pokemon's type.
+template <typename A>
+static Battle_result play_against(const A & first, const Pokemon * second, Policy & first_policy, Policy & second_policy,
+	Log_record * record)
+{
+	if (const Fire * fire_ptr = dynamic_cast<const Fire *>(second))
+		return play_copies(first, *fire_ptr, first_policy, second_policy, record);
+	if (const Water * water_ptr = dynamic_cast<const Water *>(second))
+		return play_copies(first, *water_ptr, first_policy, second_policy, record);
+	if (const Grass * grass_ptr = dynamic_cast<const Grass *>(second))
+		return play_copies(first, *grass_ptr, first_policy, second_policy, record);
+	return Battle_result{-1, 0, 0, 0};
+}
+
+//resolves the first Pokemon's type.
+static Battle_result play_matchup(const Pokemon * first, const Pokemon * second, Policy & first_policy, Policy & second_policy,
+	Log_record * record)
+{
+	if (const Fire * fire_ptr = dynamic_cast<const Fire *>(first))
+		return play_against(*fire_ptr, second, first_policy, second_policy, record);
+	if (const Water * water_ptr = dynamic_cast<const Water *>(first))
+		return play_against(*water_ptr, second, first_policy, second_policy, record);
+	if (const Grass * grass_ptr = dynamic_cast<const Grass *>(first))
+		return play_against(*grass_ptr, second, first_policy, second_policy, record);
+	return Battle_result{-1, 0, 0, 0};
+}
+
+
+/****** TALLY IMPLEMENTATION ******/
+
+//adds another tally to this one.
+void Tally::merge(const Tally & other)
+{
+	trainer1_wins += other.trainer1_wins;
+	trainer2_wins += other.trainer2_wins;
+	draws += other.draws;
+	battles += other.battles;
+	turns += other.turns;
+}
+
+
+/****** TOURNAMENT IMPLEMENTATION ******/
+
+//sets the number of workers (0 = one per core).
+Tournament::Tournament(int threads): total(0), threads(threads)
+{
+	if (this->threads <= 0)
+		this->threads = int(thread::hardware_concurrency());
+	if (this->threads <= 0)
+		this->threads = 1;
+}
+
+//queues every pairing of the stadium's two trainers.
+int Tournament::add_stadium(const Stadium & stadium)
+{
+	return add_trainers(stadium.get_trainer(1), stadium.get_trainer(2));
+}
+
+//queues every pairing between the two rosters.
+int Tournament::add_trainers(const Trainer & first, const Trainer & second)
+{
+	Roster_pair pair;
+	first.get_team(pair.first);
+	second.get_team(pair.second);
+	pair.first_name = first.get_name();
+	pair.second_name = second.get_name();
+	pair.offset = total;
+	total += (long long)pair.first.size() * (long long)pair.second.size();
+	pairs.push_back(pair);
+	return int(pairs.size());
+}
+
+//records every battle of later runs into a binary log file.
+void Tournament::set_log(const string & path)
+{
+	log_path = path;
+}
+
+//number of battles queued.
+long long Tournament::matchups() const
+{
+	return total;
+}
+
+//random policy on both sides.
+Tournament_result Tournament::run()
+{
+	Policy_factory random_factory = []() { return unique_ptr<Policy>(new Random_policy); };
+	return run(random_factory, random_factory);
+}
+
+//plays every queued battle on the pool and merges the tallies.
+Tournament_result Tournament::run(Policy_factory first, Policy_factory second)
+{
+	Tournament_result result;
+	result.threads = threads;
+	result.seed = RNG::is_seeded() ? RNG::get_seed()
+		: (uint64_t(RNG::random_num(0, 0x7FFFFFFF)) << 32) | uint64_t(RNG::random_num(0, 0x7FFFFFFF));
+	result.total = Tally{0, 0, 0, 0, 0};
+	result.stadiums.assign(pairs.size(), result.total);
+
+	vector<Work_queue> queues(threads);
+	vector<Worker_tally> tallies(threads);
+
+	//hand every stadium's matchups out in one contiguous range per worker.
+	for (size_t s = 0; s < pairs.size(); ++s)
+	{
+		long long count = (long long)pairs[s].first.size() * (long long)pairs[s].second.size();
+		long long chunk = (count + threads - 1) / threads;
+		for (int w = 0; w < threads && chunk > 0; ++w)
+		{
+			long long begin = w * chunk;
+			long long end = begin + chunk < count ? begin + chunk : count;
+			if (begin < end)
+				queues[w].tasks.push_back(Task{s, begin, end});
+		}
+	}
+
+	uint64_t seed = result.seed;
+	bool logging = !log_path.empty();
+	auto worker = [&](int id)
+	{
+		unique_ptr<Policy> first_policy = first();
+		unique_ptr<Policy> second_policy = second();
+		vector<Tally> & local = tallies[id].stadiums;
+		local.assign(pairs.size(), Tally{0, 0, 0, 0, 0});
+		unsigned victim_seed = unsigned(id) * 2654435761u + 1;
+		Log_record record;
+
+		while (true)
+		{
+			Task task;
+			bool found = false;
+			{
+				lock_guard<mutex> guard(queues[id].lock);
+				if (!queues[id].tasks.empty())
+				{
+					task = queues[id].tasks.back();
+					queues[id].tasks.pop_back();
+					found = true;
+				}
+			}
+			//own queue is empty: try to steal, starting at a random victim.
+			if (!found && threads > 1)
+			{
+				victim_seed = victim_seed * 1664525u + 1013904223u;
+				int victim = int((victim_seed >> 8) % unsigned(threads));
+				for (int v = 0; !found && v < threads; ++v)
+				{
+					int other = (victim + v) % threads;
+					if (other == id)
+						continue;
+					lock_guard<mutex> guard(queues[other].lock);
+					if (!queues[other].tasks.empty())
+					{
+						task = queues[other].tasks.front();
+						queues[other].tasks.pop_front();
+						found = true;
+					}
+				}
+			}
+			if (!found)
+				return;
+
+			//leave the upper halves of a big task where thieves can reach them.
+			while (task.end - task.begin > GRAIN)
+			{
+				long long middle = task.begin + (task.end - task.begin) / 2;
+				lock_guard<mutex> guard(queues[id].lock);
+				queues[id].tasks.push_back(Task{task.stadium, middle, task.end});
+				task.end = middle;
+			}
+
+			const Roster_pair & pair = pairs[task.stadium];
+			long long width = (long long)pair.second.size();
+			Tally & tally = local[task.stadium];
+			for (long long k = task.begin; k < task.end; ++k)
+			{
+				Stream stream(seed, uint64_t(pair.offset + k));
+				Stream_scope scope(stream);
+				Battle_result battle = play_matchup(pair.first[k / width], pair.second[k % width],
+					*first_policy, *second_policy, logging ? &record : nullptr);
+				if (logging)
+					Battle_log::encode(record, tallies[id].log);
+				if (battle.winner == 1)
+					++tally.trainer1_wins;
+				else if (battle.winner == 2)
+					++tally.trainer2_wins;
+				else
+					++tally.draws;
+				++tally.battles;
+				tally.turns += battle.turns;
+			}
+		}
+	};
+
+	auto start = chrono::steady_clock::now();
+	vector<thread> pool;
+	for (int w = 1; w < threads; ++w)
+		pool.emplace_back(worker, w);
+	worker(0);
+	for (thread & t : pool)
+		t.join();
+	auto stop = chrono::steady_clock::now();
+
+	for (const Worker_tally & worker_tally : tallies)
+		for (size_t s = 0; s < worker_tally.stadiums.size(); ++s)
+			result.stadiums[s].merge(worker_tally.stadiums[s]);
+	for (const Tally & tally : result.stadiums)
+		result.total.merge(tally);
+	for (const Worker_tally & worker_tally : tallies)
+		if (logging && Battle_log::append_file(log_path, worker_tally.log) < 0)
+			cerr << "Error: cannot write battle log " << log_path << endl;
+
+	result.seconds = chrono::duration<double>(stop - start).count();
+	result.battles_per_second = result.seconds > 0 ? double(result.total.battles) / result.seconds : 0;
+	return result;
+}
+
+//prints the tallies and the throughput.
+void Tournament::display(const Tournament_result & result) const
+{
+	cout << "\n--- Tournament Results ---" << endl;
+	for (size_t s = 0; s < result.stadiums.size() && s < pairs.size(); ++s)
+	{
+		const Tally & tally = result.stadiums[s];
+		cout << "Stadium " << s + 1 << ": "
+			<< pairs[s].first_name << " " << tally.trainer1_wins << " wins, "
+			<< pairs[s].second_name << " " << tally.trainer2_wins << " wins, "
+			<< tally.draws << " draws\n";
+	}
+	cout << "Battles: " << result.total.battles << "  Turns: " << result.total.turns << "\n";
+	cout << "Threads: " << result.threads << "  Seed: " << result.seed << "\n";
+	cout << "Time: " << result.seconds << " s  (" << (long long)result.battles_per_second << " battles/sec)" << endl;
+}
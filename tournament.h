@@ -0,0 +1,80 @@
+// Author: Pokemon Battle contributors
+// Date: 10-17-2026
+//
+// This file contains the class declarations for the multithreaded tournament runner.
+
+/*
+ * Tournament Runner for Pokemon Battle Simulation
+ *
+ * `Tournament` simulates every pairing between the rosters of two trainers, for any
+ * number of `Stadium`s, across all cores.
+ *
+ * - Matchups are split into ranges and handed to a work-stealing pool: every worker owns
+ *   a deque, pops work from its back, splits big ranges, and steals from the front of a
+ *   random other deque when it runs dry. Each deque has its own lock; there is no global one.
+ * - Workers only read the rosters. Every battle runs on private copies of the two Pokemon
+ *   through the quiet `Battle_engine`, so there is no output and no shared mutable state.
+ * - Every worker keeps its own `Tally` per stadium; tallies are merged after the workers join.
+ * - Battle `k` always draws from `Stream(seed, k)`, so results are identical for any
+ *   number of threads.
+ */
+
+#ifndef TOURNAMENT_H
+#define TOURNAMENT_H
+
+#include "battle.h"
+
+/* This struct is the win/loss tally for one stadium (or for all of them). */
+struct Tally
+{
+	long long trainer1_wins;	//battles won by trainer 1's Pokemon.
+	long long trainer2_wins;	//battles won by trainer 2's Pokemon.
+	long long draws;		//battles that hit the turn limit.
+	long long battles;		//battles simulated.
+	long long turns;		//turns simulated.
+	void merge(const Tally & other);	//adds another tally to this one.
+};
+
+/* This struct is what a tournament returns. */
+struct Tournament_result
+{
+	vector<Tally> stadiums;		//one tally per stadium, in the order added.
+	Tally total;			//all stadiums together.
+	int threads;			//workers used.
+	uint64_t seed;			//seed the battle streams were keyed on.
+	double seconds;			//wall clock time of the run.
+	double battles_per_second;	//throughput.
+};
+
+/* This class runs all pairings between two rosters, for every stadium added,
+ * on a work-stealing thread pool.
+ */
+class Tournament
+{
+	public:
+		typedef function<unique_ptr<Policy>()> Policy_factory;	//makes one policy per worker.
+
+		Tournament(int threads = 0);	//0 = one worker per core.
+		int add_stadium(const Stadium & stadium);	//queues every pairing of the stadium's two trainers.
+		int add_trainers(const Trainer & first, const Trainer & second);	//same, for two trainers.
+		long long matchups() const;	//number of battles queued.
+		void set_log(const string & path);	//records every battle into a binary log ("" = off).
+		Tournament_result run();	//random policy on both sides.
+		Tournament_result run(Policy_factory first, Policy_factory second);	//plays every battle.
+		void display(const Tournament_result & result) const;	//prints the tallies.
+	private:
+		struct Roster_pair
+		{
+			vector<Pokemon *> first;	//trainer 1's roster (not owned).
+			vector<Pokemon *> second;	//trainer 2's roster (not owned).
+			string first_name;		//trainer 1's name.
+			string second_name;		//trainer 2's name.
+			long long offset;		//battle id of this stadium's first matchup.
+		};
+		vector<Roster_pair> pairs;	//everything queued so far.
+		long long total;		//battles queued.
+		int threads;			//workers to use.
+		string log_path;		//binary battle log, empty if off.
+};
+
+#endif
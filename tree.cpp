@@ -7,7 +7,7 @@
  * Overview:
  * - `Node` Class:
  *   - Represents individual nodes in the BST.
- *   - Stores a single `Pokemon` pointer and manages left and right child pointers.
+ *   - Stores a single `Pokemon` pointer and manages left, right and parent pointers.
  *   - Includes functionality for deep copying and safely managing dynamic memory.
  *
  * - `BST` Class:
@@ -16,7 +16,10 @@
  *   - Ensures proper memory management with a destructor, copy constructor, and assignment operator.
  *
  * Key Features:
- * - Recursive implementations for all core tree operations.
+ * - Iterative implementations for all core tree operations: duplicate names make long
+ *   right chains, so recursion deep enough to overflow the stack is avoided. Walks follow
+ *   parent pointers, so they need no stack and never write to the tree (const walks are
+ *   safe to run side by side, and a throw in the middle of one leaves the tree intact).
  * - Dynamic memory safety with deep copies and pointer management.
  * - Integration with the Pokemon class hierarchy for battle simulation.
  */
@@ -24,7 +27,7 @@
 #include "data_structures.h"
 
 //default constructor
-Node::Node(): data{nullptr}, left{nullptr}, right{nullptr}
+Node::Node(): data{nullptr}, left{nullptr}, right{nullptr}, parent{nullptr}
 {}
 
 //destructor
@@ -38,19 +41,11 @@ Node::~Node()
 }
 
 //custom copy constructor.
-Node::Node(const Node &source)
+Node::Node(const Node &source): data{nullptr}, left{nullptr}, right{nullptr}, parent{nullptr}
 {
 	if (source.data)
 	{
-		try
-		{
-			copy(source.data);	//deep copy w/ RTTI to copy the correct data.
-		}
-		catch (const string &e)
-		{
-			cerr << "Error in Node copy constructor: " << e << endl;
-			throw;
-		}
+		copy(source.data);	//deep copy w/ RTTI to copy the correct data.
 	}
 }
 
@@ -62,29 +57,21 @@ Node & Node::operator=(const Node & source)
 		return *this; // Handle self-assignment
 	}
 
-	try
+	// Clean up existing data
+	if (data)
 	{
-		// Clean up existing data
-		if (data)
-		{
-			delete data;
-			data = nullptr;
-		}
-
-		// Deep copy the data
-		if (source.data)
-		{
-			copy(source.data);	//deep copy w/ RTTI to copy the correct data.
-		}
-
-		// Child pointers remain unchanged, as they are managed by the tree structure
+		delete data;
+		data = nullptr;
 	}
-	catch (const string &e)
+
+	// Deep copy the data
+	if (source.data)
 	{
-		cerr << "Error in Node::operator=: " << e << endl;
-		throw;
+		copy(source.data);	//deep copy w/ RTTI to copy the correct data.
 	}
 
+	// Child pointers remain unchanged, as they are managed by the tree structure
+
 	return *this;
 }
 
@@ -100,6 +87,12 @@ Node *& Node::get_right()
 	return right;
 }
 
+//returns the parent (nullptr for the root).
+Node *& Node::get_parent()
+{
+	return parent;
+}
+
 //returns the data for retrival.
 Pokemon *& Node::get_data()
 {
@@ -119,41 +112,45 @@ void Node::set_right(Node *new_right)
 	right = new_right;
 }
 
+//sets the passed in parent to parent.
+void Node::set_parent(Node *new_parent)
+{
+	parent = new_parent;
+}
+
 //sets the passed in data to data.
 void Node::set_data(Pokemon *new_data)
 {
 	data = new_data;	
 }
 
-void Node::copy(const Pokemon * source)
+//deep copies the source with RTTI, returns 0 (and leaves data empty) if it can't.
+int Node::copy(const Pokemon * source)
 {
 	if (!source)
 	{
-		throw string("Invalid source passed to Node::copy.");
+		cerr << "Error in Node::copy: Invalid source passed to Node::copy." << endl;
+		return 0;
 	}
 
-	try
+	// Attempt to dynamic_cast to each derived type
+	const Fire *fire_ptr = dynamic_cast<const Fire *>(source);
+	const Water *water_ptr = dynamic_cast<const Water *>(source);
+	const Grass *grass_ptr = dynamic_cast<const Grass *>(source);
+
+	// Allocate based on the type
+	if (fire_ptr)
+		data = new Fire(*fire_ptr); // Deep copy Fire
+	else if (water_ptr)
+		data = new Water(*water_ptr); // Deep copy Water
+	else if (grass_ptr)
+		data = new Grass(*grass_ptr); // Deep copy Grass
+	else
 	{
-		// Attempt to dynamic_cast to each derived type
-		const Fire *fire_ptr = dynamic_cast<const Fire *>(source);
-		const Water *water_ptr = dynamic_cast<const Water *>(source);
-		const Grass *grass_ptr = dynamic_cast<const Grass *>(source);
-
-		// Allocate based on the type
-		if (fire_ptr)
-			data = new Fire(*fire_ptr); // Deep copy Fire
-		else if (water_ptr)
-			data = new Water(*water_ptr); // Deep copy Water
-		else if (grass_ptr)
-			data = new Grass(*grass_ptr); // Deep copy Grass
-		else
-			throw string("Unsupported Pokemon type in Node::copy.");
+		cerr << "Error in Node::copy: Unsupported Pokemon type in Node::copy." << endl;
+		return 0;
 	}
-	catch (const string &e)
-	{
-		cerr << "Error in Node::copy: " << e << endl;
-		throw;
-	}	
+	return 1;
 }
 /****** END OF NODE CLASS ******/
 
@@ -171,14 +168,7 @@ BST::BST(): root(nullptr)
 // Destructor
 BST::~BST()
 {
-    try
-    {
-        remove_all();
-    }
-    catch (const string &e)
-    {
-        cerr << "Exception in destructor: " << e << endl;
-    }
+    remove_all();
 }
 
 // Copy constructor
@@ -186,7 +176,7 @@ BST::BST(const BST &source): root(nullptr)
 {
     if (source.root)
     {
-        copy(root, source.root);
+        copy(source.root);
     }
 }
 
@@ -196,19 +186,32 @@ BST &BST::operator=(const BST &source)
     if (this != &source)
     {
         remove_all(); // Clear current tree
-        copy(root, source.root); // Copy source tree
+        copy(source.root); // Copy source tree
     }
     return *this;
 }
 
-// Insert a Pokemon into the tree
+// Insert a Pokemon into the tree (equal names go to the right)
 int BST::insert(Pokemon *to_add)
 {
     if (!to_add)
     {
-        throw string("Cannot insert a null Pokemon.");
+        return 0; // Nothing to insert
     }
-    return insert(root, to_add);
+    Node **link = &root;
+    Node *parent = nullptr;
+    while (*link)
+    {
+        parent = *link;
+        if (to_add->get_name() < (*link)->get_data()->get_name())
+            link = &(*link)->get_left();
+        else
+            link = &(*link)->get_right();
+    }
+    *link = new Node;
+    (*link)->set_data(to_add);
+    (*link)->set_parent(parent);
+    return 1;
 }
 
 // Display all Pokemon in the tree
@@ -219,162 +222,191 @@ int BST::display_all() const
         cout << "Tree is empty." << endl;
         return 0;
     }
-    return display_all(root);
+    for (Node *visit = next_in_order(nullptr); visit; visit = next_in_order(visit))
+    {
+        cout << "\n===================\n";
+        visit->get_data()->display();
+        cout << "\n===================\n";
+    }
+    return 1;
 }
 
-// Remove all Pokemon from the tree
+// Remove all Pokemon from the tree: rotates left children up so every node is freed
+// with its right subtree already relinked, no recursion or stack needed (parent
+// pointers go stale on the way, but every node is freed)
 int BST::remove_all()
 {
-    return remove_all(root);
-}
-
-// Remove a specific Pokemon
-int BST::remove_specific(const string &name_to_remove)
-{
-    if (name_to_remove.empty())
+    if (!root)
     {
-        throw string("Name to remove cannot be empty.");
+        return 0;
     }
-    return remove_specific(root, name_to_remove);
-}
-
-// Retrieve a Pokemon by name
-Pokemon *&BST::retrieve(const string &name_to_find)
-{
-    if (name_to_find.empty())
+    while (root)
     {
-        throw string("Name to find cannot be empty.");
+        Node *left = root->get_left();
+        if (left)
+        {
+            root->set_left(left->get_right());
+            left->set_right(root);
+            root = left;
+        }
+        else
+        {
+            Node *right = root->get_right();
+            delete root; // Frees the Pokemon too
+            root = right;
+        }
     }
-    return retrieve(root, name_to_find);
+    return 1;
 }
 
-// Recursive helper for insertion
-int BST::insert(Node *&root, Pokemon *to_add)
+// Remove the first Pokemon with the name found on the search path
+int BST::remove_specific(const string &name_to_remove)
 {
-    if (!root)
+    if (name_to_remove.empty())
     {
-        root = new Node;
-		root->set_data(to_add);
-        return 1;
+        return 0; // No Pokemon has an empty name
     }
-    if (to_add->get_name() < root->get_data()->get_name())
+    Node **link = &root;
+    while (*link && name_to_remove != (*link)->get_data()->get_name())
     {
-        return insert(root->get_left(), to_add);
+        if (name_to_remove < (*link)->get_data()->get_name())
+            link = &(*link)->get_left();
+        else
+            link = &(*link)->get_right();
     }
-    return insert(root->get_right(), to_add);
-}
-
-// Recursive helper for displaying all nodes
-int BST::display_all(Node *root) const
-{
-    if (!root)
+    if (!*link)
     {
         return 0;
     }
-    display_all(root->get_left());
-	cout << "\n===================\n";
-	root->get_data()->display();
-	cout << "\n===================\n";
-    display_all(root->get_right());
-    return 1;
-}
 
-// Recursive helper to remove all nodes
-int BST::remove_all(Node *&root)
-{
-    if (!root)
+    Node *temp = *link;
+    if (!temp->get_left() || !temp->get_right())
     {
-        return 0;
+        Node *child = temp->get_left() ? temp->get_left() : temp->get_right();
+        if (child)
+            child->set_parent(temp->get_parent());
+        *link = child;
     }
-    remove_all(root->get_left());
-    remove_all(root->get_right());
-    //delete root->get_data(); // Free the Pokemon object
-    delete root; // Free the Node
-    root = nullptr;
+    else
+    {
+        // Unlink the in-order successor and put it where temp was
+        Node **successor = &temp->get_right();
+        while ((*successor)->get_left())
+            successor = &(*successor)->get_left();
+        Node *min_node = *successor;
+        *successor = min_node->get_right();
+        if (min_node->get_right())
+            min_node->get_right()->set_parent(min_node->get_parent());
+        min_node->set_left(temp->get_left());
+        min_node->set_right(temp->get_right());
+        min_node->set_parent(temp->get_parent());
+        min_node->get_left()->set_parent(min_node);
+        if (min_node->get_right())
+            min_node->get_right()->set_parent(min_node);
+        *link = min_node;
+    }
+    delete temp; // Frees the Pokemon too
     return 1;
 }
 
-// Recursive helper to remove a specific node
-int BST::remove_specific(Node *&root, const string &name_to_remove)
+// Retrieve a Pokemon by name: 1 and found set on a hit, 0 and found = nullptr on a miss
+int BST::retrieve(const string &name_to_find, Pokemon *&found) const
 {
-    if (!root)
-    {
-        return 0;
-    }
-
-    if (name_to_remove < root->get_data()->get_name())
-    {
-        return remove_specific(root->get_left(), name_to_remove);
-    }
-    else if (name_to_remove > root->get_data()->get_name())
+    found = nullptr;
+    if (name_to_find.empty())
     {
-        return remove_specific(root->get_right(), name_to_remove);
+        return 0; // No Pokemon has an empty name
     }
-    else
+    Node *current = root;
+    while (current)
     {
-        Node *temp = root;
-        if (!root->get_left())
-        {
-            root = root->get_right();
-        }
-        else if (!root->get_right())
-        {
-            root = root->get_left();
-        }
+        if (name_to_find < current->get_data()->get_name())
+            current = current->get_left();
+        else if (name_to_find > current->get_data()->get_name())
+            current = current->get_right();
         else
         {
-            Node *min_node = find_ios(root->get_right());
-            root->get_data() = min_node->get_data();
-            remove_specific(root->get_right(), min_node->get_data()->get_name());
+            found = current->get_data();
+            return 1;
         }
-        delete temp->get_data();
-        delete temp;
-        return 1;
     }
+    return 0; // A miss is an ordinary outcome (a mistyped name), not an error
 }
 
-// Recursive helper to retrieve a node by name
-Pokemon *&BST::retrieve(Node *root, const string &name_to_find)
+// Append every Pokemon in the tree (in order) to out
+int BST::collect(vector<Pokemon *> &out) const
 {
-    if (!root)
+    int count = 0;
+    for (Node *visit = next_in_order(nullptr); visit; visit = next_in_order(visit))
     {
-        throw string("Pokemon not found.");
+        out.push_back(visit->get_data());
+        ++count;
     }
-    if (name_to_find < root->get_data()->get_name())
-    {
-        return retrieve(root->get_left(), name_to_find);
-    }
-    else if (name_to_find > root->get_data()->get_name())
-    {
-        return retrieve(root->get_right(), name_to_find);
-    }
-    return root->get_data();
+    return count;
 }
 
-// Recursive helper to copy tree nodes
-int BST::copy(Node *&dest, Node *src)
+// Copies src into this empty tree, giving it the same shape: a pre-order walk of src
+// (through its parent pointers, src is only read) that hangs each copy under the copy
+// of its parent. O(n); if a copy throws, everything copied so far is freed.
+int BST::copy(Node *src)
 {
     if (!src)
     {
         return 0;
     }
-
-    dest = new Node(*src); // Deep copy Pokemon
-    copy(dest->get_left(), src->get_left());
-    copy(dest->get_right(), src->get_right());
+    try
+    {
+        root = new Node(*src); // Deep copies the Pokemon
+        Node *from = src;
+        Node *to = root;
+        while (true)
+        {
+            Node *next = nullptr;
+            if (from->get_left() && !to->get_left())
+            {
+                next = new Node(*from->get_left());
+                to->set_left(next);
+                from = from->get_left();
+            }
+            else if (from->get_right() && !to->get_right())
+            {
+                next = new Node(*from->get_right());
+                to->set_right(next);
+                from = from->get_right();
+            }
+            if (next)
+            {
+                next->set_parent(to);
+                to = next;
+                continue;
+            }
+            if (from == src)
+                break; // Both subtrees of the root are copied
+            from = from->get_parent(); // This subtree is done: back up
+            to = to->get_parent();
+        }
+    }
+    catch (...)
+    {
+        remove_all();
+        throw;
+    }
     return 1;
 }
 
-// Recursive helper to find the minimum node
-Node *BST::find_ios(Node *root) const
+// In-order successor through the parent pointers (the first node for nullptr, nullptr
+// after the last): the leftmost node of the right subtree, or else the first ancestor
+// reached from its left side. Only reads the tree.
+Node *BST::next_in_order(Node *current) const
 {
-    if (!root)
-    {
-        throw string("Tree is empty. Cannot find minimum.");
-    }
-    if (!root->get_left())
+    Node *next = current ? current->get_right() : root;
+    if (next || !current)
     {
-        return root;
+        while (next && next->get_left())
+            next = next->get_left();
+        return next;
     }
-    return find_ios(root->get_left());
+    while (current->get_parent() && current == current->get_parent()->get_right())
+        current = current->get_parent();
+    return current->get_parent();
 }
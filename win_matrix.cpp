@@ -0,0 +1,247 @@
+// Author: Pokemon Battle contributors
+// Date: 10-17-2026
+//
+// This file contains the implementation of the Win_matrix class.
+
+#include "win_matrix.h"
+#include "combatant.h"
+#include <atomic>
+#include <fstream>
+#include <thread>
+
+const int TILE_ROWS = 64;	//rows per tile.
+const int TILE_COLS = 1024;	//columns per tile (two 2 KB attribute arrays).
+
+namespace
+{
+	/* This struct is the exact win probability of the side to move for one type pair:
+	 * table[a * stride + b] with a = first health, b = second health, first to move.
+	 */
+	struct Pair_table
+	{
+		int stride;		//max health + 1.
+		vector<float> first_to_move;	//P(first wins), first moves next.
+	};
+
+	//fills the table for a type pair up to the given health, the same rules as Battle_engine
+	//(first moves, damage after defending, health floors at 0), with random actions.
+	void solve(int first, int second, int max_health, Pair_table & table)
+	{
+		int stride = max_health + 1;
+		table.stride = stride;
+		table.first_to_move.assign(size_t(stride) * stride, 0.0f);
+		vector<double> x(size_t(stride) * stride, 0.0);	//first to move.
+		vector<double> y(size_t(stride) * stride, 0.0);	//second to move.
+		int first_damage[2] = {type_damage(first, ATTACK, second), type_damage(first, SPECIAL, second)};
+		int second_damage[2] = {type_damage(second, ATTACK, first), type_damage(second, SPECIAL, first)};
+
+		for (int a = 0; a <= max_health; ++a)
+		{
+			for (int b = 0; b <= max_health; ++b)
+			{
+				size_t here = size_t(a) * stride + b;
+				if (b == 0 || a == 0)
+				{
+					x[here] = y[here] = b == 0 && a > 0 ? 1.0 : 0.0;	//already decided.
+					continue;
+				}
+				//X = cx + zx * Y and Y = cy + zy * X, where z is the chance of a 0 damage action.
+				double cx = 0, zx = 0, cy = 0, zy = 0;
+				for (int action = 0; action < 2; ++action)
+				{
+					if (first_damage[action] == 0)
+						zx += 0.5;
+					else
+					{
+						int left = b - first_damage[action];
+						cx += 0.5 * (left <= 0 ? 1.0 : y[size_t(a) * stride + left]);
+					}
+					if (second_damage[action] == 0)
+						zy += 0.5;
+					else
+					{
+						int left = a - second_damage[action];
+						cy += 0.5 * (left <= 0 ? 0.0 : x[size_t(left) * stride + b]);
+					}
+				}
+				double stuck = 1.0 - zx * zy;	//0 only if nobody can ever deal damage.
+				x[here] = stuck > 0 ? (cx + zx * cy) / stuck : 0.0;
+				y[here] = cy + zy * x[here];
+			}
+		}
+		for (size_t i = 0; i < x.size(); ++i)
+			table.first_to_move[i] = float(x[i]);
+	}
+
+	//the roster as compact (type, health) pairs, health clamped to [0, max].
+	void flatten(const vector<Pokemon *> & roster, vector<Combatant> & out, vector<string> & names)
+	{
+		out.clear();
+		names.clear();
+		for (const Pokemon * pokemon : roster)
+		{
+			Combatant value = to_combatant(*pokemon);
+			if (value.health < 0)
+				value.health = 0;
+			out.push_back(value);
+			names.push_back(pokemon->get_name());
+		}
+	}
+}
+
+//empty matrix.
+Win_matrix::Win_matrix(): rows(0), cols(0)
+{}
+
+//every Pokemon of the first trainer against every Pokemon of the second.
+int Win_matrix::compute(const Trainer & first, const Trainer & second, int threads)
+{
+	vector<Pokemon *> row_team, col_team;
+	first.get_team(row_team);
+	second.get_team(col_team);
+	return compute(row_team, col_team, threads);
+}
+
+//fills the whole matrix, returns the number of cells.
+int Win_matrix::compute(const vector<Pokemon *> & row_team, const vector<Pokemon *> & col_team, int threads)
+{
+	vector<Combatant> row_values, col_values;
+	flatten(row_team, row_values, row_names);
+	flatten(col_team, col_values, col_names);
+	rows = int(row_values.size());
+	cols = int(col_values.size());
+	cells.assign(size_t(rows) * cols, 0.0f);
+	if (rows == 0 || cols == 0)
+		return 0;
+
+	int max_health = 0;
+	for (const Combatant & value : row_values)
+		max_health = max(max_health, value.health);
+	for (const Combatant & value : col_values)
+		max_health = max(max_health, value.health);
+
+	Pair_table tables[3][3];
+	for (int first = FIRE; first <= GRASS; ++first)
+		for (int second = FIRE; second <= GRASS; ++second)
+			solve(first, second, max_health, tables[first - 1][second - 1]);
+
+	if (threads <= 0)
+		threads = int(thread::hardware_concurrency());
+	if (threads <= 0)
+		threads = 1;
+	int row_tiles = (rows + TILE_ROWS - 1) / TILE_ROWS;
+	int col_tiles = (cols + TILE_COLS - 1) / TILE_COLS;
+	int tiles = row_tiles * col_tiles;
+	threads = min(threads, tiles);
+	atomic<int> next_tile(0);
+
+	auto work = [&]()
+	{
+		int16_t col_type[TILE_COLS];
+		int16_t col_health[TILE_COLS];
+		for (int tile = next_tile.fetch_add(1); tile < tiles; tile = next_tile.fetch_add(1))
+		{
+			int row_begin = tile / col_tiles * TILE_ROWS;
+			int col_begin = tile % col_tiles * TILE_COLS;
+			int row_end = min(rows, row_begin + TILE_ROWS);
+			int width = min(cols, col_begin + TILE_COLS) - col_begin;
+			for (int j = 0; j < width; ++j)
+			{
+				col_type[j] = int16_t(col_values[col_begin + j].type - 1);
+				col_health[j] = int16_t(col_values[col_begin + j].health);
+			}
+			for (int i = row_begin; i < row_end; ++i)
+			{
+				const Combatant & row = row_values[i];
+				float * out = &cells[size_t(i) * cols + col_begin];
+				if (row.type < FIRE || row.type > GRASS)
+					continue;
+				const Pair_table * by_type = tables[row.type - 1];
+				size_t row_offset = size_t(row.health) * by_type[0].stride;
+				for (int j = 0; j < width; ++j)
+					out[j] = col_type[j] >= 0 && col_type[j] < 3
+						? by_type[col_type[j]].first_to_move[row_offset + col_health[j]] : 0.0f;
+			}
+		}
+	};
+
+	vector<thread> pool;
+	for (int t = 1; t < threads; ++t)
+		pool.emplace_back(work);
+	work();
+	for (thread & t : pool)
+		t.join();
+	return rows * cols;
+}
+
+//row Pokemon.
+int Win_matrix::get_rows() const
+{
+	return rows;
+}
+
+//column Pokemon.
+int Win_matrix::get_cols() const
+{
+	return cols;
+}
+
+//P(row Pokemon beats column Pokemon).
+float Win_matrix::at(int row, int col) const
+{
+	return cells[size_t(row) * cols + col];
+}
+
+//row-major cells.
+const float * Win_matrix::data() const
+{
+	return cells.data();
+}
+
+//average over every cell.
+double Win_matrix::mean() const
+{
+	double sum = 0;
+	for (float cell : cells)
+		sum += cell;
+	return cells.empty() ? 0 : sum / double(cells.size());
+}
+
+//column names, then one line per row: name, probabilities.
+int Win_matrix::export_csv(ostream & out) const
+{
+	out << "pokemon";
+	for (const string & name : col_names)
+		out << "," << name;
+	out << "\n";
+	for (int i = 0; i < rows; ++i)
+	{
+		out << row_names[i];
+		const float * row = &cells[size_t(i) * cols];
+		for (int j = 0; j < cols; ++j)
+			out << "," << row[j];
+		out << "\n";
+	}
+	return out ? 0 : -1;
+}
+
+//writes the CSV to a file.
+int Win_matrix::export_csv(const string & path) const
+{
+	ofstream file(path);
+	if (!file)
+		return -1;
+	return export_csv(file);
+}
+
+//one cell, without building a matrix.
+double Win_matrix::win_probability(int first_type, int first_health, int second_type, int second_health)
+{
+	if (first_type < FIRE || first_type > GRASS || second_type < FIRE || second_type > GRASS)
+		return 0;
+	first_health = max(first_health, 0);
+	second_health = max(second_health, 0);
+	Pair_table table;
+	solve(first_type, second_type, max(first_health, second_health), table);
+	return table.first_to_move[size_t(first_health) * table.stride + second_health];
+}
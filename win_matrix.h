@@ -0,0 +1,52 @@
+// Author: Pokemon Battle contributors
+// Date: 10-17-2026
+//
+// This file contains the class declarations for the team versus team win probability matrix.
+
+/*
+ * Win Probability Matrix for Pokemon Battle Simulation
+ *
+ * `Win_matrix` holds, for two rosters, the probability that row Pokemon i (moving first, as
+ * trainer 1 does in the stadium) beats column Pokemon j when both sides pick Attack or
+ * Special Ability at random every turn.
+ *
+ * The probabilities are exact, not sampled. A battle only depends on the two types and the
+ * two healths, so for each of the 9 type pairs one dynamic programming pass fills a
+ * (health x health) table of win probabilities, solving the 2 x 2 system that appears when
+ * both sides may deal 0 damage. Filling the matrix is then one table lookup per cell:
+ * - Each roster is first flattened into a compact (type, health) array.
+ * - The matrix is filled in tiles of TILE_ROWS x TILE_COLS cells, so a tile's column
+ *   attributes and output rows stay in cache.
+ * - Tiles are handed out to the threads through an atomic counter.
+ * The matrix is dense, row-major `float` and can be exported as CSV.
+ */
+
+#ifndef WIN_MATRIX_H
+#define WIN_MATRIX_H
+
+#include "battle.h"
+
+/* This class is the dense N x M matrix of pairwise win probabilities. */
+class Win_matrix
+{
+	public:
+		Win_matrix();
+		int compute(const Trainer & first, const Trainer & second, int threads = 0);	//whole teams, 0 threads = one per core.
+		int compute(const vector<Pokemon *> & rows, const vector<Pokemon *> & cols, int threads = 0);	//any two rosters.
+		int get_rows() const;
+		int get_cols() const;
+		float at(int row, int col) const;	//P(row Pokemon beats column Pokemon).
+		const float * data() const;		//row-major, get_rows() x get_cols().
+		double mean() const;			//average over every cell.
+		int export_csv(ostream & out) const;	//header of column names, then one line per row.
+		int export_csv(const string & path) const;	//same, to a file; -1 if it can't be written.
+		static double win_probability(int first_type, int first_health, int second_type, int second_health);	//one cell.
+	private:
+		int rows;		//row Pokemon.
+		int cols;		//column Pokemon.
+		vector<float> cells;	//row-major probabilities.
+		vector<string> row_names;	//for the CSV.
+		vector<string> col_names;	//for the CSV.
+};
+
+#endif